@@ -0,0 +1,64 @@
+#pragma once
+
+// system headers
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Typed values of the standard keys of the Desktop Entry section which need to be converted before use.
+         *
+         * Use DesktopFile::schema() to obtain them. The values are converted once when they are needed for the first
+         * time, and kept until the Desktop Entry section is modified. Keys whose values are plain strings (Name, Exec,
+         * Icon, ...) don't need any conversion, use DesktopFile::findEntry() for those.
+         *
+         * Booleans are empty if the key is missing or its value is neither true nor false. Lists are split like
+         * DesktopFileEntry::parseStringList() does, their items are views of the file's values. See
+         * DesktopFile::schema() for the calls which invalidate them.
+         */
+        class DesktopEntrySchema {
+        public:
+            enum class Type : uint8_t {
+                // no Type key
+                Missing,
+                // Type key with a value not defined in the specification
+                Unknown,
+                Application,
+                Link,
+                Directory,
+            };
+
+            typedef std::vector<std::string_view> list_t;
+
+        public:
+            Type type = Type::Missing;
+
+            std::optional<bool> noDisplay;
+            std::optional<bool> hidden;
+            std::optional<bool> dbusActivatable;
+            std::optional<bool> terminal;
+            std::optional<bool> startupNotify;
+            std::optional<bool> prefersNonDefaultGPU;
+            std::optional<bool> singleMainWindow;
+
+            list_t onlyShowIn;
+            list_t notShowIn;
+            list_t actions;
+            list_t mimeType;
+            list_t categories;
+            list_t implements;
+            list_t keywords;
+
+        public:
+            // convert the values of the given section
+            // the section must outlive the schema
+            static DesktopEntrySchema fromSection(const DesktopFile::section_t& section);
+        };
+    }
+}
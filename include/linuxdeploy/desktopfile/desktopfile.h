@@ -1,23 +1,82 @@
 // system includes
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 
 // local includes
 #include "desktopfileentry.h"
+#include "memoryusage.h"
 
 #pragma once
 
 namespace linuxdeploy {
     namespace desktopfile {
+        // see desktopfilediff.h
+        class DesktopFileDiff;
+        class DesktopFileMergeResult;
+
+        // see frozendesktopfile.h
+        class FrozenDesktopFile;
+
+        // see desktopentryschema.h
+        class DesktopEntrySchema;
+
+        // see desktopfiletemplate.h
+        class DesktopFileTemplateBase;
+
+        /*
+         * Hash function for string keys which allows for looking them up with std::string_views or C strings without
+         * creating temporary strings. Must be combined with a transparent equality operator like
+         * TransparentStringEqual.
+         */
+        class TransparentStringHash {
+        public:
+            typedef void is_transparent;
+
+            size_t operator()(std::string_view string) const noexcept {
+                return std::hash<std::string_view>()(string);
+            }
+        };
+
+        /*
+         * Equality operator for string keys matching TransparentStringHash. Unlike std::equal_to<>, it also compares
+         * strings with different allocators, e.g., std::pmr::string keys with std::string arguments.
+         */
+        class TransparentStringEqual {
+        public:
+            typedef void is_transparent;
+
+            bool operator()(std::string_view first, std::string_view second) const noexcept {
+                return first == second;
+            }
+        };
+
         /*
          * Parse and read desktop files.
+         *
+         * The data can be placed in a caller-provided std::pmr::memory_resource, e.g., a per-request
+         * std::pmr::monotonic_buffer_resource. Sections, entries, the map nodes, and all keys and values are allocated
+         * from the resource, therefore parsing a buffer does not allocate any memory from the global heap. Files must be
+         * destroyed before their memory resource, which is cheap with resources which release their memory as a
+         * whole.
+         *
+         * All const methods are read-only, therefore any number of threads may read the same file concurrently.
+         * Modifying a file while other threads read it is not safe, see SharedDesktopFile for publishing modified
+         * versions to concurrent readers.
          */
         class DesktopFile {
         public:
             // describes a single section
-            typedef std::unordered_map<std::string, DesktopFileEntry> section_t;
+            // lookups can be done with std::string_views, see TransparentStringHash
+            typedef std::pmr::unordered_map<std::pmr::string, DesktopFileEntry, TransparentStringHash,
+                                            TransparentStringEqual> section_t;
 
             // describes all sections in the desktop file
-            typedef std::unordered_map<std::string, section_t> sections_t;
+            typedef std::pmr::unordered_map<std::pmr::string, section_t, TransparentStringHash, TransparentStringEqual>
+                sections_t;
 
         private:
                 // private data class pattern
@@ -28,29 +87,67 @@ namespace linuxdeploy {
                 friend bool operator==(const DesktopFile& first, const DesktopFile& second);
                 friend bool operator!=(const DesktopFile& first, const DesktopFile& second);
 
+                // diff and merge work on the internal storage directly
+                friend DesktopFileDiff diff(const DesktopFile& from, const DesktopFile& to);
+                friend DesktopFileMergeResult merge(const DesktopFile& base, const DesktopFile& ours,
+                                                    const DesktopFile& theirs);
+
+                // thawing frozen files fills the internal storage directly
+                friend class FrozenDesktopFile;
+
+                // so does instantiating compile-time templates
+                friend class DesktopFileTemplateBase;
+
             public:
                 // default constructor
                 DesktopFile();
 
+                // construct empty file whose data is allocated from the given memory resource
+                explicit DesktopFile(std::pmr::memory_resource* resource);
+
                 // construct from existing desktop file
                 // if the file exists, it will be read using DesktopFileReader
                 // if reading fails, exceptions will be thrown (see DesktopFileReader for more information)
                 explicit DesktopFile(const std::string& path);
 
+                // construct from existing desktop file, allocating the data from the given memory resource
+                DesktopFile(const std::string& path, std::pmr::memory_resource* resource);
+
                 // construct by reading an existing stream
                 // file must exist, otherwise std::runtime_error is thrown
                 explicit DesktopFile(std::istream& is);
 
+                // construct by reading an existing stream, allocating the data from the given memory resource
+                DesktopFile(std::istream& is, std::pmr::memory_resource* resource);
+
+                // construct by parsing an in-memory buffer, e.g., data extracted from an archive or received via IPC
+                // the buffer is tokenized in place, it does not need to be null-terminated
+                // see DesktopFileView for an alternative which does not copy the data at all
+                DesktopFile(const char* data, size_t size);
+
+                // construct by parsing an in-memory buffer, allocating the data from the given memory resource
+                DesktopFile(const char* data, size_t size, std::pmr::memory_resource* resource);
+
                 // copy constructor
+                // like with the standard containers, the copy uses the default memory resource
                 DesktopFile(const DesktopFile& other);
 
+                // move constructor
+                // takes over other's data along with its memory resource, other may only be assigned to afterwards
+                DesktopFile(DesktopFile&& other) noexcept;
+
                 // copy assignment constructor
+                // the copy is allocated from this file's memory resource
                 DesktopFile& operator=(const DesktopFile& other);
 
                 // move assignment operator
+                // takes over other's data along with its memory resource
                 DesktopFile& operator=(DesktopFile&& other) noexcept;
 
         public:
+                // returns the memory resource the data is allocated from
+                std::pmr::memory_resource* memoryResource() const;
+
                 // returns true if a file has been loaded, false otherwise
                 bool isEmpty() const;
 
@@ -63,6 +160,17 @@ namespace linuxdeploy {
                 // throws exceptions in case of issues, see DesktopFileReader for more information
                 void read(std::istream& is);
 
+                // read desktop file from an in-memory buffer
+                // throws exceptions in case of issues, see DesktopFileReader for more information
+                void read(const char* data, size_t size);
+
+                // read desktop file from an in-memory buffer, parsing it on up to the given number of threads
+                // 0 threads selects the number of hardware threads
+                // meant for huge files with many sections, e.g., merged menus, smaller buffers are parsed on the calling
+                // thread; see DesktopFileReader for more information
+                // throws exceptions in case of issues, see DesktopFileReader for more information
+                void readParallel(const char* data, size_t size, size_t threads = 0);
+
                 // get path associated with this file
                 std::string path() const;
 
@@ -87,25 +195,76 @@ namespace linuxdeploy {
                 bool save(std::ostream& os) const;
 
                 // check if entry exists in given section and key
-                bool entryExists(const std::string& section, const std::string& key) const;
+                // does not allocate any memory
+                bool entryExists(std::string_view section, std::string_view key) const;
 
                 // get key from desktop file
                 // an std::string passed as value parameter will be populated with the contents
                 // returns true (and populates value) if the key exists, false otherwise
-                bool getEntry(const std::string& section, const std::string& key, DesktopFileEntry& value) const;
+                // the lookup itself does not allocate any memory, only copying the entry into value does
+                bool getEntry(std::string_view section, std::string_view key, DesktopFileEntry& value) const;
+
+                // look up entry without copying it
+                // returns nullptr if the entry does not exist
+                // the pointer is valid until the file is modified or destroyed
+                const DesktopFileEntry* findEntry(std::string_view section, std::string_view key) const;
+
+                // look up section without copying it
+                // returns nullptr if the section does not exist
+                // the pointer is valid until the file is modified or destroyed
+                const section_t* findSection(std::string_view section) const;
+
+                // access all sections and their entries without copying them, e.g., to iterate over them
+                // the reference is valid until the file is modified or destroyed
+                const sections_t& sections() const;
 
                 // add key to section in desktop file
                 // the section will be created if it doesn't exist already
                 // returns true if an existing key was overwritten, false otherwise
-                bool setEntry(const std::string& section, const DesktopFileEntry& entry);
+                bool setEntry(std::string_view section, const DesktopFileEntry& entry);
 
                 // add key to section in desktop file
                 // the section will be created if it doesn't exist already
                 // returns true if an existing key was overwritten, false otherwise
-                bool setEntry(const std::string& section, DesktopFileEntry&& entry);
+                bool setEntry(std::string_view section, DesktopFileEntry&& entry);
+
+                // remove key from section in desktop file
+                // the section is kept, even if it becomes empty
+                // returns true if the key existed, false otherwise
+                bool removeEntry(std::string_view section, std::string_view key);
 
                 // validate desktop file
                 bool validate() const;
+
+                // returns the typed values of the standard keys in the Desktop Entry section
+                // the values are converted on the first call, and cached until the section is modified
+                // the reference, and the views in its lists, are invalidated by setEntry() and removeEntry() calls on
+                // the Desktop Entry section, by read(), readParallel(), clear() and compact(), by assigning to the
+                // file, and by destroying it; modifying other sections does not affect them
+                // copying the schema does not extend its lifetime, as the lists are views of the file's values
+                // see DesktopEntrySchema for more information
+                const DesktopEntrySchema& schema() const;
+
+                // returns the memory used by the file's data, see MemoryUsage
+                MemoryUsage memoryUsage() const;
+
+                // rebuild the data with tightly sized hash tables and strings, e.g., after removing many entries
+                // the contents and the content hash do not change, but all references and views to the data are
+                // invalidated
+                // note that memory resources which never free memory, like std::pmr::monotonic_buffer_resource, don't
+                // benefit from this
+                void compact();
+
+                // returns a 64-bit hash of the sections and entries, which does not depend on their order
+                // the path is not included, therefore files with the same contents in different locations have the
+                // same hash, which makes it suitable for detecting duplicates
+                // the hash is maintained incrementally by all modifying operations, calling this method is O(1)
+                // the hash is stable across processes and platforms, so it may be persisted
+                uint64_t contentHash() const;
+
+                // pack the file into a read-only representation optimized for lookups
+                // frozen files can be serialized, e.g., to pass them to another process, see FrozenDesktopFile
+                FrozenDesktopFile freeze() const;
         };
 
         // DesktopFile equality operator
@@ -0,0 +1,41 @@
+#pragma once
+
+// system headers
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Outcome of loading a single file with loadDesktopFiles().
+         */
+        class DesktopFileLoadResult {
+        public:
+            std::string path;
+
+            // loaded file, nullptr if the file could not be read or parsed
+            std::shared_ptr<DesktopFile> file;
+
+            // describes why the file could not be loaded, empty on success
+            std::string error;
+        };
+
+        // load many desktop files at once
+        // the files are read with batched I/O: io_uring submits the open, read and close operations of up to a few
+        // hundred files with a single system call each, and if io_uring is not available, a couple of threads read the
+        // files with plain system calls
+        // the results are returned in the order of the paths
+        std::vector<DesktopFileLoadResult> loadDesktopFiles(const std::vector<std::string>& paths);
+
+        // save many desktop files at once, each one to the path associated with it (see DesktopFile::path())
+        // the files are written with batched I/O, see loadDesktopFiles()
+        // returns a map of paths which could not be written to the respective error messages, which is empty on
+        // success
+        std::map<std::string, std::string> saveDesktopFiles(const std::vector<DesktopFile>& files);
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// system headers
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Describes which paths of a collection changed during an update.
+         */
+        class DesktopFileCollectionChanges {
+        public:
+            // files which were not part of the collection before
+            std::vector<std::string> added;
+
+            // files whose contents changed
+            std::vector<std::string> modified;
+
+            // files which are no longer part of the collection
+            std::vector<std::string> removed;
+
+        public:
+            // returns true if nothing changed
+            bool isEmpty() const;
+        };
+
+        /*
+         * Set of desktop files loaded from a directory (including its subdirectories).
+         *
+         * The loaded files are published as immutable snapshots. Readers obtain the current snapshot with snapshot(),
+         * which is safe to call from any thread, and can keep using it while updates publish newer snapshots.
+         */
+        class DesktopFileCollection {
+        public:
+            // maps paths to the desktop files loaded from them
+            typedef std::map<std::string, std::shared_ptr<const DesktopFile>> files_t;
+
+            // immutable state of the collection at a given point in time
+            typedef std::shared_ptr<const files_t> snapshot_t;
+
+            // maps paths of files which could not be loaded to the respective error messages
+            typedef std::map<std::string, std::string> errors_t;
+
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // default constructor
+            DesktopFileCollection();
+
+            // construct from directory, and load all the desktop files within it
+            // throws IOError if the directory cannot be read
+            explicit DesktopFileCollection(std::string directory);
+
+            // copy constructor
+            DesktopFileCollection(const DesktopFileCollection& other);
+
+            // copy assignment constructor
+            DesktopFileCollection& operator=(const DesktopFileCollection& other);
+
+            // move assignment operator
+            DesktopFileCollection& operator=(DesktopFileCollection&& other) noexcept;
+
+        public:
+            // returns the directory this collection has been loaded from
+            std::string directory() const;
+
+            // returns true if no files have been loaded
+            bool isEmpty() const;
+
+            // returns the current snapshot
+            // snapshots never change once published, updates replace the snapshot instead
+            snapshot_t snapshot() const;
+
+            // returns the files which could not be parsed during the last load or update
+            errors_t errors() const;
+
+            // returns the memory used by the current snapshot, including all its files, and the errors
+            // see MemoryUsage for more information
+            MemoryUsage memoryUsage() const;
+
+            // (re-)scan the whole directory, and publish a new snapshot
+            // unchanged files are reported neither as added nor as modified
+            // throws IOError if the directory cannot be read
+            DesktopFileCollectionChanges load();
+
+            // re-read the given paths only, and publish a single new snapshot containing all changes
+            // paths which no longer exist or cannot be parsed are removed from the collection
+            // paths outside the collection's directory and files not ending in .desktop are ignored
+            DesktopFileCollectionChanges update(const std::vector<std::string>& paths);
+
+        public:
+            // recursively search directory for desktop files
+            // returns a sorted list of paths
+            // subdirectories which cannot be read are skipped
+            // throws IOError if the directory itself cannot be read
+            static std::vector<std::string> findDesktopFiles(const std::string& directory);
+        };
+    }
+}
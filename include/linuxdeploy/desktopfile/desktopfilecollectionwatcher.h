@@ -0,0 +1,52 @@
+#pragma once
+
+// system headers
+#include <memory>
+
+// local headers
+#include "desktopfilecollection.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Keeps a DesktopFileCollection up to date using inotify.
+         *
+         * Only the files mentioned in inotify events are re-read. Events arriving in quick succession, e.g., while a
+         * package manager installs a package, are coalesced into a single update of the collection, which therefore
+         * publishes only a single new snapshot.
+         *
+         * The watcher does not spawn any threads. Users either call processEvents() in a loop, or integrate
+         * fileDescriptor() into their existing event loop and call processEvents() once it becomes readable.
+         *
+         * The collection must outlive the watcher.
+         */
+        class DesktopFileCollectionWatcher {
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // watch the collection's directory (and all of its subdirectories)
+            // events are coalesced until no new events arrive within settleTimeMs milliseconds, but for ten times
+            // that at most
+            // throws IOError if inotify cannot be set up
+            explicit DesktopFileCollectionWatcher(DesktopFileCollection& collection, int settleTimeMs = 100);
+
+            // the watcher owns an inotify instance, therefore it can be neither copied nor assigned
+            DesktopFileCollectionWatcher(const DesktopFileCollectionWatcher& other) = delete;
+            DesktopFileCollectionWatcher& operator=(const DesktopFileCollectionWatcher& other) = delete;
+
+        public:
+            // returns the inotify file descriptor, which becomes readable when events are pending
+            int fileDescriptor() const;
+
+            // wait up to timeoutMs milliseconds for events (-1 waits indefinitely, 0 does not wait at all)
+            // once events arrive, further events are collected until the settle time has passed without any events,
+            // or ten settle times have passed in total, then the collection is updated once
+            // returns the changes applied to the collection, which are empty if the timeout expired
+            // throws IOError if reading the events fails
+            DesktopFileCollectionChanges processEvents(int timeoutMs = -1);
+        };
+    }
+}
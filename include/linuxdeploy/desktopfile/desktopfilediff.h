@@ -0,0 +1,101 @@
+#pragma once
+
+// system headers
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+#include "desktopfileentry.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Differences between two versions of a single section.
+         */
+        class DesktopFileSectionDiff {
+        public:
+            // entries only present in the new version
+            std::vector<DesktopFileEntry> added;
+
+            // entries only present in the old version
+            std::vector<DesktopFileEntry> removed;
+
+            // entries whose values differ, as pairs of old and new entry
+            std::vector<std::pair<DesktopFileEntry, DesktopFileEntry>> changed;
+
+        public:
+            // returns true if the section has not changed
+            bool isEmpty() const;
+        };
+
+        /*
+         * Differences between two versions of a desktop file.
+         *
+         * Only sections which changed are listed. Sections which have been added or removed as a whole list all their
+         * entries as added or removed, respectively, and are listed in addedSections or removedSections in addition.
+         */
+        class DesktopFileDiff {
+        public:
+            // maps section names to their differences
+            typedef std::map<std::string, DesktopFileSectionDiff> sections_t;
+
+        public:
+            sections_t sections;
+
+            // sections only present in the new version
+            std::vector<std::string> addedSections;
+
+            // sections only present in the old version
+            std::vector<std::string> removedSections;
+
+        public:
+            // returns true if the files' contents are equal
+            bool isEmpty() const;
+        };
+
+        /*
+         * Entry changed differently in both versions during a three-way merge.
+         */
+        class DesktopFileMergeConflict {
+        public:
+            std::string section;
+            std::string key;
+
+            // the entry in all three versions
+            // entries missing in a version are represented by empty entries (see DesktopFileEntry::isEmpty())
+            DesktopFileEntry base;
+            DesktopFileEntry ours;
+            DesktopFileEntry theirs;
+        };
+
+        /*
+         * Result of a three-way merge.
+         */
+        class DesktopFileMergeResult {
+        public:
+            // merged file
+            // conflicts are resolved in favor of our version, the path is taken over from our version as well
+            DesktopFile merged;
+
+            // list of conflicting changes
+            std::vector<DesktopFileMergeConflict> conflicts;
+
+        public:
+            // returns true if the merge resulted in conflicts
+            bool hasConflicts() const;
+        };
+
+        // calculate the differences between two versions of a desktop file
+        // runs in time linear in the number of entries
+        DesktopFileDiff diff(const DesktopFile& from, const DesktopFile& to);
+
+        // merge the changes made in ours and theirs relative to their common ancestor base
+        // every entry changed in only one of the versions is taken over into the result, entries changed in both
+        // versions in the same way are taken over as well, all other changes are reported as conflicts
+        // runs in time linear in the number of entries
+        DesktopFileMergeResult merge(const DesktopFile& base, const DesktopFile& ours, const DesktopFile& theirs);
+    }
+}
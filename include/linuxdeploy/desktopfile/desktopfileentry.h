@@ -1,13 +1,25 @@
 #pragma once
 
 // system headers
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// local headers
+#include "memoryusage.h"
+
 namespace linuxdeploy {
     namespace desktopfile {
         class DesktopFileEntry {
+        public:
+            // entries can be placed in a caller-provided memory resource
+            // containers like DesktopFile::section_t pass on their allocator automatically
+            // key and value are allocated from the resource as well
+            typedef std::pmr::polymorphic_allocator<std::byte> allocator_type;
+
         private:
             // opaque data class pattern
             class PrivateData;
@@ -18,16 +30,32 @@ namespace linuxdeploy {
             // default constructor
             DesktopFileEntry();
 
+            // construct empty entry using the given allocator
+            explicit DesktopFileEntry(const allocator_type& allocator);
+
             // construct from key and value
-            explicit DesktopFileEntry(std::string key, std::string value);
+            explicit DesktopFileEntry(std::string_view key, std::string_view value);
+
+            // construct from key and value using the given allocator
+            DesktopFileEntry(std::string_view key, std::string_view value, const allocator_type& allocator);
 
             // copy constructor
+            // like with the standard containers, the copy uses the default memory resource
             DesktopFileEntry(const DesktopFileEntry& other);
 
+            // copy constructor using the given allocator
+            DesktopFileEntry(const DesktopFileEntry& other, const allocator_type& allocator);
+
+            // move constructor using the given allocator
+            // the data is shared with other if both use the same memory resource, otherwise it is copied
+            DesktopFileEntry(DesktopFileEntry&& other, const allocator_type& allocator);
+
             // copy assignment constructor
+            // the copy is allocated from this entry's memory resource
             DesktopFileEntry& operator=(const DesktopFileEntry& other);
 
             // move assignment operator
+            // takes over other's data along with its memory resource
             DesktopFileEntry& operator=(DesktopFileEntry&& other) noexcept;
 
             // equality operator
@@ -37,14 +65,21 @@ namespace linuxdeploy {
             bool operator!=(const DesktopFileEntry& other) const;
 
         public:
+            // returns the allocator the entry's data has been allocated with
+            allocator_type get_allocator() const;
+
             // checks whether a key and value have been set
             bool isEmpty() const;
 
             // return entry's key
-            const std::string& key() const;
+            const std::pmr::string& key() const;
 
             // return entry's value
-            const std::string& value() const;
+            const std::pmr::string& value() const;
+
+            // returns the memory used by the entry's data, see MemoryUsage
+            // entries sharing their data (see the move constructor) all report it
+            MemoryUsage memoryUsage() const;
 
         public:
             // convert value to integer
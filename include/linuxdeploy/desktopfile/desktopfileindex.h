@@ -0,0 +1,103 @@
+#pragma once
+
+// system headers
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+#include "desktopfilecollection.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Inverted index mapping the tokens of the list-type keys Categories, MimeType and Keywords to the files they
+         * appear in.
+         *
+         * Every indexed file is assigned a numeric ID. For every token, the index stores a sorted list of the IDs of
+         * the files containing that token (a "posting list"). Queries combine posting lists with linear-time
+         * intersections and unions, none of them touches the indexed files again.
+         *
+         * MIME types and keywords are matched case-insensitively, categories are case sensitive as per the
+         * specification.
+         */
+        class DesktopFileIndex {
+        public:
+            // list keys which can be queried
+            enum class Field {
+                Categories,
+                MimeType,
+                Keywords,
+            };
+
+            // numeric ID identifying an indexed file
+            typedef uint32_t file_id_t;
+
+            // sorted list of file IDs
+            typedef std::vector<file_id_t> postings_t;
+
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // default constructor
+            DesktopFileIndex();
+
+            // build index over all the files in the given snapshot
+            explicit DesktopFileIndex(const DesktopFileCollection::files_t& files);
+
+            // copy constructor
+            DesktopFileIndex(const DesktopFileIndex& other);
+
+            // copy assignment constructor
+            DesktopFileIndex& operator=(const DesktopFileIndex& other);
+
+            // move assignment operator
+            DesktopFileIndex& operator=(DesktopFileIndex&& other) noexcept;
+
+        public:
+            // returns the number of indexed files
+            size_t size() const;
+
+            // add file to index, replacing the previously indexed version if the path is already known
+            // returns the ID assigned to the file, which stays the same when a file is replaced
+            file_id_t update(const std::string& path, const DesktopFile& file);
+
+            // apply changes reported by a DesktopFileCollection
+            // the files are looked up in snapshot, which should be the one published along with the changes
+            void update(const DesktopFileCollection::files_t& snapshot, const DesktopFileCollectionChanges& changes);
+
+            // remove file from index
+            // the file's ID may be reused for files added later
+            // returns true if the file was indexed, false otherwise
+            bool remove(const std::string& path);
+
+            // returns true if the path is indexed, and populates id
+            bool findId(const std::string& path, file_id_t& id) const;
+
+            // returns the path of an indexed file
+            // throws std::out_of_range if the ID is not in use
+            const std::string& path(file_id_t id) const;
+
+        public:
+            // returns the files containing the token
+            const postings_t& find(Field field, const std::string& token) const;
+
+            // returns the files containing all the tokens
+            postings_t findAll(Field field, const std::vector<std::string>& tokens) const;
+
+            // returns the files containing at least one of the tokens
+            postings_t findAny(Field field, const std::vector<std::string>& tokens) const;
+
+            // returns the IDs contained in both lists
+            static postings_t intersect(const postings_t& first, const postings_t& second);
+
+            // returns the IDs contained in either list
+            static postings_t unite(const postings_t& first, const postings_t& second);
+        };
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+// system headers
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Effective set of desktop files in a list of application directories, e.g., the applications directories in
+         * $XDG_DATA_HOME and $XDG_DATA_DIRS.
+         *
+         * Files are identified by their desktop file ID, i.e., their path relative to the application directory with
+         * slashes replaced by dashes (kde/foo.desktop becomes kde-foo.desktop). If several directories contain a file
+         * with the same ID, the one in the earliest directory wins, and the others are ignored. A winning file with
+         * Hidden=true removes the ID altogether.
+         *
+         * The directories are indexed before any file is read, therefore only the winning file of every ID is read and
+         * parsed. Shadowed files are never touched.
+         *
+         * The files are loaded on construction and by load(). Loading is not thread-safe, all const methods are.
+         */
+        class DesktopFileOverlay {
+        public:
+            // maps desktop file IDs to the files which provide them
+            typedef std::map<std::string, std::shared_ptr<const DesktopFile>, std::less<>> files_t;
+
+            // maps paths of files which could not be loaded to the respective error messages
+            typedef std::map<std::string, std::string> errors_t;
+
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // default constructor
+            // creates an empty overlay without any directories, use DesktopFileOverlay(defaultDirectories()) for the
+            // applications installed on the system
+            DesktopFileOverlay();
+
+            // use the given application directories, and load the files
+            // earlier directories take precedence, directories which don't exist are ignored
+            explicit DesktopFileOverlay(std::vector<std::string> directories);
+
+            // copy constructor
+            DesktopFileOverlay(const DesktopFileOverlay& other);
+
+            // copy assignment constructor
+            DesktopFileOverlay& operator=(const DesktopFileOverlay& other);
+
+            // move assignment operator
+            DesktopFileOverlay& operator=(DesktopFileOverlay&& other) noexcept;
+
+        public:
+            // returns the application directories in the order of precedence
+            std::vector<std::string> directories() const;
+
+            // returns the effective files, i.e., neither shadowed nor hidden ones
+            const files_t& files() const;
+
+            // look up the effective file for a desktop file ID
+            // returns nullptr if there is no such file, or if it has been hidden
+            std::shared_ptr<const DesktopFile> find(std::string_view id) const;
+
+            // returns the IDs removed with Hidden=true
+            std::vector<std::string> hidden() const;
+
+            // returns the paths of the files which have been ignored as an earlier directory provides the same ID
+            std::vector<std::string> shadowed() const;
+
+            // returns the winning files which could not be read or parsed
+            // their IDs are not available, the files they shadow are not used instead
+            errors_t errors() const;
+
+            // (re-)scan the directories, and load the winning files
+            void load();
+
+        public:
+            // calculate the desktop file ID of a file in the given application directory
+            // returns an empty string if the path is not located in the directory
+            static std::string desktopFileId(const std::string& directory, const std::string& path);
+
+            // returns the application directories the specification describes: $XDG_DATA_HOME/applications, followed
+            // by the applications directories in $XDG_DATA_DIRS
+            static std::vector<std::string> defaultDirectories();
+        };
+    }
+}
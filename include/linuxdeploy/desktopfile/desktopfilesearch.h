@@ -0,0 +1,107 @@
+#pragma once
+
+// system headers
+#include <memory>
+#include <string>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+#include "desktopfilecollection.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Single match returned by DesktopFileSearch.
+         */
+        class DesktopFileSearchResult {
+        public:
+            // path of the matching file
+            std::string path;
+
+            // name to display for the file, taken from the (localized) Name key
+            std::string name;
+
+            // relevance of the match, between 0 and 1
+            float score;
+        };
+
+        /*
+         * Type-ahead fuzzy search over the Name, GenericName and Keywords keys of a set of desktop files.
+         *
+         * All the words in these keys are split into trigrams (sequences of three bytes) when the files are added.
+         * Words are padded with two leading spaces, so that the first one or two characters of a word form trigrams
+         * as well, which makes prefixes work even for very short queries. Queries are split the same way, and files
+         * are ranked by the share of the query's trigrams they contain, weighted by the fields they appear in.
+         *
+         * Only the index is consulted during searches, the original desktop files are not accessed at all.
+         *
+         * Matching is case-insensitive for ASCII characters. Non-ASCII characters are compared byte-wise.
+         */
+        class DesktopFileSearch {
+        public:
+            // keys which are indexed
+            enum class Field {
+                Name,
+                GenericName,
+                Keywords,
+            };
+
+            // list of search results, sorted by descending score
+            typedef std::vector<DesktopFileSearchResult> results_t;
+
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // create empty search index
+            // besides the unlocalized keys, the localized variants for the given locales (e.g., de_DE, de) are indexed
+            explicit DesktopFileSearch(std::vector<std::string> locales = {});
+
+            // build search index over all the files in the given snapshot
+            explicit DesktopFileSearch(const DesktopFileCollection::files_t& files,
+                                       std::vector<std::string> locales = {});
+
+            // copy constructor
+            DesktopFileSearch(const DesktopFileSearch& other);
+
+            // copy assignment constructor
+            DesktopFileSearch& operator=(const DesktopFileSearch& other);
+
+            // move assignment operator
+            DesktopFileSearch& operator=(DesktopFileSearch&& other) noexcept;
+
+        public:
+            // returns the number of indexed files
+            size_t size() const;
+
+            // set the weight matches in the given field contribute to a file's score
+            // defaults: Name 3, GenericName 2, Keywords 1
+            // weights are applied at query time, changing them does not require rebuilding the index
+            void setFieldWeight(Field field, float weight);
+
+            // returns the weight of the given field
+            float fieldWeight(Field field) const;
+
+            // set the minimum share of the query's trigrams a file must contain to be returned (default: 0.5)
+            // lower values tolerate more typos, but return more unrelated files
+            void setMinimumSimilarity(float similarity);
+
+            // add file to the index, replacing the previously indexed version if the path is already known
+            void update(const std::string& path, const DesktopFile& file);
+
+            // apply changes reported by a DesktopFileCollection
+            // the files are looked up in snapshot, which should be the one published along with the changes
+            void update(const DesktopFileCollection::files_t& snapshot, const DesktopFileCollectionChanges& changes);
+
+            // remove file from the index
+            // returns true if the file was indexed, false otherwise
+            bool remove(const std::string& path);
+
+            // search for the query, and return up to limit results
+            results_t search(const std::string& query, size_t limit = 10) const;
+        };
+    }
+}
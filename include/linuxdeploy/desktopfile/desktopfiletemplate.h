@@ -0,0 +1,331 @@
+#pragma once
+
+// system headers
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+
+// local headers
+#include "desktopfile.h"
+#include "keyfilepolicies.h"
+#include "validation.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * String literal which can be used as a template argument.
+         */
+        template<size_t N>
+        class FixedString {
+        public:
+            // must be public, class types with private members cannot be used as template arguments
+            char data[N]{};
+
+            constexpr FixedString(const char (&string)[N]) {
+                std::copy(string, string + N, data);
+            }
+
+            // the terminating null character is not part of the view
+            constexpr std::string_view view() const {
+                return {data, N - 1};
+            }
+        };
+
+        // section of a template, its entries are stored consecutively
+        class DesktopFileTemplateSection {
+        public:
+            std::string_view name;
+            size_t firstEntry = 0;
+            size_t entryCount = 0;
+        };
+
+        // key-value pair of a template
+        class DesktopFileTemplateEntry {
+        public:
+            std::string_view key;
+            std::string_view value;
+        };
+
+        namespace templateerrors {
+            // templates are parsed in constant expressions, where calling these (undefined, non-constexpr) functions
+            // makes the compiler report an error which includes the function's name
+            void byteOrderMarksAreNotSupported();
+            void multipleOpeningBracketsInSectionHeader();
+            void noClosingBracketInSectionHeader();
+            void twoOrMoreClosingBracketsInSectionHeader();
+            void noSectionInDesktopFile();
+            void noKeyValueDelimiterFound();
+            void emptyKeysAreNotAllowed();
+            void keyContainsInvalidCharacter();
+            void invalidLocalizationSyntaxInKey();
+            void valueIsNotValidUtf8();
+            void keyFoundMoreThanOnce();
+        }
+
+        /*
+         * Parser and storage shared by all DesktopFileTemplate instantiations.
+         *
+         * The parser applies the rules of DesktopEntryPolicy and keyfilesyntax, which the runtime parser uses as well.
+         * Only the way errors are reported differs.
+         */
+        class DesktopFileTemplateBase {
+        protected:
+            // first pass, determines the sizes of the arrays
+            class Counts {
+            public:
+                size_t sectionHeaders = 0;
+                size_t entries = 0;
+
+                constexpr void onSection(std::string_view) {
+                    ++sectionHeaders;
+                }
+
+                // duplicates are detected in the second pass
+                constexpr bool onEntry(std::string_view, std::string_view) {
+                    ++entries;
+                    return true;
+                }
+            };
+
+            // second pass, collects the sections and entries
+            // sections may appear more than once, so there may be less sections than headers
+            template<size_t MaxSections, size_t EntryCount>
+            class Data {
+            public:
+                std::array<DesktopFileTemplateSection, MaxSections> sections{};
+                size_t sectionCount = 0;
+
+                std::array<DesktopFileTemplateEntry, EntryCount> entries{};
+
+                // index of every entry's section, only needed while parsing
+                std::array<size_t, EntryCount> entrySections{};
+                size_t entryCount = 0;
+                size_t currentSection = 0;
+
+                constexpr void onSection(std::string_view name) {
+                    for (currentSection = 0; currentSection < sectionCount; ++currentSection) {
+                        if (sections[currentSection].name == name)
+                            return;
+                    }
+
+                    sections[sectionCount++].name = name;
+                }
+
+                // returns false if the key exists in the current section already, like the tokenizer's handlers
+                constexpr bool onEntry(std::string_view key, std::string_view value) {
+                    for (size_t i = 0; i < entryCount; ++i) {
+                        if (entrySections[i] == currentSection && entries[i].key == key)
+                            return false;
+                    }
+
+                    entrySections[entryCount] = currentSection;
+                    entries[entryCount++] = {key, value};
+                    ++sections[currentSection].entryCount;
+                    return true;
+                }
+
+                // groups the entries by section, keeping their order otherwise
+                constexpr void groupEntries() {
+                    size_t next = 0;
+
+                    for (size_t section = 0; section < sectionCount; ++section) {
+                        sections[section].firstEntry = next;
+                        next += sections[section].entryCount;
+                    }
+
+                    const auto ungrouped = entries;
+                    std::array<size_t, MaxSections> positions{};
+
+                    for (size_t i = 0; i < entryCount; ++i) {
+                        const auto section = entrySections[i];
+                        entries[sections[section].firstEntry + positions[section]++] = ungrouped[i];
+                    }
+                }
+            };
+
+            template<typename Handler>
+            static constexpr void parse(std::string_view source, Handler& handler) {
+                using Policy = DesktopEntryPolicy;
+
+                bool inSection = false;
+
+                // the runtime parser ignores the entire file in this case, which is unlikely to be intended here
+                if (!source.empty() && source[0] == static_cast<char>(0xEF))
+                    templateerrors::byteOrderMarksAreNotSupported();
+
+                size_t position = 0;
+
+                while (position < source.size()) {
+                    auto lineEnd = keyfilesyntax::find(source, '\n', position);
+
+                    if (lineEnd == std::string_view::npos)
+                        lineEnd = source.size();
+
+                    const auto line = source.substr(position, lineEnd - position);
+                    position = lineEnd + 1;
+
+                    if (line.empty() || Policy::isComment(line))
+                        continue;
+
+                    if (line[0] == '[') {
+                        std::string_view title;
+
+                        switch (keyfilesyntax::parseSectionHeader(line, title)) {
+                            case keyfilesyntax::SectionHeaderError::None:
+                                break;
+                            case keyfilesyntax::SectionHeaderError::MultipleOpeningBrackets:
+                                templateerrors::multipleOpeningBracketsInSectionHeader();
+                                break;
+                            case keyfilesyntax::SectionHeaderError::NoClosingBracket:
+                                templateerrors::noClosingBracketInSectionHeader();
+                                break;
+                            case keyfilesyntax::SectionHeaderError::TwoOrMoreClosingBrackets:
+                                templateerrors::twoOrMoreClosingBracketsInSectionHeader();
+                                break;
+                        }
+
+                        inSection = !title.empty();
+                        handler.onSection(title);
+                        continue;
+                    }
+
+                    if (!inSection)
+                        templateerrors::noSectionInDesktopFile();
+
+                    const auto delimiterPos = keyfilesyntax::find(line, '=');
+                    if (delimiterPos == std::string_view::npos)
+                        templateerrors::noKeyValueDelimiterFound();
+
+                    const auto key = keyfilesyntax::trim(line.substr(0, delimiterPos));
+                    const auto value = keyfilesyntax::trim(line.substr(delimiterPos + 1));
+
+                    if (key.empty())
+                        templateerrors::emptyKeysAreNotAllowed();
+
+                    std::string_view name, locale;
+                    keyfilesyntax::splitKey<Policy>(key, name, locale);
+
+                    if (Policy::findInvalidKeyCharacter(name) != std::string_view::npos)
+                        templateerrors::keyContainsInvalidCharacter();
+
+                    if (!locale.empty() && keyfilesyntax::checkLocale(locale) != keyfilesyntax::LocaleError::None)
+                        templateerrors::invalidLocalizationSyntaxInKey();
+
+                    if (!validation::isValidUtf8(value))
+                        templateerrors::valueIsNotValidUtf8();
+
+                    if (!handler.onEntry(key, value) && Policy::rejectDuplicateKeys)
+                        templateerrors::keyFoundMoreThanOnce();
+                }
+            }
+
+            static consteval Counts count(std::string_view source) {
+                Counts counts;
+                parse(source, counts);
+                return counts;
+            }
+
+            template<size_t MaxSections, size_t EntryCount>
+            static consteval Data<MaxSections, EntryCount> build(std::string_view source) {
+                Data<MaxSections, EntryCount> data;
+                parse(source, data);
+                data.groupEntries();
+                return data;
+            }
+
+            // creates a DesktopFile from the parsed data, the data is known to be valid and is inserted directly
+            static DesktopFile instantiate(const DesktopFileTemplateSection* sections, size_t sectionCount,
+                                           const DesktopFileTemplateEntry* entries,
+                                           std::pmr::memory_resource* resource);
+        };
+
+        /*
+         * Desktop file which is parsed and validated at compile time.
+         *
+         * Meant for fixed desktop files which are embedded into tools, which would otherwise have to be parsed every
+         * time the tool runs. Syntax errors are reported by the compiler (see the templateerrors namespace). The
+         * sections and entries are stored in static arrays of views into the literal, so looking them up neither
+         * parses nor allocates anything. toDesktopFile() copies them into a modifiable DesktopFile in one go.
+         *
+         *   using AppTemplate = DesktopFileTemplate<"[Desktop Entry]\nType=Application\nName=My App\n">;
+         *   static_assert(AppTemplate::findValue("Desktop Entry", "Type") == "Application");
+         *   auto file = AppTemplate::toDesktopFile();
+         *
+         * See also the _desktopfile literal below.
+         */
+        template<FixedString Source>
+        class DesktopFileTemplate : private DesktopFileTemplateBase {
+        private:
+            static constexpr Counts counts = count(Source.view());
+            static constexpr auto data = build<counts.sectionHeaders, counts.entries>(Source.view());
+
+            // returns the index of the section, or sectionCount() if it does not exist
+            // an index rather than a pointer, see keyfilesyntax::find() for the reason
+            static constexpr size_t findSection(std::string_view section) {
+                size_t index = 0;
+
+                while (index < data.sectionCount && data.sections[index].name != section)
+                    ++index;
+
+                return index;
+            }
+
+        public:
+            // returns the literal the template has been created from
+            static constexpr std::string_view source() {
+                return Source.view();
+            }
+
+            static constexpr size_t sectionCount() {
+                return data.sectionCount;
+            }
+
+            static constexpr size_t entryCount() {
+                return data.entryCount;
+            }
+
+            static constexpr bool sectionExists(std::string_view section) {
+                return findSection(section) < data.sectionCount;
+            }
+
+            // returns the value of the key in the given section, if any
+            // the view points into the literal, therefore it remains valid forever
+            static constexpr std::optional<std::string_view> findValue(std::string_view section, std::string_view key) {
+                const auto index = findSection(section);
+
+                if (index == data.sectionCount)
+                    return std::nullopt;
+
+                const auto& sectionData = data.sections[index];
+
+                for (size_t i = sectionData.firstEntry; i < sectionData.firstEntry + sectionData.entryCount; ++i) {
+                    if (data.entries[i].key == key)
+                        return data.entries[i].value;
+                }
+
+                return std::nullopt;
+            }
+
+            static constexpr bool entryExists(std::string_view section, std::string_view key) {
+                return findValue(section, key).has_value();
+            }
+
+            // creates a modifiable copy
+            static DesktopFile toDesktopFile(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+                return instantiate(data.sections.data(), data.sectionCount, data.entries.data(), resource);
+            }
+        };
+
+        namespace literals {
+            // "[Desktop Entry]\n..."_desktopfile yields an (empty) DesktopFileTemplate object, whose static members
+            // can be accessed like normal members
+            template<FixedString Source>
+            constexpr DesktopFileTemplate<Source> operator""_desktopfile() {
+                return {};
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// system headers
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+
+// local headers
+#include "desktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Read-only view of a desktop file which borrows the caller's buffer instead of copying the data.
+         *
+         * The buffer is tokenized in place, and all the section names, keys and values refer to the buffer directly.
+         * Therefore, the caller must guarantee that the buffer outlives the view and every string view obtained from it.
+         * The same validation rules as with DesktopFileReader apply, ParseError is thrown in case of syntax errors.
+         *
+         * Useful for inspecting files which are in memory already, e.g., when extracted from an archive, received via
+         * IPC or embedded as resources. Use toDesktopFile() to obtain a modifiable copy.
+         */
+        class DesktopFileView {
+        public:
+            // maps keys to values within a single section
+            typedef std::unordered_map<std::string_view, std::string_view> section_t;
+
+            // maps section names to sections
+            typedef std::unordered_map<std::string_view, section_t> sections_t;
+
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // default constructor
+            DesktopFileView();
+
+            // parse the given buffer, which does not need to be null-terminated
+            DesktopFileView(const char* data, size_t size);
+
+            // parse the given buffer
+            explicit DesktopFileView(std::string_view data);
+
+            // copy constructor
+            // the copy refers to the same buffer
+            DesktopFileView(const DesktopFileView& other);
+
+            // copy assignment constructor
+            DesktopFileView& operator=(const DesktopFileView& other);
+
+            // move assignment operator
+            DesktopFileView& operator=(DesktopFileView&& other) noexcept;
+
+        public:
+            // returns true if the buffer did not contain any sections
+            bool isEmpty() const;
+
+            // returns the buffer the view refers to
+            std::string_view buffer() const;
+
+            // access all sections and their entries, e.g., to iterate over them
+            const sections_t& sections() const;
+
+            // look up section
+            // returns nullptr if the section does not exist
+            const section_t* findSection(std::string_view section) const;
+
+            // look up the value of an entry
+            // returns nullptr if the entry does not exist
+            const std::string_view* findValue(std::string_view section, std::string_view key) const;
+
+            // check if entry exists in given section and key
+            bool entryExists(std::string_view section, std::string_view key) const;
+
+            // parse the buffer into a DesktopFile which owns its data, e.g., to modify it
+            DesktopFile toDesktopFile(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+        };
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// system headers
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Read-only representation of a desktop file which is optimized for lookups.
+         *
+         * The whole file is packed into a single allocation: a small header, a table of the sections sorted by name, a
+         * table of the entries grouped by section and sorted by key, and a pool containing all the strings. Strings
+         * which occur more than once (e.g., keys used in several sections) are stored once only. Lookups are binary
+         * searches in the tables and don't allocate any memory.
+         *
+         * Frozen files never change, therefore they can be shared between any number of threads. Copies share the
+         * data, copying is as cheap as copying a std::shared_ptr. Use DesktopFile::freeze() to create them, and
+         * thaw() to obtain a modifiable DesktopFile again.
+         */
+        class FrozenDesktopFile {
+        public:
+            // entries of a section, in the order they are stored, i.e., sorted by key
+            typedef std::vector<std::pair<std::string_view, std::string_view>> entries_t;
+
+        private:
+            // opaque data class pattern
+            // the private data is the header at the beginning of the buffer
+            class PrivateData;
+            std::shared_ptr<const PrivateData> d;
+
+            // (in)equality operators are implemented outside this class
+            friend bool operator==(const FrozenDesktopFile& first, const FrozenDesktopFile& second);
+            friend bool operator!=(const FrozenDesktopFile& first, const FrozenDesktopFile& second);
+
+            explicit FrozenDesktopFile(std::shared_ptr<const PrivateData> data);
+
+        public:
+            // default constructor
+            // creates an empty file
+            FrozenDesktopFile();
+
+            // pack the given file
+            explicit FrozenDesktopFile(const DesktopFile& file);
+
+            // copy constructor
+            // the copy shares the data with other
+            FrozenDesktopFile(const FrozenDesktopFile& other);
+
+            // copy assignment constructor
+            FrozenDesktopFile& operator=(const FrozenDesktopFile& other);
+
+            // move assignment operator
+            FrozenDesktopFile& operator=(FrozenDesktopFile&& other) noexcept;
+
+        public:
+            // returns true if the file does not contain any sections
+            bool isEmpty() const;
+
+            // returns the path associated with the file that has been frozen
+            std::string_view path() const;
+
+            // returns the number of bytes occupied by the data
+            size_t size() const;
+
+            // returns the names of all sections, sorted by name
+            std::vector<std::string_view> sectionNames() const;
+
+            // returns the entries of the given section
+            // throws UnknownSectionError if the section does not exist
+            entries_t entries(std::string_view section) const;
+
+            // check if section exists
+            bool sectionExists(std::string_view section) const;
+
+            // check if entry exists in given section and key
+            bool entryExists(std::string_view section, std::string_view key) const;
+
+            // look up the value of an entry
+            // the view is valid as long as this file or any copy of it exists
+            std::optional<std::string_view> findValue(std::string_view section, std::string_view key) const;
+
+            // get entry from frozen file
+            // returns true (and populates entry) if the key exists, false otherwise
+            bool getEntry(std::string_view section, std::string_view key, DesktopFileEntry& entry) const;
+
+            // returns the same hash DesktopFile::contentHash() returns for the file that has been frozen
+            uint64_t contentHash() const;
+
+            // unpack into a modifiable DesktopFile
+            DesktopFile thaw(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+            // serialize into a binary format, e.g., to pass the file to another process or to cache it
+            // the format consists of a small header (magic, format version, byte order) followed by the frozen data as
+            // it is, therefore serializing is a single copy
+            // this is the format to exchange files in if the receiver only reads them: loading it is more than an order
+            // of magnitude faster than parsing the text, but the data is larger than the text, as every entry needs a
+            // table record
+            // receivers which need a DesktopFile gain little, thawing builds the same hash tables parsing does
+            std::string serialize() const;
+
+        public:
+            // load data created by serialize()
+            // only needs to copy and bounds-check the data, no parsing is involved
+            // throws ParseError if the data is invalid, or has been created with an unsupported format version or on a
+            // machine with a different byte order
+            static FrozenDesktopFile deserialize(const char* data, size_t size);
+        };
+
+        // frozen files are equal if their paths and contents are equal
+        bool operator==(const FrozenDesktopFile& first, const FrozenDesktopFile& second);
+
+        // FrozenDesktopFile inequality operator
+        bool operator!=(const FrozenDesktopFile& first, const FrozenDesktopFile& second);
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+// system headers
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// local headers
+#include "desktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Maps icon names, e.g., the values of Icon keys, to files according to the icon theme specification.
+         *
+         * Looking up icons the way the specification describes it needs several stat calls per directory of every
+         * theme in the inheritance chain. Instead, the resolver reads every directory of a theme once when the theme
+         * is needed for the first time, and keeps an index of the icons in memory. Lookups are hash table probes then,
+         * and don't access the file system at all.
+         *
+         * The index is not updated automatically. Call refreshIfChanged() to discard the themes whose directories
+         * changed in the meantime, or invalidate() to discard the whole index.
+         *
+         * Resolvers are not thread-safe, as lookups may build the index.
+         */
+        class IconThemeResolver {
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // default constructor
+            // uses the hicolor theme and the default base directories
+            IconThemeResolver();
+
+            // use the given theme and the default base directories
+            explicit IconThemeResolver(std::string theme);
+
+            // use the given theme and base directories
+            // base directories are searched in the given order, earlier ones take precedence
+            IconThemeResolver(std::string theme, std::vector<std::string> baseDirectories);
+
+            // copy constructor
+            IconThemeResolver(const IconThemeResolver& other);
+
+            // copy assignment constructor
+            IconThemeResolver& operator=(const IconThemeResolver& other);
+
+            // move assignment operator
+            IconThemeResolver& operator=(IconThemeResolver&& other) noexcept;
+
+        public:
+            // returns the name of the theme icons are looked up in first
+            std::string theme() const;
+
+            // returns the directories containing the themes
+            std::vector<std::string> baseDirectories() const;
+
+            // look up the file for an icon with the given size and scale
+            // searches the theme, the themes it inherits from, hicolor, and finally the base directories themselves
+            // absolute paths are returned as they are if the file exists
+            // for compatibility with many existing desktop files, names ending in .png, .svg or .xpm are tried without
+            // the extension as well
+            // returns an empty string if the icon cannot be found
+            std::string resolve(std::string_view icon, int size = 48, int scale = 1);
+
+            // look up the file for the Icon key in the Desktop Entry section of the given file
+            // returns an empty string if the file doesn't have an icon, or if the icon cannot be found
+            std::string resolve(const DesktopFile& file, int size = 48, int scale = 1);
+
+            // discard the whole index
+            // it will be rebuilt on demand by the next lookups
+            void invalidate();
+
+            // check whether any of the directories indexed so far has been modified, and discard the index of all
+            // themes affected
+            // returns true if anything has been discarded
+            bool refreshIfChanged();
+
+        public:
+            // returns the base directories the specification describes: $HOME/.icons, the icons directories in
+            // $XDG_DATA_HOME and $XDG_DATA_DIRS, and /usr/share/pixmaps
+            static std::vector<std::string> defaultBaseDirectories();
+        };
+    }
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+// system headers
+#include <concepts>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+// local headers
+#include "linuxdeploy/desktopfile/validation.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /**
+         * Rules of the key file formats BasicKeyFileTokenizer can parse. DesktopFileTemplate applies the rules of
+         * DesktopEntryPolicy at compile time.
+         *
+         * All of the formats share the basic syntax of section headers and key-value pairs, but differ in the keys they
+         * permit. A policy is a class providing the following static members, which are evaluated at compile time:
+         *
+         *   // whether a key may be followed by a locale in brackets, like Name[de]
+         *   static constexpr bool localizedKeys;
+         *
+         *   // whether a key which appears more than once in a section is a syntax error
+         *   // otherwise, the tokenizer passes all of them to the handler, and ignores its return value
+         *   // handlers should let the last value win then, like GLib's key file parser, which most files are tested
+         *   // with
+         *   static constexpr bool rejectDuplicateKeys;
+         *
+         *   // how keys are referred to in error messages
+         *   static constexpr const char* keyNoun;
+         *
+         *   // whether a non-empty line is a comment
+         *   static constexpr bool isComment(std::string_view line);
+         *
+         *   // position of the first character which may not be used in a key (without the locale part)
+         *   // std::string_view::npos if all of them are valid
+         *   static constexpr size_t findInvalidKeyCharacter(std::string_view key);
+         */
+        template<typename Policy>
+        concept KeyFilePolicy = requires(std::string_view s) {
+            { Policy::localizedKeys } -> std::convertible_to<bool>;
+            { Policy::rejectDuplicateKeys } -> std::convertible_to<bool>;
+            { Policy::keyNoun } -> std::convertible_to<const char*>;
+            { Policy::isComment(s) } -> std::same_as<bool>;
+            { Policy::findInvalidKeyCharacter(s) } -> std::same_as<size_t>;
+        };
+
+        // desktop entries, i.e., .desktop and .directory files
+        class DesktopEntryPolicy {
+        public:
+            static constexpr bool localizedKeys = true;
+            static constexpr bool rejectDuplicateKeys = true;
+            static constexpr const char* keyNoun = "Key";
+
+            // only # is permitted by the specification, // is accepted for compatibility with older versions of this
+            // library
+            static constexpr bool isComment(std::string_view line) {
+                return line[0] == '#' || (line.size() >= 2 && line[0] == '/' && line[1] == '/');
+            }
+
+            static constexpr size_t findInvalidKeyCharacter(std::string_view key) {
+                return validation::findInvalidKeyNameCharacter(key);
+            }
+        };
+
+        // mimeapps.list and defaults.list, whose keys are MIME types
+        // duplicates are tolerated, as some tools append to the lists without checking for existing keys, the appended
+        // value is the one which is used
+        class MimeAppsPolicy {
+        public:
+            static constexpr bool localizedKeys = false;
+            static constexpr bool rejectDuplicateKeys = false;
+            static constexpr const char* keyNoun = "MIME type";
+
+            static constexpr bool isComment(std::string_view line) {
+                return line[0] == '#';
+            }
+
+            static constexpr size_t findInvalidKeyCharacter(std::string_view key) {
+                return validation::findInvalidMimeTypeCharacter(key);
+            }
+        };
+
+        // index.theme files of icon themes, which use the desktop entry key syntax
+        // duplicates are tolerated like GLib's key file parser does, which most themes are tested with only, the last
+        // value is the one which is used
+        class IconThemeIndexPolicy {
+        public:
+            static constexpr bool localizedKeys = true;
+            static constexpr bool rejectDuplicateKeys = false;
+            static constexpr const char* keyNoun = "Key";
+
+            static constexpr bool isComment(std::string_view line) {
+                return line[0] == '#';
+            }
+
+            static constexpr size_t findInvalidKeyCharacter(std::string_view key) {
+                return validation::findInvalidKeyNameCharacter(key);
+            }
+        };
+
+        /**
+         * Syntax rules shared by all key file formats.
+         *
+         * Used by both the runtime tokenizer and the compile-time parser of DesktopFileTemplate, which report the
+         * errors in their own ways. Everything can be evaluated in constant expressions.
+         */
+        namespace keyfilesyntax {
+            // std::string_view's search functions compare pointers to null internally, which GCC cannot evaluate in
+            // constant expressions when sanitizers are enabled, therefore simple loops are used there instead
+            constexpr size_t find(std::string_view s, char c, size_t position = 0) {
+                if (!std::is_constant_evaluated())
+                    return s.find(c, position);
+
+                for (; position < s.size(); ++position) {
+                    if (s[position] == c)
+                        return position;
+                }
+
+                return std::string_view::npos;
+            }
+
+            constexpr size_t findLast(std::string_view s, char c) {
+                if (!std::is_constant_evaluated())
+                    return s.find_last_of(c);
+
+                for (size_t position = s.size(); position > 0; --position) {
+                    if (s[position - 1] == c)
+                        return position - 1;
+                }
+
+                return std::string_view::npos;
+            }
+
+            // keys and values are trimmed, but only spaces are removed
+            constexpr std::string_view trim(std::string_view s) {
+                while (!s.empty() && s.front() == ' ')
+                    s.remove_prefix(1);
+
+                while (!s.empty() && s.back() == ' ')
+                    s.remove_suffix(1);
+
+                return s;
+            }
+
+            enum class SectionHeaderError {
+                None,
+                MultipleOpeningBrackets,
+                NoClosingBracket,
+                TwoOrMoreClosingBrackets,
+            };
+
+            // parses a line starting with [, the name is only set if there is no error
+            constexpr SectionHeaderError parseSectionHeader(std::string_view line, std::string_view& name) {
+                if (findLast(line, '[') != 0)
+                    return SectionHeaderError::MultipleOpeningBrackets;
+
+                const auto closingBracketPos = find(line, ']');
+
+                if (closingBracketPos == std::string_view::npos)
+                    return SectionHeaderError::NoClosingBracket;
+
+                if (closingBracketPos != findLast(line, ']'))
+                    return SectionHeaderError::TwoOrMoreClosingBrackets;
+
+                name = line.substr(1, closingBracketPos - 1);
+                return SectionHeaderError::None;
+            }
+
+            // splits a key into its name and its locale part (including the brackets), if the format permits locales
+            template<KeyFilePolicy Policy>
+            constexpr void splitKey(std::string_view key, std::string_view& name, std::string_view& locale) {
+                name = key;
+                locale = {};
+
+                if constexpr (Policy::localizedKeys) {
+                    const auto openingBracketPos = find(key, '[');
+
+                    if (openingBracketPos != std::string_view::npos) {
+                        name = key.substr(0, openingBracketPos);
+                        locale = key.substr(openingBracketPos);
+                    }
+                }
+            }
+
+            enum class LocaleError {
+                None,
+                MismatchingBrackets,
+                InvalidOpeningBracketPosition,
+                InvalidClosingBracketPosition,
+            };
+
+            // checks the locale part of a key as returned by splitKey()
+            // the syntax within the brackets is not tested by intention, as some KDE apps use a locale called "x-test"
+            // for some reason, strict validation of the locale part broke all AppImage builds on the KDE binary factory
+            constexpr LocaleError checkLocale(std::string_view locale) {
+                size_t openingBrackets = 0;
+
+                for (size_t i = 0; i < locale.size(); ++i) {
+                    if (locale[i] == '[')
+                        ++openingBrackets;
+                }
+
+                if (openingBrackets != 1)
+                    return LocaleError::MismatchingBrackets;
+
+                // just for clarification: _this_ should never happen, given how splitKey() splits keys
+                if (find(locale, '[') != 0)
+                    return LocaleError::InvalidOpeningBracketPosition;
+
+                if (find(locale, ']') != locale.size() - 1)
+                    return LocaleError::InvalidClosingBracketPosition;
+
+                return LocaleError::None;
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// system headers
+#include <cstdint>
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Memory used by the data of an object, see DesktopFile::memoryUsage().
+         *
+         * The numbers are estimates based on the sizes of the objects involved and the typical layout of the standard
+         * library's containers. They do not include the overhead of the memory allocator itself. Data allocated from
+         * a caller-provided memory resource is included, too.
+         */
+        class MemoryUsage {
+        public:
+            // characters of strings which don't fit into the small string buffer: keys, values, section names, paths
+            uint64_t stringBytes = 0;
+
+            // hash table buckets, map nodes and vector buffers, including the (non-character part of the) strings
+            // stored in them
+            uint64_t containerBytes = 0;
+
+            // private data objects and the control blocks of the shared pointers referring to them
+            uint64_t privateDataBytes = 0;
+
+        public:
+            // returns the sum of all categories
+            uint64_t total() const;
+
+            // add up usage
+            MemoryUsage& operator+=(const MemoryUsage& other);
+        };
+    }
+}
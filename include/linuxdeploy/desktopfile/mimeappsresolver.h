@@ -0,0 +1,92 @@
+#pragma once
+
+// system headers
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// local headers
+#include "desktopfileoverlay.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Answers which applications open which MIME types, according to the MIME applications associations
+         * specification.
+         *
+         * The mimeapps.list (and legacy defaults.list) files are read once, and merged with the MimeType keys of the
+         * installed applications into maps from MIME types to the default application and to all associated
+         * applications. Queries are map lookups then, and don't read any files.
+         *
+         * The lists are merged in the order of precedence:
+         *
+         *   - [Default Applications]: the first installed application listed for a MIME type, in the list with the
+         *     highest precedence which names an installed one, becomes the default
+         *   - [Removed Associations]: removes associations added by the same or lower-precedence lists, as well as
+         *     the ones declared by the applications themselves
+         *   - [Added Associations]: associates applications with MIME types, ahead of the associations declared by
+         *     the applications themselves
+         *
+         * If there is no default for a MIME type, the first associated application is used instead.
+         *
+         * The data is loaded on construction and by load(). Loading is not thread-safe, all const methods are.
+         */
+        class MimeAppsResolver {
+        public:
+            // maps paths of lists which could not be parsed to the respective error messages
+            typedef std::map<std::string, std::string> errors_t;
+
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // default constructor
+            // creates an empty resolver without any lists or applications
+            MimeAppsResolver();
+
+            // use the given lists, which are ordered by precedence, and the applications provided by the overlay
+            // lists which don't exist are ignored
+            MimeAppsResolver(std::vector<std::string> listPaths, DesktopFileOverlay applications);
+
+            // copy constructor
+            MimeAppsResolver(const MimeAppsResolver& other);
+
+            // copy assignment constructor
+            MimeAppsResolver& operator=(const MimeAppsResolver& other);
+
+            // move assignment operator
+            MimeAppsResolver& operator=(MimeAppsResolver&& other) noexcept;
+
+        public:
+            // returns the lists in the order of precedence
+            std::vector<std::string> listPaths() const;
+
+            // returns the desktop file ID of the default application for the MIME type
+            // returns an empty string if no installed application is associated with the MIME type
+            std::string defaultApplication(std::string_view mimeType) const;
+
+            // returns the desktop file IDs of all installed applications associated with the MIME type, the most
+            // preferred one first
+            // the default application is not necessarily part of them, as defaults need not be associated explicitly
+            std::vector<std::string> applications(std::string_view mimeType) const;
+
+            // returns the lists which could not be parsed
+            errors_t errors() const;
+
+            // (re-)read the lists, and recalculate the associations
+            // the applications are not reloaded, see DesktopFileOverlay::load()
+            void load();
+
+        public:
+            // returns the lists the specification describes, including the desktop-specific ones for the desktops
+            // listed in $XDG_CURRENT_DESKTOP: the mimeapps.list files in $XDG_CONFIG_HOME and $XDG_CONFIG_DIRS, followed
+            // by the mimeapps.list and defaults.list files in the applications directories in $XDG_DATA_HOME and
+            // $XDG_DATA_DIRS
+            static std::vector<std::string> defaultListPaths();
+        };
+    }
+}
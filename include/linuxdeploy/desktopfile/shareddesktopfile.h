@@ -0,0 +1,64 @@
+#pragma once
+
+// system headers
+#include <functional>
+#include <memory>
+
+// local headers
+#include "desktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Desktop file shared between threads, read by many of them and modified by a few.
+         *
+         * The file is published as an immutable snapshot. Readers obtain the current snapshot with snapshot(), which
+         * neither blocks nor copies any data, and can keep using it as long as they like. Writers never modify a
+         * published snapshot. They modify a copy of it instead, and publish the copy as the new snapshot. Old snapshots
+         * are freed once the last reader drops them.
+         */
+        class SharedDesktopFile {
+        public:
+            // immutable state of the file at a given point in time
+            typedef std::shared_ptr<const DesktopFile> snapshot_t;
+
+        private:
+            // opaque data class pattern
+            class PrivateData;
+            std::shared_ptr<PrivateData> d;
+
+        public:
+            // default constructor
+            // publishes an empty file
+            SharedDesktopFile();
+
+            // publish the given file
+            explicit SharedDesktopFile(DesktopFile file);
+
+            // copy constructor
+            // the copy starts out with the current snapshot, updates are not shared, though
+            SharedDesktopFile(const SharedDesktopFile& other);
+
+            // copy assignment constructor
+            SharedDesktopFile& operator=(const SharedDesktopFile& other);
+
+            // move assignment operator
+            SharedDesktopFile& operator=(SharedDesktopFile&& other) noexcept;
+
+        public:
+            // returns the current snapshot
+            // safe to call from any thread at any time
+            snapshot_t snapshot() const;
+
+            // replace the current snapshot with the given file
+            void publish(DesktopFile file);
+
+            // copy the current snapshot, call modify on the copy, and publish the result
+            // if another thread publishes a snapshot in the meantime, the update is repeated with the new snapshot,
+            // therefore modify may be called more than once, and must not have any other side effects
+            // if modify throws, nothing is published, and the exception is passed on
+            // returns the snapshot published by this call
+            snapshot_t update(const std::function<void(DesktopFile&)>& modify);
+        };
+    }
+}
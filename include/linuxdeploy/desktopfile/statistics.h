@@ -0,0 +1,96 @@
+#pragma once
+
+// system headers
+#include <cstdint>
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Counters and phase timings collected while parsing desktop files.
+         *
+         * Statistics are only collected if the library has been built with ENABLE_STATISTICS=ON (see
+         * statisticsEnabled()). Otherwise, all values remain zero, and collecting them does not cost anything.
+         */
+        class ParseStatistics {
+        public:
+            // bytes consumed from the input
+            uint64_t bytesRead = 0;
+
+            // lines processed, including empty lines and comments
+            uint64_t lines = 0;
+
+            // section headers found
+            uint64_t sections = 0;
+
+            // key-value pairs found
+            uint64_t entries = 0;
+
+            // keys with a locale suffix, e.g., Name[de]
+            uint64_t localizedKeys = 0;
+
+            // heap allocations needed to store the parsed data: map nodes, entries, and strings too long for the
+            // small string buffer
+            uint64_t allocations = 0;
+
+            // time spent reading from the input
+            uint64_t ioNanoseconds = 0;
+
+            // time spent splitting lines into section headers, keys and values
+            uint64_t tokenizeNanoseconds = 0;
+
+            // time spent validating keys and locales, and checking for duplicates
+            uint64_t validationNanoseconds = 0;
+
+            // time spent inserting sections and entries into the data structures
+            uint64_t insertionNanoseconds = 0;
+
+        public:
+            // add up statistics
+            ParseStatistics& operator+=(const ParseStatistics& other);
+        };
+
+        /*
+         * Counters and phase timings collected while serializing desktop files.
+         *
+         * See ParseStatistics for information on when statistics are available.
+         */
+        class SerializeStatistics {
+        public:
+            // bytes written to the output
+            uint64_t bytesWritten = 0;
+
+            // sections written
+            uint64_t sections = 0;
+
+            // key-value pairs written
+            uint64_t entries = 0;
+
+            // heap allocations made while formatting the data
+            uint64_t allocations = 0;
+
+            // time spent formatting the data
+            uint64_t formatNanoseconds = 0;
+
+            // time spent writing to the output
+            uint64_t ioNanoseconds = 0;
+
+        public:
+            // add up statistics
+            SerializeStatistics& operator+=(const SerializeStatistics& other);
+        };
+
+        // returns true if the library has been built with statistics support
+        bool statisticsEnabled();
+
+        // returns the sum of the statistics of all the parse operations in this process so far
+        // safe to call from any thread
+        ParseStatistics globalParseStatistics();
+
+        // returns the sum of the statistics of all the serialize operations in this process so far
+        // safe to call from any thread
+        SerializeStatistics globalSerializeStatistics();
+
+        // reset the process-wide statistics to zero
+        void resetGlobalStatistics();
+    }
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+// system headers
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace validation {
+            /**
+             * Lookup table for the characters allowed in key names (without the locale part), generated at compile
+             * time. According to the specification, only A-Za-z0-9- are allowed.
+             */
+            constexpr std::array<bool, 256> keyNameCharacters = [] {
+                std::array<bool, 256> table{};
+
+                for (int c = 0; c < 256; ++c) {
+                    table[c] = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-';
+                }
+
+                return table;
+            }();
+
+            /**
+             * Check whether a character may be used in key names.
+             * @param c character to check
+             * @return true if valid, false otherwise
+             */
+            constexpr bool isKeyNameCharacter(char c) {
+                return keyNameCharacters[static_cast<unsigned char>(c)];
+            }
+
+            /**
+             * Find the first character which may not be used in key names.
+             * @param name key name without the locale part
+             * @return position of the first invalid character, std::string_view::npos if all characters are valid
+             */
+            constexpr size_t findInvalidKeyNameCharacter(std::string_view name) {
+                for (size_t i = 0; i < name.size(); ++i) {
+                    if (!isKeyNameCharacter(name[i]))
+                        return i;
+                }
+
+                return std::string_view::npos;
+            }
+
+            /**
+             * Lookup table for the characters allowed in MIME types, which are used as keys in mimeapps.list and
+             * defaults.list. Besides the characters allowed in key names, RFC 6838 permits !#$&^_.+ in type and subtype
+             * names, which are separated by a slash.
+             */
+            constexpr std::array<bool, 256> mimeTypeCharacters = [] {
+                std::array<bool, 256> table = keyNameCharacters;
+
+                for (const char c : std::string_view("!#$&^_.+/"))
+                    table[static_cast<unsigned char>(c)] = true;
+
+                return table;
+            }();
+
+            /**
+             * Find the first character which may not be used in MIME types.
+             * @param mimeType MIME type to check
+             * @return position of the first invalid character, std::string_view::npos if all characters are valid
+             */
+            constexpr size_t findInvalidMimeTypeCharacter(std::string_view mimeType) {
+                for (size_t i = 0; i < mimeType.size(); ++i) {
+                    if (!mimeTypeCharacters[static_cast<unsigned char>(mimeType[i])])
+                        return i;
+                }
+
+                return std::string_view::npos;
+            }
+
+            namespace utf8 {
+                // byte classes, bytes in the same class cause the same transitions
+                enum Class : uint8_t {
+                    Ascii,              // 00..7F
+                    Continuation80,     // 80..8F
+                    Continuation90,     // 90..9F
+                    ContinuationA0,     // A0..BF
+                    Invalid,            // C0..C1 (overlong), F5..FF (beyond U+10FFFF)
+                    Lead2,              // C2..DF
+                    LeadE0,             // E0, must not be overlong
+                    Lead3,              // E1..EC, EE..EF
+                    LeadED,             // ED, must not encode surrogates
+                    LeadF0,             // F0, must not be overlong
+                    Lead4,              // F1..F3
+                    LeadF4,             // F4, must not exceed U+10FFFF
+                    ClassCount,
+                };
+
+                enum State : uint8_t {
+                    Accept,
+                    Reject,
+                    Need1,              // one more continuation byte
+                    Need2,              // two more continuation bytes
+                    Need3,              // three more continuation bytes
+                    AfterE0,            // A0..BF, then one more
+                    AfterED,            // 80..9F, then one more
+                    AfterF0,            // 90..BF, then two more
+                    AfterF4,            // 80..8F, then two more
+                    StateCount,
+                };
+
+                constexpr std::array<uint8_t, 256> classes = [] {
+                    std::array<uint8_t, 256> table{};
+
+                    for (int c = 0; c < 256; ++c) {
+                        Class cls;
+
+                        if (c <= 0x7F) cls = Ascii;
+                        else if (c <= 0x8F) cls = Continuation80;
+                        else if (c <= 0x9F) cls = Continuation90;
+                        else if (c <= 0xBF) cls = ContinuationA0;
+                        else if (c <= 0xC1) cls = Invalid;
+                        else if (c <= 0xDF) cls = Lead2;
+                        else if (c == 0xE0) cls = LeadE0;
+                        else if (c == 0xED) cls = LeadED;
+                        else if (c <= 0xEF) cls = Lead3;
+                        else if (c == 0xF0) cls = LeadF0;
+                        else if (c <= 0xF3) cls = Lead4;
+                        else if (c == 0xF4) cls = LeadF4;
+                        else cls = Invalid;
+
+                        table[c] = cls;
+                    }
+
+                    return table;
+                }();
+
+                constexpr uint8_t transition(uint8_t state, uint8_t cls) {
+                    const bool continuation = cls == Continuation80 || cls == Continuation90 || cls == ContinuationA0;
+
+                    switch (state) {
+                        case Accept:
+                            switch (cls) {
+                                case Ascii: return Accept;
+                                case Lead2: return Need1;
+                                case LeadE0: return AfterE0;
+                                case Lead3: return Need2;
+                                case LeadED: return AfterED;
+                                case LeadF0: return AfterF0;
+                                case Lead4: return Need3;
+                                case LeadF4: return AfterF4;
+                                default: return Reject;
+                            }
+                        case Need1: return continuation ? Accept : Reject;
+                        case Need2: return continuation ? Need1 : Reject;
+                        case Need3: return continuation ? Need2 : Reject;
+                        case AfterE0: return cls == ContinuationA0 ? Need1 : Reject;
+                        case AfterED: return cls == Continuation80 || cls == Continuation90 ? Need1 : Reject;
+                        case AfterF0: return cls == Continuation90 || cls == ContinuationA0 ? Need2 : Reject;
+                        case AfterF4: return cls == Continuation80 ? Need2 : Reject;
+                        default: return Reject;
+                    }
+                }
+
+                // deterministic finite automaton, generated at compile time from the rules above
+                constexpr std::array<std::array<uint8_t, ClassCount>, StateCount> transitions = [] {
+                    std::array<std::array<uint8_t, ClassCount>, StateCount> table{};
+
+                    for (uint8_t state = 0; state < StateCount; ++state) {
+                        for (uint8_t cls = 0; cls < ClassCount; ++cls)
+                            table[state][cls] = transition(state, cls);
+                    }
+
+                    return table;
+                }();
+            }
+
+            /**
+             * Runtime implementation of isValidUtf8(), defined in the library.
+             *
+             * Most values in desktop files are plain ASCII. Therefore, ASCII is skipped 16 bytes at a time with SSE2
+             * (8 bytes at a time on other architectures), and only the other bytes are run through the automaton.
+             */
+            bool isValidUtf8Blocks(const char* data, size_t size);
+
+            /**
+             * Check whether data is valid UTF-8, i.e., contains neither overlong encodings nor surrogates nor code
+             * points beyond U+10FFFF, and doesn't end in the middle of a sequence.
+             *
+             * Can be used in constant expressions as well, where the bytes are checked one at a time.
+             *
+             * @param data data to check
+             * @param size size of data
+             * @return true if valid, false otherwise
+             */
+            constexpr bool isValidUtf8(const char* data, size_t size) {
+                if (!std::is_constant_evaluated())
+                    return isValidUtf8Blocks(data, size);
+
+                uint8_t state = utf8::Accept;
+
+                for (size_t i = 0; i < size; ++i)
+                    state = utf8::transitions[state][utf8::classes[static_cast<unsigned char>(data[i])]];
+
+                return state == utf8::Accept;
+            }
+
+            /**
+             * Check whether a string view is valid UTF-8.
+             * @param data data to check
+             * @return true if valid, false otherwise
+             */
+            constexpr bool isValidUtf8(std::string_view data) {
+                return isValidUtf8(data.data(), data.size());
+            }
+        }
+    }
+}
@@ -0,0 +1,675 @@
+// system headers
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <initializer_list>
+#include <linux/io_uring.h>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// local headers
+#include "batchio.h"
+#include "parallel.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            // files are read in chunks of this size, only few desktop files are larger
+            constexpr size_t initialReadSize = 16 * 1024;
+
+            // maximum number of files processed per io_uring batch, determines the size of the rings
+            constexpr unsigned ringEntries = 256;
+
+            // permissions of new files, the same std::ofstream uses (modified by the umask)
+            constexpr mode_t newFileMode = 0666;
+
+            // the threads spend most of their time blocked in system calls, therefore more threads than cores are used
+            size_t ioThreadCount() {
+                return std::max<size_t>(8, defaultThreadCount());
+            }
+
+            /**
+             * Minimal io_uring wrapper using the raw system calls, so that liburing is not needed.
+             *
+             * Entries are prepared with prepare(), and submitted all at once with submitAndComplete(), which waits for
+             * all of them to complete.
+             */
+            class IoUring {
+            private:
+                int ringFd = -1;
+
+                void* sqRing = MAP_FAILED;
+                size_t sqRingSize = 0;
+                void* cqRing = MAP_FAILED;
+                size_t cqRingSize = 0;
+                void* sqesMemory = MAP_FAILED;
+                size_t sqesSize = 0;
+
+                unsigned* sqTail = nullptr;
+                unsigned* sqMask = nullptr;
+                unsigned* sqArray = nullptr;
+                unsigned sqEntries = 0;
+                io_uring_sqe* sqes = nullptr;
+
+                unsigned* cqHead = nullptr;
+                unsigned* cqTail = nullptr;
+                unsigned* cqMask = nullptr;
+                io_uring_cqe* cqes = nullptr;
+
+                // entries prepared, but not submitted yet
+                unsigned prepared = 0;
+
+            public:
+                explicit IoUring(unsigned entries) {
+                    io_uring_params params{};
+
+                    ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+
+                    if (ringFd < 0)
+                        return;
+
+                    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+                    // newer kernels map both rings with a single mmap call
+                    const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+                    if (singleMmap)
+                        sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+                    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                                  IORING_OFF_SQ_RING);
+
+                    if (sqRing == MAP_FAILED) {
+                        release();
+                        return;
+                    }
+
+                    if (!singleMmap) {
+                        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                                      IORING_OFF_CQ_RING);
+
+                        if (cqRing == MAP_FAILED) {
+                            release();
+                            return;
+                        }
+                    }
+
+                    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+                    sqesMemory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                                      IORING_OFF_SQES);
+
+                    if (sqesMemory == MAP_FAILED) {
+                        release();
+                        return;
+                    }
+
+                    auto* sq = static_cast<char*>(sqRing);
+                    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                    sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                    sqEntries = params.sq_entries;
+                    sqes = static_cast<io_uring_sqe*>(sqesMemory);
+
+                    auto* cq = static_cast<char*>(singleMmap ? sqRing : cqRing);
+                    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                    cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+                }
+
+                ~IoUring() {
+                    release();
+                }
+
+                IoUring(const IoUring&) = delete;
+                IoUring& operator=(const IoUring&) = delete;
+
+            private:
+                void release() {
+                    if (sqesMemory != MAP_FAILED)
+                        munmap(sqesMemory, sqesSize);
+                    if (cqRing != MAP_FAILED)
+                        munmap(cqRing, cqRingSize);
+                    if (sqRing != MAP_FAILED)
+                        munmap(sqRing, sqRingSize);
+                    if (ringFd >= 0)
+                        close(ringFd);
+
+                    sqesMemory = cqRing = sqRing = MAP_FAILED;
+                    ringFd = -1;
+                }
+
+            public:
+                bool isValid() const {
+                    return ringFd >= 0;
+                }
+
+                // maximum number of entries which can be prepared per submitAndComplete() call
+                unsigned capacity() const {
+                    return sqEntries;
+                }
+
+                // check whether the kernel supports all the given operations (needs Linux 5.6 or newer)
+                bool supports(std::initializer_list<unsigned> operations) const {
+                    constexpr unsigned maxOperations = 256;
+
+                    std::vector<char> buffer(sizeof(io_uring_probe) + maxOperations * sizeof(io_uring_probe_op));
+                    auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+
+                    if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, maxOperations) < 0)
+                        return false;
+
+                    return std::all_of(operations.begin(), operations.end(), [probe](unsigned operation) {
+                        return operation <= probe->last_op && (probe->ops[operation].flags & IO_URING_OP_SUPPORTED) != 0;
+                    });
+                }
+
+                // returns a cleared submission queue entry
+                // must not be called more than capacity() times per submitAndComplete()
+                io_uring_sqe* prepare(uint8_t opcode, int fd, uint64_t userData) {
+                    // only this process writes the tail, therefore it can be read without synchronization
+                    const auto index = (*sqTail + prepared) & *sqMask;
+
+                    auto* sqe = &sqes[index];
+                    std::memset(sqe, 0, sizeof(*sqe));
+                    sqe->opcode = opcode;
+                    sqe->fd = fd;
+                    sqe->user_data = userData;
+
+                    sqArray[index] = index;
+                    ++prepared;
+
+                    return sqe;
+                }
+
+                // submit all the prepared entries with a single system call, and wait for their completion
+                // handler is called with the user data and the result of every entry
+                // returns false if io_uring_enter fails, in which case the state of the entries is unknown
+                template<typename Handler>
+                bool submitAndComplete(Handler&& handler) {
+                    __atomic_store_n(sqTail, *sqTail + prepared, __ATOMIC_RELEASE);
+
+                    unsigned toSubmit = prepared;
+                    unsigned outstanding = prepared;
+                    prepared = 0;
+
+                    while (outstanding > 0) {
+                        const auto submitted = syscall(__NR_io_uring_enter, ringFd, toSubmit, outstanding,
+                                                       IORING_ENTER_GETEVENTS, nullptr, 0);
+
+                        if (submitted < 0) {
+                            if (errno == EINTR)
+                                continue;
+
+                            return false;
+                        }
+
+                        toSubmit -= static_cast<unsigned>(submitted);
+
+                        // only this process writes the head
+                        auto head = *cqHead;
+                        const auto tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+
+                        for (; head != tail; ++head) {
+                            const auto& cqe = cqes[head & *cqMask];
+                            handler(cqe.user_data, cqe.res);
+                            --outstanding;
+                        }
+
+                        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+                    }
+
+                    return true;
+                }
+            };
+
+            // per file state while processing a batch
+            class FileState {
+            public:
+                int fd = -1;
+                size_t done = 0;
+            };
+
+            template<typename Handler>
+            void closeFiles(IoUring& ring, std::vector<FileState>& states, Handler&& handler) {
+                for (size_t i = 0; i < states.size(); ++i) {
+                    if (states[i].fd >= 0)
+                        ring.prepare(IORING_OP_CLOSE, states[i].fd, i);
+                }
+
+                // the descriptors are released even if the close operations report errors, there is no point in
+                // retrying
+                if (!ring.submitAndComplete(std::forward<Handler>(handler))) {
+                    for (auto& state : states) {
+                        if (state.fd >= 0)
+                            close(state.fd);
+                    }
+                }
+
+                for (auto& state : states)
+                    state.fd = -1;
+            }
+
+            // used if the ring fails while files are open
+            void closeFilesDirectly(std::vector<FileState>& states) {
+                for (auto& state : states) {
+                    if (state.fd >= 0)
+                        close(state.fd);
+
+                    state.fd = -1;
+                }
+            }
+
+            // files are written to a temporary file next to the target first, which replaces the target once all
+            // the data has been written, so that a failed write or a crash never leaves a truncated file behind
+            std::string temporaryPath(const std::string& target) {
+                static std::atomic<unsigned> counter{0};
+                return target + "." + std::to_string(getpid()) + "-" + std::to_string(counter++) + ".tmp";
+            }
+
+            // symlinks are written through, i.e., the file they point to is replaced rather than the link
+            std::string resolveTarget(const std::string& path) {
+                std::unique_ptr<char, decltype(&free)> resolved(realpath(path.c_str(), nullptr), &free);
+                return resolved != nullptr ? std::string(resolved.get()) : path;
+            }
+
+            // replace the target with the temporary file if writing succeeded, otherwise remove the temporary file
+            // returns the error, which is set if the file cannot be replaced
+            int replaceFile(const std::string& temporary, const std::string& target, int error) {
+                struct stat st{};
+
+                // existing files keep their permissions, and their owner if possible (i.e., when running as root)
+                if (error == 0 && stat(target.c_str(), &st) == 0) {
+                    if (chmod(temporary.c_str(), st.st_mode & 07777) != 0)
+                        error = errno;
+                    else if (chown(temporary.c_str(), st.st_uid, st.st_gid) != 0 && errno != EPERM)
+                        error = errno;
+                }
+
+                if (error == 0 && rename(temporary.c_str(), target.c_str()) != 0)
+                    error = errno;
+
+                if (error != 0)
+                    unlink(temporary.c_str());
+
+                return error;
+            }
+
+            // read requests [begin, begin + count) with io_uring
+            // returns false if the ring failed, the requests must then be processed in another way
+            bool readBatch(IoUring& ring, std::vector<BatchReadRequest>& requests, size_t begin, size_t count) {
+                std::vector<FileState> states(count);
+                std::vector<struct statx> sizes(count);
+
+                // the requests are processed by the fallback then, which must not see any partial results
+                auto abort = [&]() {
+                    closeFilesDirectly(states);
+
+                    for (size_t i = 0; i < count; ++i) {
+                        requests[begin + i].contents.clear();
+                        requests[begin + i].error = 0;
+                    }
+
+                    return false;
+                };
+
+                // the sizes are determined along with opening the files, so that the buffers can be allocated
+                // accordingly, which is a lot cheaper than allocating (and initializing) large enough buffers for all
+                // the files
+                for (size_t i = 0; i < count; ++i) {
+                    const auto& path = requests[begin + i].path;
+
+                    auto* openSqe = ring.prepare(IORING_OP_OPENAT, AT_FDCWD, 2 * i);
+                    openSqe->addr = reinterpret_cast<uintptr_t>(path.c_str());
+                    openSqe->open_flags = O_RDONLY | O_CLOEXEC;
+
+                    auto* statxSqe = ring.prepare(IORING_OP_STATX, AT_FDCWD, 2 * i + 1);
+                    statxSqe->addr = reinterpret_cast<uintptr_t>(path.c_str());
+                    statxSqe->len = STATX_SIZE;
+                    statxSqe->off = reinterpret_cast<uintptr_t>(&sizes[i]);
+                }
+
+                if (!ring.submitAndComplete([&](uint64_t userData, int result) {
+                    const auto i = userData / 2;
+
+                    // statx fails in the same way as opening the file, e.g., if the file does not exist
+                    if (userData % 2 == 1) {
+                        if (result < 0)
+                            sizes[i].stx_size = 0;
+
+                        return;
+                    }
+
+                    if (result < 0)
+                        requests[begin + i].error = -result;
+                    else
+                        states[i].fd = result;
+                }))
+                    return abort();
+
+                std::vector<size_t> pendingReads, nextReads;
+
+                for (size_t i = 0; i < count; ++i) {
+                    if (states[i].fd >= 0) {
+                        // one more byte than expected is requested, so that a short read indicates the end of the file
+                        // files which grew in the meantime are read completely nevertheless
+                        requests[begin + i].contents.resize(static_cast<size_t>(sizes[i].stx_size) + 1);
+                        pendingReads.emplace_back(i);
+                    }
+                }
+
+                while (!pendingReads.empty()) {
+                    for (const auto i : pendingReads) {
+                        auto& contents = requests[begin + i].contents;
+
+                        auto* sqe = ring.prepare(IORING_OP_READ, states[i].fd, i);
+                        sqe->addr = reinterpret_cast<uintptr_t>(&contents[states[i].done]);
+                        sqe->len = static_cast<uint32_t>(contents.size() - states[i].done);
+                        sqe->off = states[i].done;
+                    }
+
+                    nextReads.clear();
+
+                    const bool success = ring.submitAndComplete([&](uint64_t i, int result) {
+                        auto& request = requests[begin + i];
+
+                        if (result < 0) {
+                            request.error = -result;
+                            return;
+                        }
+
+                        states[i].done += result;
+
+                        // reads from regular files only return less data than requested at the end of the file,
+                        // which saves one read per file compared to reading until read returns 0
+                        if (result > 0 && states[i].done == request.contents.size()) {
+                            request.contents.resize(std::max(request.contents.size() * 2, initialReadSize));
+                            nextReads.emplace_back(i);
+                        }
+                    });
+
+                    if (!success)
+                        return abort();
+
+                    pendingReads.swap(nextReads);
+                }
+
+                for (size_t i = 0; i < count; ++i) {
+                    auto& request = requests[begin + i];
+                    request.contents.resize(request.error == 0 ? states[i].done : 0);
+                }
+
+                closeFiles(ring, states, [](size_t, int) {});
+
+                return true;
+            }
+
+            // write requests [begin, begin + count) with io_uring
+            // returns false if the ring failed, the requests must then be processed in another way
+            bool writeBatch(IoUring& ring, std::vector<BatchWriteRequest>& requests, size_t begin, size_t count) {
+                std::vector<FileState> states(count);
+                std::vector<std::string> targets(count);
+                std::vector<std::string> temporaries(count);
+
+                // set once the temporary file has been created, only those may be removed
+                std::vector<char> created(count, false);
+
+                // the requests are processed by the fallback then, which creates its own temporary files
+                auto abort = [&]() {
+                    closeFilesDirectly(states);
+
+                    for (size_t i = 0; i < count; ++i) {
+                        if (created[i])
+                            unlink(temporaries[i].c_str());
+                    }
+
+                    return false;
+                };
+
+                for (size_t i = 0; i < count; ++i) {
+                    targets[i] = resolveTarget(requests[begin + i].path);
+                    temporaries[i] = temporaryPath(targets[i]);
+
+                    auto* sqe = ring.prepare(IORING_OP_OPENAT, AT_FDCWD, i);
+                    sqe->addr = reinterpret_cast<uintptr_t>(temporaries[i].c_str());
+                    sqe->open_flags = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+                    sqe->len = newFileMode;
+                }
+
+                if (!ring.submitAndComplete([&](uint64_t i, int result) {
+                    if (result < 0) {
+                        requests[begin + i].error = -result;
+                    } else {
+                        states[i].fd = result;
+                        created[i] = true;
+                    }
+                }))
+                    return abort();
+
+                // partial writes are continued until all the data has been written
+                std::vector<size_t> pendingWrites, nextWrites;
+
+                for (size_t i = 0; i < count; ++i) {
+                    if (states[i].fd >= 0 && !requests[begin + i].contents.empty())
+                        pendingWrites.emplace_back(i);
+                }
+
+                while (!pendingWrites.empty()) {
+                    for (const auto i : pendingWrites) {
+                        const auto& contents = requests[begin + i].contents;
+
+                        auto* sqe = ring.prepare(IORING_OP_WRITE, states[i].fd, i);
+                        sqe->addr = reinterpret_cast<uintptr_t>(contents.data() + states[i].done);
+                        sqe->len = static_cast<uint32_t>(contents.size() - states[i].done);
+                        sqe->off = states[i].done;
+                    }
+
+                    nextWrites.clear();
+
+                    const bool success = ring.submitAndComplete([&](uint64_t i, int result) {
+                        auto& request = requests[begin + i];
+
+                        if (result < 0) {
+                            request.error = -result;
+                            return;
+                        }
+
+                        states[i].done += result;
+
+                        if (result > 0 && states[i].done < request.contents.size())
+                            nextWrites.emplace_back(i);
+                        else if (result == 0)
+                            request.error = EIO;
+                    });
+
+                    if (!success)
+                        return abort();
+
+                    pendingWrites.swap(nextWrites);
+                }
+
+                // the data must be on disk before the files are renamed, otherwise a crash could leave empty files
+                for (size_t i = 0; i < count; ++i) {
+                    if (states[i].fd >= 0 && requests[begin + i].error == 0)
+                        ring.prepare(IORING_OP_FSYNC, states[i].fd, i);
+                }
+
+                if (!ring.submitAndComplete([&](uint64_t i, int result) {
+                    if (result < 0)
+                        requests[begin + i].error = -result;
+                }))
+                    return abort();
+
+                // errors reported by close mean that the data might not have been written, e.g., on network file systems
+                closeFiles(ring, states, [&](size_t i, int result) {
+                    if (result < 0 && requests[begin + i].error == 0)
+                        requests[begin + i].error = -result;
+                });
+
+                for (size_t i = 0; i < count; ++i) {
+                    if (created[i])
+                        requests[begin + i].error = replaceFile(temporaries[i], targets[i], requests[begin + i].error);
+                }
+
+                return true;
+            }
+
+            int readFile(BatchReadRequest& request) {
+                const int fd = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+
+                if (fd < 0)
+                    return errno;
+
+                // the first chunk is read into an uninitialized buffer on the stack, which avoids both a call to
+                // fstat and initializing a large string buffer, only files larger than that are read into the string
+                // directly
+                char buffer[initialReadSize];
+
+                auto& contents = request.contents;
+                int error = 0;
+
+                // the first read below relies on an empty string
+                contents.clear();
+
+                while (true) {
+                    const bool useBuffer = contents.empty();
+                    const size_t capacity = useBuffer ? sizeof(buffer) : contents.size();
+
+                    if (!useBuffer)
+                        contents.resize(contents.size() * 2);
+
+                    char* destination = useBuffer ? buffer : &contents[contents.size() - capacity];
+
+                    ssize_t result;
+                    do {
+                        result = read(fd, destination, capacity);
+                    } while (result < 0 && errno == EINTR);
+
+                    if (result < 0) {
+                        error = errno;
+                        break;
+                    }
+
+                    if (useBuffer)
+                        contents.assign(buffer, static_cast<size_t>(result));
+                    else
+                        contents.resize(contents.size() - capacity + static_cast<size_t>(result));
+
+                    // see readBatch()
+                    if (static_cast<size_t>(result) < capacity)
+                        break;
+                }
+
+                close(fd);
+
+                if (error != 0)
+                    contents.clear();
+
+                return error;
+            }
+
+            // see writeBatch()
+            int writeFile(const BatchWriteRequest& request) {
+                const auto target = resolveTarget(request.path);
+                const auto temporary = temporaryPath(target);
+
+                const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, newFileMode);
+
+                if (fd < 0)
+                    return errno;
+
+                const auto& contents = request.contents;
+
+                size_t done = 0;
+                int error = 0;
+
+                while (done < contents.size()) {
+                    const auto result = write(fd, contents.data() + done, contents.size() - done);
+
+                    if (result < 0) {
+                        if (errno == EINTR)
+                            continue;
+
+                        error = errno;
+                        break;
+                    }
+
+                    done += result;
+                }
+
+                if (error == 0 && fsync(fd) != 0)
+                    error = errno;
+
+                if (close(fd) != 0 && error == 0)
+                    error = errno;
+
+                return replaceFile(temporary, target, error);
+            }
+
+            template<typename Request, typename BatchFunction, typename FileFunction>
+            void processRequests(std::vector<Request>& requests, BatchIOBackend backend, BatchFunction batchFunction,
+                                 FileFunction fileFunction) {
+                size_t done = 0;
+
+                if (backend != BatchIOBackend::Threads && ioUringAvailable()) {
+                    IoUring ring(ringEntries);
+
+                    while (ring.isValid() && done < requests.size()) {
+                        // the open stage of reads needs two entries per file
+                        const auto count = std::min<size_t>(ring.capacity() / 2, requests.size() - done);
+
+                        if (!batchFunction(ring, requests, done, count))
+                            break;
+
+                        done += count;
+                    }
+                }
+
+                // handles everything io_uring could not process
+                parallelFor(requests.size() - done, ioThreadCount(), [&](size_t i) {
+                    auto& request = requests[done + i];
+                    request.error = fileFunction(request);
+                });
+            }
+        }
+
+        bool ioUringAvailable() {
+            static const bool available = []() {
+                IoUring ring(1);
+                return ring.isValid() && ring.supports({
+                    IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC,
+                    IORING_OP_CLOSE
+                });
+            }();
+
+            return available;
+        }
+
+        void readFiles(std::vector<BatchReadRequest>& requests, BatchIOBackend backend) {
+            for (auto& request : requests) {
+                request.contents.clear();
+                request.error = 0;
+            }
+
+            processRequests(requests, backend, readBatch, readFile);
+        }
+
+        void writeFiles(std::vector<BatchWriteRequest>& requests, BatchIOBackend backend) {
+            for (auto& request : requests)
+                request.error = 0;
+
+            processRequests(requests, backend, writeBatch, writeFile);
+        }
+    }
+}
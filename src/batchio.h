@@ -0,0 +1,78 @@
+#pragma once
+
+// system headers
+#include <string>
+#include <vector>
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /**
+         * Request to read a whole file.
+         */
+        class BatchReadRequest {
+        public:
+            std::string path;
+
+            // contents of the file, set if error is 0
+            std::string contents;
+
+            // errno value describing why the file could not be read, 0 on success
+            int error = 0;
+
+        public:
+            BatchReadRequest() = default;
+            explicit BatchReadRequest(std::string path) : path(std::move(path)) {}
+        };
+
+        /**
+         * Request to replace a file's contents, creating the file if necessary.
+         *
+         * The contents are written to a temporary file in the same directory, which is renamed to the path once all the
+         * data is on disk. Therefore, the file is either replaced completely or not at all. Symlinks are followed, and
+         * existing files keep their permissions.
+         */
+        class BatchWriteRequest {
+        public:
+            std::string path;
+            std::string contents;
+
+            // errno value describing why the file could not be written, 0 on success
+            int error = 0;
+
+        public:
+            BatchWriteRequest() = default;
+            BatchWriteRequest(std::string path, std::string contents) :
+                path(std::move(path)), contents(std::move(contents)) {}
+        };
+
+        /**
+         * Implementations of the batched I/O functions.
+         */
+        enum class BatchIOBackend {
+            // io_uring if available, threads otherwise
+            Automatic,
+
+            // io_uring, submitting every stage (open, read or write, close) of up to a few hundred files with a single
+            // system call
+            IoUring,
+
+            // plain system calls, distributed among a couple of threads
+            Threads,
+        };
+
+        // returns true if the kernel supports io_uring and all the operations needed, and io_uring isn't blocked by,
+        // e.g., a seccomp filter
+        // the result is determined once and cached
+        bool ioUringAvailable();
+
+        // read all the files in a batch
+        // requesting io_uring while it is not available falls back to threads
+        // errors are reported per request, the function itself does not throw
+        void readFiles(std::vector<BatchReadRequest>& requests, BatchIOBackend backend = BatchIOBackend::Automatic);
+
+        // write all the files in a batch
+        // requesting io_uring while it is not available falls back to threads
+        // errors are reported per request, the function itself does not throw
+        void writeFiles(std::vector<BatchWriteRequest>& requests, BatchIOBackend backend = BatchIOBackend::Automatic);
+    }
+}
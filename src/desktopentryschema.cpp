@@ -0,0 +1,100 @@
+// system headers
+#include <string_view>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopentryschema.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            const DesktopFileEntry* find(const DesktopFile::section_t& section, std::string_view key) {
+                const auto it = section.find(key);
+                return it == section.end() ? nullptr : &it->second;
+            }
+
+            std::optional<bool> convertBoolean(const DesktopFile::section_t& section, std::string_view key) {
+                const auto* entry = find(section, key);
+
+                if (entry != nullptr) {
+                    if (entry->value() == "true")
+                        return true;
+
+                    if (entry->value() == "false")
+                        return false;
+                }
+
+                return std::nullopt;
+            }
+
+            // same semantics as DesktopFileEntry::parseStringList(), but without copying the items
+            DesktopEntrySchema::list_t convertList(const DesktopFile::section_t& section, std::string_view key) {
+                DesktopEntrySchema::list_t list;
+
+                const auto* entry = find(section, key);
+                if (entry == nullptr)
+                    return list;
+
+                std::string_view value = entry->value();
+
+                while (!value.empty()) {
+                    const auto separatorPos = value.find(';');
+                    const auto item = value.substr(0, separatorPos);
+
+                    if (!item.empty())
+                        list.emplace_back(item);
+
+                    if (separatorPos == std::string_view::npos)
+                        break;
+
+                    value.remove_prefix(separatorPos + 1);
+                }
+
+                return list;
+            }
+
+            DesktopEntrySchema::Type convertType(const DesktopFile::section_t& section) {
+                const auto* entry = find(section, "Type");
+
+                if (entry == nullptr)
+                    return DesktopEntrySchema::Type::Missing;
+
+                const auto& value = entry->value();
+
+                if (value == "Application")
+                    return DesktopEntrySchema::Type::Application;
+
+                if (value == "Link")
+                    return DesktopEntrySchema::Type::Link;
+
+                if (value == "Directory")
+                    return DesktopEntrySchema::Type::Directory;
+
+                return DesktopEntrySchema::Type::Unknown;
+            }
+        }
+
+        DesktopEntrySchema DesktopEntrySchema::fromSection(const DesktopFile::section_t& section) {
+            DesktopEntrySchema schema;
+
+            schema.type = convertType(section);
+
+            schema.noDisplay = convertBoolean(section, "NoDisplay");
+            schema.hidden = convertBoolean(section, "Hidden");
+            schema.dbusActivatable = convertBoolean(section, "DBusActivatable");
+            schema.terminal = convertBoolean(section, "Terminal");
+            schema.startupNotify = convertBoolean(section, "StartupNotify");
+            schema.prefersNonDefaultGPU = convertBoolean(section, "PrefersNonDefaultGPU");
+            schema.singleMainWindow = convertBoolean(section, "SingleMainWindow");
+
+            schema.onlyShowIn = convertList(section, "OnlyShowIn");
+            schema.notShowIn = convertList(section, "NotShowIn");
+            schema.actions = convertList(section, "Actions");
+            schema.mimeType = convertList(section, "MimeType");
+            schema.categories = convertList(section, "Categories");
+            schema.implements = convertList(section, "Implements");
+            schema.keywords = convertList(section, "Keywords");
+
+            return schema;
+        }
+    }
+}
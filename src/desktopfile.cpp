@@ -5,60 +5,59 @@
 // local headers
 #include "linuxdeploy/desktopfile/exceptions.h"
 #include "linuxdeploy/desktopfile/desktopfile.h"
+#include "linuxdeploy/desktopfile/frozendesktopfile.h"
+#include "desktopfileprivatedata.h"
 #include "desktopfilereader.h"
 #include "desktopfilewriter.h"
+#include "memoryusageutil.h"
 
 namespace linuxdeploy {
     namespace desktopfile {
-        class DesktopFile::PrivateData {
-            public:
-                std::string path;
-                sections_t data;
+        DesktopFile::DesktopFile() : DesktopFile(std::pmr::get_default_resource()) {}
 
-            public:
-                PrivateData() = default;
+        DesktopFile::DesktopFile(std::pmr::memory_resource* resource) : d(PrivateData::create(resource)) {}
 
-                void copyData(const std::shared_ptr<PrivateData>& other) {
-                    path = other->path;
-                    data = other->data;
-                }
-
-        public:
-            bool isEmpty() const {
-                return data.empty();
-            }
-        };
+        DesktopFile::DesktopFile(const std::string& path) : DesktopFile(path, std::pmr::get_default_resource()) {}
 
-        DesktopFile::DesktopFile() : d(std::make_shared<PrivateData>()) {}
-
-        DesktopFile::DesktopFile(const std::string& path) : DesktopFile() {
+        DesktopFile::DesktopFile(const std::string& path, std::pmr::memory_resource* resource) : DesktopFile(resource) {
             // if the file doesn't exist, an exception shall be thrown
             // otherwise, a user cannot know for sure whether a file was actually read (would need to check this
             // manually beforehand
-            {
-                std::ifstream ifs(path);
-                if (!ifs) {
-                    throw IOError("Could not find file " + path);
-                }
-            }
-
-            // will throw exceptions in case of issues
+            // DesktopFileReader throws an IOError if it cannot open the file, which saves opening the file twice
             read(path);
         };
 
-        DesktopFile::DesktopFile(std::istream& is) : DesktopFile() {
+        DesktopFile::DesktopFile(std::istream& is) : DesktopFile(is, std::pmr::get_default_resource()) {}
+
+        DesktopFile::DesktopFile(std::istream& is, std::pmr::memory_resource* resource) : DesktopFile(resource) {
             // will throw exceptions in case of issues
             read(is);
         };
 
+        DesktopFile::DesktopFile(const char* data, size_t size) :
+            DesktopFile(data, size, std::pmr::get_default_resource()) {}
+
+        DesktopFile::DesktopFile(const char* data, size_t size, std::pmr::memory_resource* resource) :
+            DesktopFile(resource) {
+            // will throw exceptions in case of issues
+            read(data, size);
+        }
+
         // copy constructor
         DesktopFile::DesktopFile(const DesktopFile& other) : DesktopFile() {
             d->copyData(other.d);
         }
 
+        // move constructor
+        DesktopFile::DesktopFile(DesktopFile&& other) noexcept : d(std::move(other.d)) {}
+
         // copy assignment constructor
         DesktopFile& DesktopFile::operator=(const DesktopFile& other) {
             if (this != &other) {
+                // moved-from files don't have any data
+                if (d == nullptr)
+                    d = PrivateData::create(std::pmr::get_default_resource());
+
                 d->copyData(other.d);
             }
 
@@ -80,16 +79,39 @@ namespace linuxdeploy {
             // clear data before reading a new file
             clear();
 
-            DesktopFileReader reader(path);
-            d->data = std::move(reader.data());
+            DesktopFileReader reader(path, memoryResource());
+            d->data = reader.takeData();
+            d->rehash();
         }
 
         void DesktopFile::read(std::istream& is) {
             // clear data before reading a new file
             clear();
 
-            DesktopFileReader reader(is);
-            d->data = reader.data();
+            DesktopFileReader reader(is, memoryResource());
+            d->data = reader.takeData();
+            d->rehash();
+        }
+
+        void DesktopFile::read(const char* data, size_t size) {
+            // clear data before reading a new file
+            clear();
+
+            DesktopFileReader reader(data, size, memoryResource());
+            d->data = reader.takeData();
+            d->rehash();
+        }
+
+        void DesktopFile::readParallel(const char* data, size_t size, size_t threads) {
+            clear();
+
+            DesktopFileReader reader(data, size, threads, memoryResource());
+            d->data = reader.takeData();
+            d->rehash();
+        }
+
+        std::pmr::memory_resource* DesktopFile::memoryResource() const {
+            return d->data.get_allocator().resource();
         }
 
         std::string DesktopFile::path() const {
@@ -106,6 +128,8 @@ namespace linuxdeploy {
 
         void DesktopFile::clear() {
             d->data.clear();
+            d->contentHash = 0;
+            d->invalidateSchema();
         }
 
         bool DesktopFile::save() const {
@@ -113,50 +137,65 @@ namespace linuxdeploy {
         }
 
         bool DesktopFile::save(const std::string& path) const {
-            DesktopFileWriter writer(d->data);
+            auto writer = DesktopFileWriter::borrow(d->data);
             writer.save(path);
 
             return true;
         }
 
         bool DesktopFile::save(std::ostream& os) const {
-            DesktopFileWriter writer(d->data);
+            auto writer = DesktopFileWriter::borrow(d->data);
             writer.save(os);
 
             return true;
         }
 
-        bool DesktopFile::entryExists(const std::string& section, const std::string& key) const {
+        bool DesktopFile::entryExists(std::string_view section, std::string_view key) const {
+            return findEntry(section, key) != nullptr;
+        }
+
+        const DesktopFile::section_t* DesktopFile::findSection(std::string_view section) const {
             auto it = d->data.find(section);
             if (it == d->data.end())
-                return false;
+                return nullptr;
 
-            return (it->second.find(key) != it->second.end());
+            return &it->second;
         }
 
-        bool DesktopFile::setEntry(const std::string& section, const DesktopFileEntry& entry) {
-            // check if value exists -- used for return value
-            auto rv = entryExists(section, entry.key());
+        const DesktopFileEntry* DesktopFile::findEntry(std::string_view section, std::string_view key) const {
+            const auto* sectionData = findSection(section);
+            if (sectionData == nullptr)
+                return nullptr;
 
-            d->data[section][entry.key()] = entry;
+            auto it = sectionData->find(key);
+            if (it == sectionData->end())
+                return nullptr;
 
-            return rv;
+            return &it->second;
         }
 
-        bool DesktopFile::setEntry(const std::string& section, DesktopFileEntry&& entry) {
-            // check if value exists -- used for return value
-            auto rv = entryExists(section, entry.key());
+        const DesktopFile::sections_t& DesktopFile::sections() const {
+            return d->data;
+        }
 
-            d->data[section][entry.key()] = entry;
+        bool DesktopFile::setEntry(std::string_view section, const DesktopFileEntry& entry) {
+            return d->setEntry(section, entry);
+        }
 
-            return rv;
+        bool DesktopFile::setEntry(std::string_view section, DesktopFileEntry&& entry) {
+            return d->setEntry(section, std::move(entry));
         }
 
-        bool DesktopFile::getEntry(const std::string& section, const std::string& key, DesktopFileEntry& entry) const {
-            if (!entryExists(section, key))
+        bool DesktopFile::removeEntry(std::string_view section, std::string_view key) {
+            return d->removeEntry(section, key);
+        }
+
+        bool DesktopFile::getEntry(std::string_view section, std::string_view key, DesktopFileEntry& entry) const {
+            const auto* found = findEntry(section, key);
+            if (found == nullptr)
                 return false;
 
-            entry = d->data[section][key];
+            entry = *found;
 
             // make sure keys are equal
             assert(key == entry.key());
@@ -169,8 +208,71 @@ namespace linuxdeploy {
             return true;
         }
 
+        const DesktopEntrySchema& DesktopFile::schema() const {
+            return d->getSchema();
+        }
+
+        MemoryUsage DesktopFile::memoryUsage() const {
+            MemoryUsage usage;
+            usage.privateDataBytes = sizeof(PrivateData) + controlBlockBytes<std::pmr::polymorphic_allocator<PrivateData>>;
+            usage.stringBytes = heapBytes(d->path);
+            usage.containerBytes = hashTableBytes(d->data);
+
+            for (const auto& section : d->data) {
+                usage.stringBytes += heapBytes(section.first);
+                usage.containerBytes += hashTableBytes(section.second);
+
+                for (const auto& pair : section.second) {
+                    usage.stringBytes += heapBytes(pair.first);
+                    usage += pair.second.memoryUsage();
+                }
+            }
+
+            if (const auto* schema = d->schema.load(std::memory_order_acquire)) {
+                usage.privateDataBytes += sizeof(DesktopEntrySchema);
+
+                for (const auto* list : {&schema->onlyShowIn, &schema->notShowIn, &schema->actions, &schema->mimeType,
+                                         &schema->categories, &schema->implements, &schema->keywords})
+                    usage.containerBytes += list->capacity() * sizeof(std::string_view);
+            }
+
+            return usage;
+        }
+
+        void DesktopFile::compact() {
+            // copying strings allocates exactly as much memory as needed, and reserving the final size up front
+            // results in the smallest bucket arrays
+            sections_t compacted(d->data.get_allocator());
+            compacted.reserve(d->data.size());
+
+            for (const auto& oldSection : d->data) {
+                auto& section = compacted.try_emplace(oldSection.first).first->second;
+                section.reserve(oldSection.second.size());
+
+                for (const auto& pair : oldSection.second)
+                    section.try_emplace(pair.first, pair.first, pair.second.value());
+            }
+
+            // the cached schema refers to the old strings
+            d->invalidateSchema();
+            d->data = std::move(compacted);
+            d->path.shrink_to_fit();
+        }
+
+        uint64_t DesktopFile::contentHash() const {
+            return d->contentHash;
+        }
+
+        FrozenDesktopFile DesktopFile::freeze() const {
+            return FrozenDesktopFile(*this);
+        }
+
         bool operator==(const DesktopFile& first, const DesktopFile& second) {
-            return first.d->path == second.d->path && first.d->data == second.d->data;
+            // differing hashes allow for rejecting most unequal files without looking at the data
+            // the full comparison is only needed to rule out hash collisions
+            return first.d->path == second.d->path &&
+                   first.d->contentHash == second.d->contentHash &&
+                   first.d->data == second.d->data;
         }
 
         bool operator !=(const DesktopFile& first, const DesktopFile& second) {
@@ -0,0 +1,72 @@
+// system headers
+#include <cstring>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilebatch.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "batchio.h"
+#include "desktopfilewriter.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        std::vector<DesktopFileLoadResult> loadDesktopFiles(const std::vector<std::string>& paths) {
+            std::vector<BatchReadRequest> requests(paths.begin(), paths.end());
+            readFiles(requests);
+
+            std::vector<DesktopFileLoadResult> results(requests.size());
+
+            for (size_t i = 0; i < requests.size(); ++i) {
+                auto& request = requests[i];
+                auto& result = results[i];
+
+                result.path = std::move(request.path);
+
+                if (request.error != 0) {
+                    result.error = "could not read file " + result.path + ": " + std::strerror(request.error);
+                    continue;
+                }
+
+                try {
+                    auto file = std::make_shared<DesktopFile>(request.contents.data(), request.contents.size());
+                    file->setPath(result.path);
+                    result.file = std::move(file);
+                } catch (const DesktopFileError& e) {
+                    result.error = e.what();
+                }
+            }
+
+            return results;
+        }
+
+        std::map<std::string, std::string> saveDesktopFiles(const std::vector<DesktopFile>& files) {
+            std::vector<BatchWriteRequest> requests;
+            requests.reserve(files.size());
+
+            std::map<std::string, std::string> errors;
+
+            for (const auto& file : files) {
+                auto path = file.path();
+
+                if (path.empty()) {
+                    errors.emplace(path, "empty path is not permitted");
+                    continue;
+                }
+
+                // the files outlive the writer, therefore their data need not be copied
+                auto writer = DesktopFileWriter::borrow(file.sections());
+                requests.emplace_back(std::move(path), writer.toString());
+            }
+
+            writeFiles(requests);
+
+            for (const auto& request : requests) {
+                if (request.error != 0) {
+                    errors.emplace(request.path, "could not write file " + request.path + ": " +
+                                                 std::strerror(request.error));
+                }
+            }
+
+            return errors;
+        }
+    }
+}
@@ -0,0 +1,330 @@
+// system headers
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilecollection.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "batchio.h"
+#include "memoryusageutil.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            bool endsWith(const std::string& string, const std::string& suffix) {
+                return string.size() >= suffix.size() &&
+                       string.compare(string.size() - suffix.size(), suffix.size(), suffix) == 0;
+            }
+
+            class DirectoryCloser {
+            public:
+                void operator()(DIR* dir) const {
+                    closedir(dir);
+                }
+            };
+
+            // subdirectories which cannot be opened are skipped, only the root directory is required to be readable
+            void findDesktopFilesRecursively(const std::string& directory, std::vector<std::string>& paths,
+                                             bool isRoot) {
+                std::unique_ptr<DIR, DirectoryCloser> dir(opendir(directory.c_str()));
+
+                if (dir == nullptr) {
+                    if (isRoot)
+                        throw IOError("could not open directory: " + directory);
+
+                    return;
+                }
+
+                struct dirent* ent;
+                while ((ent = readdir(dir.get())) != nullptr) {
+                    const std::string name = ent->d_name;
+
+                    if (name == "." || name == "..")
+                        continue;
+
+                    const auto path = directory + "/" + name;
+
+                    // symlinks to directories are not followed to avoid running in circles
+                    struct stat linkStat{};
+                    if (lstat(path.c_str(), &linkStat) != 0)
+                        continue;
+
+                    if (S_ISDIR(linkStat.st_mode)) {
+                        findDesktopFilesRecursively(path, paths, false);
+                        continue;
+                    }
+
+                    // symlinked desktop files are pretty common, though
+                    struct stat fileStat{};
+                    if (stat(path.c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+                        continue;
+
+                    if (endsWith(name, ".desktop"))
+                        paths.emplace_back(path);
+                }
+            }
+        }
+
+        bool DesktopFileCollectionChanges::isEmpty() const {
+            return added.empty() && modified.empty() && removed.empty();
+        }
+
+        class DesktopFileCollection::PrivateData {
+        public:
+            std::string directory;
+
+            // protects snapshot and errors
+            // readers only hold the lock while copying the shared pointer
+            mutable std::mutex mutex;
+            snapshot_t snapshot;
+            errors_t errors;
+
+            // serializes updates, making sure no update gets lost when two of them run concurrently
+            std::mutex updateMutex;
+
+        public:
+            PrivateData() : snapshot(std::make_shared<files_t>()) {}
+
+            void copyData(const std::shared_ptr<PrivateData>& other) {
+                std::lock_guard<std::mutex> lock(other->mutex);
+
+                directory = other->directory;
+                snapshot = other->snapshot;
+                errors = other->errors;
+            }
+
+            snapshot_t currentSnapshot() const {
+                std::lock_guard<std::mutex> lock(mutex);
+                return snapshot;
+            }
+
+            void publish(snapshot_t newSnapshot, errors_t newErrors) {
+                std::lock_guard<std::mutex> lock(mutex);
+                snapshot = std::move(newSnapshot);
+                errors = std::move(newErrors);
+            }
+
+            bool isInDirectory(const std::string& path) const {
+                return !directory.empty() && path.size() > directory.size() + 1 &&
+                       path.compare(0, directory.size(), directory) == 0 && path[directory.size()] == '/';
+            }
+
+            // read the given files with batched I/O, which needs only a few system calls for hundreds of files
+            static std::vector<BatchReadRequest> readAll(const std::vector<std::string>& paths) {
+                std::vector<BatchReadRequest> requests(paths.begin(), paths.end());
+                readFiles(requests);
+                return requests;
+            }
+
+            // (re-)load a single file from the data read into files, and record the outcome in changes
+            // the previous state of the file is looked up in oldFiles
+            static void reloadFile(const BatchReadRequest& request, const files_t& oldFiles, files_t& files,
+                                   errors_t& errors, DesktopFileCollectionChanges& changes) {
+                const auto& path = request.path;
+
+                const auto oldIt = oldFiles.find(path);
+                const bool existedBefore = oldIt != oldFiles.end();
+
+                std::shared_ptr<DesktopFile> file;
+
+                errors.erase(path);
+
+                if (request.error != 0) {
+                    // a file which disappeared in the meantime is not an error, it has just been removed
+                    if (request.error != ENOENT && request.error != ENOTDIR)
+                        errors[path] = "could not read file " + path + ": " + std::strerror(request.error);
+                } else {
+                    try {
+                        file = std::make_shared<DesktopFile>(request.contents.data(), request.contents.size());
+                        file->setPath(path);
+                    } catch (const DesktopFileError& e) {
+                        errors[path] = e.what();
+                    }
+                }
+
+                if (file == nullptr) {
+                    if (existedBefore) {
+                        files.erase(path);
+                        changes.removed.emplace_back(path);
+                    }
+
+                    return;
+                }
+
+                if (!existedBefore) {
+                    changes.added.emplace_back(path);
+                } else if (*oldIt->second != *file) {
+                    changes.modified.emplace_back(path);
+                } else {
+                    // keep the existing instance, readers may compare the pointers to detect changes
+                    return;
+                }
+
+                files[path] = std::move(file);
+            }
+        };
+
+        DesktopFileCollection::DesktopFileCollection() : d(std::make_shared<PrivateData>()) {}
+
+        DesktopFileCollection::DesktopFileCollection(std::string directory) : DesktopFileCollection() {
+            // normalize path to make prefix checks in update() work reliably
+            while (directory.size() > 1 && directory.back() == '/')
+                directory.pop_back();
+
+            d->directory = std::move(directory);
+
+            // will throw exceptions in case of issues
+            load();
+        }
+
+        DesktopFileCollection::DesktopFileCollection(const DesktopFileCollection& other) : DesktopFileCollection() {
+            d->copyData(other.d);
+        }
+
+        DesktopFileCollection& DesktopFileCollection::operator=(const DesktopFileCollection& other) {
+            if (this != &other) {
+                // set up a new instance of PrivateData, and copy data over from other object
+                d = std::make_shared<PrivateData>();
+                d->copyData(other.d);
+            }
+
+            return *this;
+        }
+
+        DesktopFileCollection& DesktopFileCollection::operator=(DesktopFileCollection&& other) noexcept {
+            if (this != &other) {
+                // move other object's data into this one, and remove reference there
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        std::string DesktopFileCollection::directory() const {
+            return d->directory;
+        }
+
+        bool DesktopFileCollection::isEmpty() const {
+            return d->currentSnapshot()->empty();
+        }
+
+        DesktopFileCollection::snapshot_t DesktopFileCollection::snapshot() const {
+            return d->currentSnapshot();
+        }
+
+        DesktopFileCollection::errors_t DesktopFileCollection::errors() const {
+            std::lock_guard<std::mutex> lock(d->mutex);
+            return d->errors;
+        }
+
+        MemoryUsage DesktopFileCollection::memoryUsage() const {
+            MemoryUsage usage;
+            usage.privateDataBytes = sizeof(PrivateData) + controlBlockBytes<>;
+            usage.stringBytes = heapBytes(d->directory);
+
+            snapshot_t snapshot;
+
+            {
+                std::lock_guard<std::mutex> lock(d->mutex);
+                snapshot = d->snapshot;
+
+                usage.containerBytes += treeBytes(d->errors);
+
+                for (const auto& pair : d->errors)
+                    usage.stringBytes += heapBytes(pair.first) + heapBytes(pair.second);
+            }
+
+            // the files are immutable, therefore they can be inspected without holding the lock
+            usage.privateDataBytes += sizeof(files_t) + controlBlockBytes<>;
+            usage.containerBytes += treeBytes(*snapshot);
+
+            for (const auto& pair : *snapshot) {
+                usage.stringBytes += heapBytes(pair.first);
+                usage.privateDataBytes += sizeof(DesktopFile) + controlBlockBytes<>;
+                usage += pair.second->memoryUsage();
+            }
+
+            return usage;
+        }
+
+        DesktopFileCollectionChanges DesktopFileCollection::load() {
+            if (d->directory.empty())
+                throw IOError("collection has no directory to load files from");
+
+            std::lock_guard<std::mutex> updateLock(d->updateMutex);
+
+            const auto paths = findDesktopFiles(d->directory);
+
+            const auto oldFiles = d->currentSnapshot();
+
+            DesktopFileCollectionChanges changes;
+            auto files = std::make_shared<files_t>();
+            errors_t errors;
+
+            for (const auto& request : PrivateData::readAll(paths)) {
+                // unchanged files are taken over from the old snapshot by reloadFile, which only inserts new or
+                // modified files
+                auto oldIt = oldFiles->find(request.path);
+                if (oldIt != oldFiles->end())
+                    (*files)[request.path] = oldIt->second;
+
+                PrivateData::reloadFile(request, *oldFiles, *files, errors, changes);
+            }
+
+            for (const auto& pair : *oldFiles) {
+                if (!std::binary_search(paths.begin(), paths.end(), pair.first))
+                    changes.removed.emplace_back(pair.first);
+            }
+
+            d->publish(std::move(files), std::move(errors));
+
+            return changes;
+        }
+
+        DesktopFileCollectionChanges DesktopFileCollection::update(const std::vector<std::string>& paths) {
+            std::lock_guard<std::mutex> updateLock(d->updateMutex);
+
+            const auto oldFiles = d->currentSnapshot();
+
+            // the new snapshot starts off as a copy of the old one
+            // this copies shared pointers only, the unchanged files are neither re-read nor copied
+            auto files = std::make_shared<files_t>(*oldFiles);
+            auto errors = this->errors();
+
+            DesktopFileCollectionChanges changes;
+
+            // event bursts usually contain the same path multiple times, every file shall be read only once
+            auto uniquePaths = paths;
+            std::sort(uniquePaths.begin(), uniquePaths.end());
+            uniquePaths.erase(std::unique(uniquePaths.begin(), uniquePaths.end()), uniquePaths.end());
+
+            uniquePaths.erase(std::remove_if(uniquePaths.begin(), uniquePaths.end(), [this](const std::string& path) {
+                return !d->isInDirectory(path) || !endsWith(path, ".desktop");
+            }), uniquePaths.end());
+
+            for (const auto& request : PrivateData::readAll(uniquePaths))
+                PrivateData::reloadFile(request, *oldFiles, *files, errors, changes);
+
+            // avoid waking up readers if nothing changed
+            if (!changes.isEmpty())
+                d->publish(std::move(files), std::move(errors));
+            else
+                d->publish(oldFiles, std::move(errors));
+
+            return changes;
+        }
+
+        std::vector<std::string> DesktopFileCollection::findDesktopFiles(const std::string& directory) {
+            std::vector<std::string> paths;
+            findDesktopFilesRecursively(directory, paths, true);
+            std::sort(paths.begin(), paths.end());
+            return paths;
+        }
+    }
+}
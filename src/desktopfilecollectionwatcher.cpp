@@ -0,0 +1,239 @@
+// system headers
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <set>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilecollectionwatcher.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        class DesktopFileCollectionWatcher::PrivateData {
+        public:
+            // events which may change the set of desktop files or their contents
+            static constexpr uint32_t watchMask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM |
+                                                  IN_MOVED_TO | IN_ONLYDIR;
+
+            // limits the time events are coalesced to this many settle times
+            static constexpr int maxSettleIntervals = 10;
+
+            DesktopFileCollection& collection;
+            int settleTimeMs;
+            int fd;
+
+            // maps watch descriptors to the directories they watch
+            std::map<int, std::string> watches;
+
+        public:
+            PrivateData(DesktopFileCollection& collection, int settleTimeMs) : collection(collection),
+                                                                               settleTimeMs(settleTimeMs),
+                                                                               fd(-1) {}
+
+            ~PrivateData() {
+                if (fd >= 0)
+                    close(fd);
+            }
+
+            // set up watches for directory and all its subdirectories
+            // paths of all files found in newly watched directories are added to paths, as they might have been
+            // created before the watch has been set up
+            void addWatchesRecursively(const std::string& directory, std::set<std::string>* paths) {
+                const auto wd = inotify_add_watch(fd, directory.c_str(), watchMask);
+
+                // the directory might have been removed in the meantime
+                if (wd < 0)
+                    return;
+
+                watches[wd] = directory;
+
+                auto* dir = opendir(directory.c_str());
+
+                if (dir == nullptr)
+                    return;
+
+                struct dirent* ent;
+                while ((ent = readdir(dir)) != nullptr) {
+                    const std::string name = ent->d_name;
+
+                    if (name == "." || name == "..")
+                        continue;
+
+                    const auto path = directory + "/" + name;
+
+                    struct stat linkStat{};
+                    if (lstat(path.c_str(), &linkStat) != 0)
+                        continue;
+
+                    if (S_ISDIR(linkStat.st_mode))
+                        addWatchesRecursively(path, paths);
+                    else if (paths != nullptr)
+                        paths->insert(path);
+                }
+
+                closedir(dir);
+            }
+
+            // remove watches of a directory which is gone (or has been moved elsewhere), and mark all the files
+            // the collection knows in there as changed, which will remove them from the collection
+            void forgetDirectory(const std::string& directory, std::set<std::string>& paths) {
+                const auto prefix = directory + "/";
+
+                for (auto it = watches.begin(); it != watches.end();) {
+                    if (it->second == directory || it->second.compare(0, prefix.size(), prefix) == 0) {
+                        inotify_rm_watch(fd, it->first);
+                        it = watches.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+
+                for (const auto& pair : *collection.snapshot()) {
+                    if (pair.first.compare(0, prefix.size(), prefix) == 0)
+                        paths.insert(pair.first);
+                }
+            }
+
+            // wait until the inotify file descriptor becomes readable
+            // returns false if the timeout expired
+            bool waitForEvents(int timeoutMs) const {
+                pollfd pfd{};
+                pfd.fd = fd;
+                pfd.events = POLLIN;
+
+                while (true) {
+                    const auto rv = poll(&pfd, 1, timeoutMs);
+
+                    if (rv < 0) {
+                        if (errno == EINTR)
+                            continue;
+
+                        throw IOError(std::string("failed to poll inotify file descriptor: ") + strerror(errno));
+                    }
+
+                    return rv > 0;
+                }
+            }
+
+            // read all pending events, and collect the affected paths
+            // returns false if the kernel's event queue overflowed, which requires a full rescan
+            bool readEvents(std::set<std::string>& paths) {
+                // large enough for a couple of events with maximum name length
+                alignas(struct inotify_event) char buffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+
+                bool overflow = false;
+
+                while (true) {
+                    const auto length = read(fd, buffer, sizeof(buffer));
+
+                    if (length < 0) {
+                        if (errno == EINTR)
+                            continue;
+
+                        // non-blocking descriptor, all pending events have been read
+                        if (errno == EAGAIN)
+                            break;
+
+                        throw IOError(std::string("failed to read inotify events: ") + strerror(errno));
+                    }
+
+                    if (length == 0)
+                        break;
+
+                    for (char* ptr = buffer; ptr < buffer + length;) {
+                        const auto* event = reinterpret_cast<const struct inotify_event*>(ptr);
+                        ptr += sizeof(struct inotify_event) + event->len;
+
+                        if (event->mask & IN_Q_OVERFLOW) {
+                            overflow = true;
+                            continue;
+                        }
+
+                        if (event->mask & IN_IGNORED) {
+                            watches.erase(event->wd);
+                            continue;
+                        }
+
+                        const auto watchIt = watches.find(event->wd);
+
+                        if (watchIt == watches.end() || event->len == 0)
+                            continue;
+
+                        const auto path = watchIt->second + "/" + event->name;
+
+                        if (event->mask & IN_ISDIR) {
+                            if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                                addWatchesRecursively(path, &paths);
+                            else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                                forgetDirectory(path, paths);
+                        } else {
+                            paths.insert(path);
+                        }
+                    }
+                }
+
+                return !overflow;
+            }
+        };
+
+        DesktopFileCollectionWatcher::DesktopFileCollectionWatcher(DesktopFileCollection& collection, int settleTimeMs)
+            : d(std::make_shared<PrivateData>(collection, settleTimeMs)) {
+            if (collection.directory().empty())
+                throw IOError("cannot watch collection without directory");
+
+            d->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+            if (d->fd < 0)
+                throw IOError(std::string("failed to initialize inotify: ") + strerror(errno));
+
+            d->addWatchesRecursively(collection.directory(), nullptr);
+
+            if (d->watches.empty())
+                throw IOError("failed to watch directory: " + collection.directory());
+        }
+
+        int DesktopFileCollectionWatcher::fileDescriptor() const {
+            return d->fd;
+        }
+
+        DesktopFileCollectionChanges DesktopFileCollectionWatcher::processEvents(int timeoutMs) {
+            if (!d->waitForEvents(timeoutMs))
+                return {};
+
+            std::set<std::string> paths;
+            bool needsRescan = false;
+
+            // coalesce bursts of events: keep reading until the directory has settled down
+            // a steady stream of events must not delay the update forever, though
+            const auto deadline = std::chrono::steady_clock::now() +
+                                  std::chrono::milliseconds(d->settleTimeMs) * PrivateData::maxSettleIntervals;
+
+            while (true) {
+                if (!d->readEvents(paths))
+                    needsRescan = true;
+
+                const auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+
+                if (remainingMs <= 0 || !d->waitForEvents(std::min<int>(d->settleTimeMs, remainingMs)))
+                    break;
+            }
+
+            if (needsRescan) {
+                // we cannot know which events have been lost, therefore watches need to be refreshed, too
+                d->addWatchesRecursively(d->collection.directory(), nullptr);
+                return d->collection.load();
+            }
+
+            return d->collection.update(std::vector<std::string>(paths.begin(), paths.end()));
+        }
+    }
+}
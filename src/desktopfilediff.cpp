@@ -0,0 +1,201 @@
+// system headers
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilediff.h"
+#include "desktopfileprivatedata.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            // look up entry in section, returns nullptr if section is nullptr or does not contain the key
+            const DesktopFileEntry* findEntry(const DesktopFile::section_t* section, std::string_view key) {
+                if (section == nullptr)
+                    return nullptr;
+
+                auto it = section->find(key);
+
+                if (it == section->end())
+                    return nullptr;
+
+                return &it->second;
+            }
+
+            const DesktopFile::section_t* findSection(const DesktopFile::sections_t& data, std::string_view name) {
+                auto it = data.find(name);
+
+                if (it == data.end())
+                    return nullptr;
+
+                return &it->second;
+            }
+
+            bool entriesEqual(const DesktopFileEntry* first, const DesktopFileEntry* second) {
+                if (first == nullptr || second == nullptr)
+                    return first == second;
+
+                return first->value() == second->value();
+            }
+
+            DesktopFileEntry entryOrEmpty(const DesktopFileEntry* entry) {
+                if (entry == nullptr)
+                    return DesktopFileEntry();
+
+                return *entry;
+            }
+        }
+
+        bool DesktopFileSectionDiff::isEmpty() const {
+            return added.empty() && removed.empty() && changed.empty();
+        }
+
+        bool DesktopFileDiff::isEmpty() const {
+            return sections.empty() && addedSections.empty() && removedSections.empty();
+        }
+
+        bool DesktopFileMergeResult::hasConflicts() const {
+            return !conflicts.empty();
+        }
+
+        DesktopFileDiff diff(const DesktopFile& from, const DesktopFile& to) {
+            DesktopFileDiff rv;
+
+            const auto& oldData = from.d->data;
+            const auto& newData = to.d->data;
+
+            // equal hashes are no proof for equal contents, but unequal ones prove there are differences
+            if (from.d->contentHash == to.d->contentHash && oldData == newData)
+                return rv;
+
+            for (const auto& newSection : newData) {
+                const auto* oldSection = findSection(oldData, newSection.first);
+
+                DesktopFileSectionDiff sectionDiff;
+
+                if (oldSection == nullptr)
+                    rv.addedSections.emplace_back(newSection.first);
+
+                for (const auto& newPair : newSection.second) {
+                    const auto* oldEntry = findEntry(oldSection, newPair.first);
+
+                    if (oldEntry == nullptr) {
+                        sectionDiff.added.emplace_back(newPair.second);
+                    } else if (oldEntry->value() != newPair.second.value()) {
+                        sectionDiff.changed.emplace_back(*oldEntry, newPair.second);
+                    }
+                }
+
+                if (oldSection != nullptr) {
+                    for (const auto& oldPair : *oldSection) {
+                        if (newSection.second.find(oldPair.first) == newSection.second.end())
+                            sectionDiff.removed.emplace_back(oldPair.second);
+                    }
+                }
+
+                if (!sectionDiff.isEmpty())
+                    rv.sections.emplace(newSection.first, std::move(sectionDiff));
+            }
+
+            for (const auto& oldSection : oldData) {
+                if (newData.find(oldSection.first) != newData.end())
+                    continue;
+
+                rv.removedSections.emplace_back(oldSection.first);
+
+                DesktopFileSectionDiff sectionDiff;
+
+                for (const auto& oldPair : oldSection.second)
+                    sectionDiff.removed.emplace_back(oldPair.second);
+
+                if (!sectionDiff.isEmpty())
+                    rv.sections.emplace(oldSection.first, std::move(sectionDiff));
+            }
+
+            std::sort(rv.addedSections.begin(), rv.addedSections.end());
+            std::sort(rv.removedSections.begin(), rv.removedSections.end());
+
+            return rv;
+        }
+
+        DesktopFileMergeResult merge(const DesktopFile& base, const DesktopFile& ours, const DesktopFile& theirs) {
+            DesktopFileMergeResult rv;
+
+            const auto& baseData = base.d->data;
+            const auto& ourData = ours.d->data;
+            const auto& theirData = theirs.d->data;
+
+            auto& mergedData = rv.merged.d->data;
+            rv.merged.d->path = ours.d->path;
+
+            // every section is visited once, no matter in how many of the versions it appears
+            std::unordered_set<std::string_view> visitedSections;
+
+            auto mergeSection = [&](std::string_view sectionName) {
+                if (!visitedSections.insert(sectionName).second)
+                    return;
+
+                const auto* baseSection = findSection(baseData, sectionName);
+                const auto* ourSection = findSection(ourData, sectionName);
+                const auto* theirSection = findSection(theirData, sectionName);
+
+                DesktopFile::section_t mergedSection;
+                std::unordered_set<std::string_view> visitedKeys;
+
+                auto mergeKey = [&](std::string_view key) {
+                    if (!visitedKeys.insert(key).second)
+                        return;
+
+                    const auto* baseEntry = findEntry(baseSection, key);
+                    const auto* ourEntry = findEntry(ourSection, key);
+                    const auto* theirEntry = findEntry(theirSection, key);
+
+                    const DesktopFileEntry* result;
+
+                    if (entriesEqual(ourEntry, theirEntry) || entriesEqual(baseEntry, theirEntry)) {
+                        // both made the same change, or only we changed the entry
+                        result = ourEntry;
+                    } else if (entriesEqual(baseEntry, ourEntry)) {
+                        // only they changed the entry
+                        result = theirEntry;
+                    } else {
+                        rv.conflicts.emplace_back(DesktopFileMergeConflict{
+                            std::string(sectionName), std::string(key), entryOrEmpty(baseEntry),
+                            entryOrEmpty(ourEntry), entryOrEmpty(theirEntry)
+                        });
+                        result = ourEntry;
+                    }
+
+                    if (result != nullptr)
+                        mergedSection.emplace(key, *result);
+                };
+
+                for (const auto* section : {ourSection, theirSection, baseSection}) {
+                    if (section == nullptr)
+                        continue;
+
+                    for (const auto& pair : *section)
+                        mergeKey(pair.first);
+                }
+
+                // the same rules apply to the sections themselves, which matters for empty sections and for
+                // sections removed in one of the versions
+                const bool sectionKept = (ourSection != nullptr && theirSection != nullptr) ||
+                                         (baseSection == nullptr && (ourSection != nullptr || theirSection != nullptr));
+
+                if (sectionKept || !mergedSection.empty())
+                    mergedData.emplace(sectionName, std::move(mergedSection));
+            };
+
+            for (const auto* data : {&ourData, &theirData, &baseData}) {
+                for (const auto& section : *data)
+                    mergeSection(section.first);
+            }
+
+            rv.merged.d->rehash();
+
+            return rv;
+        }
+    }
+}
@@ -3,16 +3,28 @@
 
 // local headers
 #include "linuxdeploy/desktopfile/desktopfileentry.h"
+#include "memoryusageutil.h"
 #include "util.h"
 
 namespace linuxdeploy {
     namespace desktopfile {
         class DesktopFileEntry::PrivateData {
         public:
-            std::string key;
-            std::string value;
+            std::pmr::string key;
+            std::pmr::string value;
+
+            // resource this instance has been allocated from
+            std::pmr::memory_resource* resource;
 
         public:
+            explicit PrivateData(std::pmr::memory_resource* resource) : key(resource), value(resource),
+                                                                        resource(resource) {}
+
+            // allocates the data and the shared pointer's control block in a single allocation
+            static std::shared_ptr<PrivateData> create(std::pmr::memory_resource* resource) {
+                return std::allocate_shared<PrivateData>(std::pmr::polymorphic_allocator<PrivateData>(resource), resource);
+            }
+
             void copyData(const std::shared_ptr<PrivateData>& other) {
                 key = other->key;
                 value = other->value;
@@ -24,21 +36,42 @@ namespace linuxdeploy {
             }
         };
 
-        DesktopFileEntry::DesktopFileEntry() : d(new PrivateData) {}
+        DesktopFileEntry::DesktopFileEntry() : DesktopFileEntry(allocator_type()) {}
+
+        DesktopFileEntry::DesktopFileEntry(const allocator_type& allocator) :
+            d(PrivateData::create(allocator.resource())) {}
 
-        DesktopFileEntry::DesktopFileEntry(std::string key, std::string value) : DesktopFileEntry() {
-            d->key = std::move(key);
-            d->value = std::move(value);
+        DesktopFileEntry::DesktopFileEntry(std::string_view key, std::string_view value) :
+            DesktopFileEntry(key, value, allocator_type()) {}
+
+        DesktopFileEntry::DesktopFileEntry(std::string_view key, std::string_view value,
+                                           const allocator_type& allocator) : DesktopFileEntry(allocator) {
+            d->key = key;
+            d->value = value;
         }
 
-        DesktopFileEntry::DesktopFileEntry(const DesktopFileEntry& other) : DesktopFileEntry() {
+        DesktopFileEntry::DesktopFileEntry(const DesktopFileEntry& other) : DesktopFileEntry(other, allocator_type()) {}
+
+        DesktopFileEntry::DesktopFileEntry(const DesktopFileEntry& other, const allocator_type& allocator) :
+            DesktopFileEntry(allocator) {
             d->copyData(other.d);
         }
 
+        DesktopFileEntry::DesktopFileEntry(DesktopFileEntry&& other, const allocator_type& allocator) {
+            // entries are never modified in place, therefore sharing the data is safe
+            if (other.d->resource->is_equal(*allocator.resource())) {
+                d = other.d;
+            } else {
+                d = PrivateData::create(allocator.resource());
+                d->copyData(other.d);
+            }
+        }
+
         DesktopFileEntry& DesktopFileEntry::operator=(const DesktopFileEntry& other) {
             if (this != &other) {
-                d.reset(new PrivateData);
-                d->copyData(other.d);
+                auto newData = PrivateData::create(d->resource);
+                newData->copyData(other.d);
+                d = std::move(newData);
             }
 
             return *this;
@@ -61,18 +94,29 @@ namespace linuxdeploy {
             return !operator==(other);
         }
 
+        DesktopFileEntry::allocator_type DesktopFileEntry::get_allocator() const {
+            return allocator_type(d->resource);
+        }
+
         bool DesktopFileEntry::isEmpty() const {
             return d->key.empty();
         }
 
-        const std::string& DesktopFileEntry::key() const {
+        const std::pmr::string& DesktopFileEntry::key() const {
             return d->key;
         }
 
-        const std::string& DesktopFileEntry::value() const {
+        const std::pmr::string& DesktopFileEntry::value() const {
             return d->value;
         }
 
+        MemoryUsage DesktopFileEntry::memoryUsage() const {
+            MemoryUsage usage;
+            usage.stringBytes = heapBytes(d->key) + heapBytes(d->value);
+            usage.privateDataBytes = sizeof(PrivateData) + controlBlockBytes<std::pmr::polymorphic_allocator<PrivateData>>;
+            return usage;
+        }
+
         int32_t DesktopFileEntry::asInt() const {
             d->assertValueNotEmpty();
 
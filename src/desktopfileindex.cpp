@@ -0,0 +1,307 @@
+// system headers
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfileindex.h"
+#include "util.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            const std::string indexedSection = "Desktop Entry";
+
+            const DesktopFileIndex::Field fields[] = {
+                DesktopFileIndex::Field::Categories,
+                DesktopFileIndex::Field::MimeType,
+                DesktopFileIndex::Field::Keywords,
+            };
+
+            const char* fieldKey(DesktopFileIndex::Field field) {
+                switch (field) {
+                    case DesktopFileIndex::Field::Categories:
+                        return "Categories";
+                    case DesktopFileIndex::Field::MimeType:
+                        return "MimeType";
+                    case DesktopFileIndex::Field::Keywords:
+                        return "Keywords";
+                }
+
+                return "";
+            }
+
+            std::string normalizeToken(DesktopFileIndex::Field field, std::string token) {
+                trim(token);
+
+                if (field != DesktopFileIndex::Field::Categories) {
+                    std::transform(token.begin(), token.end(), token.begin(), [](char c) {
+                        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+                    });
+                }
+
+                return token;
+            }
+        }
+
+        class DesktopFileIndex::PrivateData {
+        public:
+            // one token -> posting list map per field
+            std::unordered_map<std::string, postings_t> postings[sizeof(fields) / sizeof(fields[0])];
+
+            // indexed by file ID, an empty path marks an unused ID
+            std::vector<std::string> paths;
+            std::unordered_map<std::string, file_id_t> idsByPath;
+            std::vector<file_id_t> freeIds;
+
+            // tokens per file ID and field, needed to remove a file's postings without rescanning all lists
+            std::vector<std::vector<std::pair<Field, std::string>>> tokensById;
+
+        public:
+            void copyData(const std::shared_ptr<PrivateData>& other) {
+                for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+                    postings[i] = other->postings[i];
+
+                paths = other->paths;
+                idsByPath = other->idsByPath;
+                freeIds = other->freeIds;
+                tokensById = other->tokensById;
+            }
+
+            std::unordered_map<std::string, postings_t>& postingsFor(Field field) {
+                return postings[static_cast<size_t>(field)];
+            }
+
+            const std::unordered_map<std::string, postings_t>& postingsFor(Field field) const {
+                return postings[static_cast<size_t>(field)];
+            }
+
+            file_id_t allocateId(const std::string& path) {
+                file_id_t id;
+
+                if (!freeIds.empty()) {
+                    id = freeIds.back();
+                    freeIds.pop_back();
+                    paths[id] = path;
+                } else {
+                    id = static_cast<file_id_t>(paths.size());
+                    paths.emplace_back(path);
+                    tokensById.emplace_back();
+                }
+
+                idsByPath[path] = id;
+                return id;
+            }
+
+            void removePostings(file_id_t id) {
+                for (const auto& fieldAndToken : tokensById[id]) {
+                    auto& fieldPostings = postingsFor(fieldAndToken.first);
+
+                    auto it = fieldPostings.find(fieldAndToken.second);
+                    if (it == fieldPostings.end())
+                        continue;
+
+                    auto& list = it->second;
+                    auto pos = std::lower_bound(list.begin(), list.end(), id);
+
+                    if (pos != list.end() && *pos == id)
+                        list.erase(pos);
+
+                    // drop empty lists to keep the token maps small
+                    if (list.empty())
+                        fieldPostings.erase(it);
+                }
+
+                tokensById[id].clear();
+            }
+
+            void addPostings(file_id_t id, const DesktopFile& file) {
+                auto& tokens = tokensById[id];
+
+                for (const auto field : fields) {
+                    const auto* entry = file.findEntry(indexedSection, fieldKey(field));
+                    if (entry == nullptr)
+                        continue;
+
+                    for (auto& rawToken : entry->parseStringList()) {
+                        auto token = normalizeToken(field, std::move(rawToken));
+
+                        if (token.empty())
+                            continue;
+
+                        auto& list = postingsFor(field)[token];
+                        auto pos = std::lower_bound(list.begin(), list.end(), id);
+
+                        // lists may contain the same token more than once
+                        if (pos != list.end() && *pos == id)
+                            continue;
+
+                        list.insert(pos, id);
+                        tokens.emplace_back(field, std::move(token));
+                    }
+                }
+            }
+        };
+
+        DesktopFileIndex::DesktopFileIndex() : d(std::make_shared<PrivateData>()) {}
+
+        DesktopFileIndex::DesktopFileIndex(const DesktopFileCollection::files_t& files) : DesktopFileIndex() {
+            for (const auto& pair : files)
+                update(pair.first, *pair.second);
+        }
+
+        DesktopFileIndex::DesktopFileIndex(const DesktopFileIndex& other) : DesktopFileIndex() {
+            d->copyData(other.d);
+        }
+
+        DesktopFileIndex& DesktopFileIndex::operator=(const DesktopFileIndex& other) {
+            if (this != &other) {
+                // set up a new instance of PrivateData, and copy data over from other object
+                d = std::make_shared<PrivateData>();
+                d->copyData(other.d);
+            }
+
+            return *this;
+        }
+
+        DesktopFileIndex& DesktopFileIndex::operator=(DesktopFileIndex&& other) noexcept {
+            if (this != &other) {
+                // move other object's data into this one, and remove reference there
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        size_t DesktopFileIndex::size() const {
+            return d->idsByPath.size();
+        }
+
+        DesktopFileIndex::file_id_t DesktopFileIndex::update(const std::string& path, const DesktopFile& file) {
+            file_id_t id;
+
+            if (findId(path, id)) {
+                d->removePostings(id);
+            } else {
+                id = d->allocateId(path);
+            }
+
+            d->addPostings(id, file);
+
+            return id;
+        }
+
+        void DesktopFileIndex::update(const DesktopFileCollection::files_t& snapshot,
+                                      const DesktopFileCollectionChanges& changes) {
+            for (const auto& path : changes.removed)
+                remove(path);
+
+            for (const auto* paths : {&changes.added, &changes.modified}) {
+                for (const auto& path : *paths) {
+                    auto it = snapshot.find(path);
+
+                    if (it != snapshot.end())
+                        update(path, *it->second);
+                }
+            }
+        }
+
+        bool DesktopFileIndex::remove(const std::string& path) {
+            auto it = d->idsByPath.find(path);
+
+            if (it == d->idsByPath.end())
+                return false;
+
+            const auto id = it->second;
+
+            d->removePostings(id);
+            d->paths[id].clear();
+            d->freeIds.emplace_back(id);
+            d->idsByPath.erase(it);
+
+            return true;
+        }
+
+        bool DesktopFileIndex::findId(const std::string& path, file_id_t& id) const {
+            auto it = d->idsByPath.find(path);
+
+            if (it == d->idsByPath.end())
+                return false;
+
+            id = it->second;
+            return true;
+        }
+
+        const std::string& DesktopFileIndex::path(file_id_t id) const {
+            if (id >= d->paths.size() || d->paths[id].empty())
+                throw std::out_of_range("unknown file ID: " + std::to_string(id));
+
+            return d->paths[id];
+        }
+
+        const DesktopFileIndex::postings_t& DesktopFileIndex::find(Field field, const std::string& token) const {
+            static const postings_t emptyList;
+
+            const auto& fieldPostings = d->postingsFor(field);
+            auto it = fieldPostings.find(normalizeToken(field, token));
+
+            if (it == fieldPostings.end())
+                return emptyList;
+
+            return it->second;
+        }
+
+        DesktopFileIndex::postings_t DesktopFileIndex::findAll(Field field, const std::vector<std::string>& tokens) const {
+            if (tokens.empty())
+                return {};
+
+            std::vector<const postings_t*> lists;
+            lists.reserve(tokens.size());
+
+            for (const auto& token : tokens)
+                lists.emplace_back(&find(field, token));
+
+            // intersecting the shortest lists first keeps the intermediate results as small as possible
+            std::sort(lists.begin(), lists.end(), [](const postings_t* a, const postings_t* b) {
+                return a->size() < b->size();
+            });
+
+            postings_t result = *lists.front();
+
+            for (auto it = lists.begin() + 1; it != lists.end() && !result.empty(); ++it)
+                result = intersect(result, **it);
+
+            return result;
+        }
+
+        DesktopFileIndex::postings_t DesktopFileIndex::findAny(Field field, const std::vector<std::string>& tokens) const {
+            postings_t result;
+
+            for (const auto& token : tokens)
+                result = unite(result, find(field, token));
+
+            return result;
+        }
+
+        DesktopFileIndex::postings_t DesktopFileIndex::intersect(const postings_t& first, const postings_t& second) {
+            postings_t result;
+            result.reserve(std::min(first.size(), second.size()));
+
+            std::set_intersection(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(result));
+
+            return result;
+        }
+
+        DesktopFileIndex::postings_t DesktopFileIndex::unite(const postings_t& first, const postings_t& second) {
+            postings_t result;
+            result.reserve(first.size() + second.size());
+
+            std::set_union(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(result));
+
+            return result;
+        }
+    }
+}
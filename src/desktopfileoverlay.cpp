@@ -0,0 +1,199 @@
+// system headers
+#include <cstdlib>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopentryschema.h"
+#include "linuxdeploy/desktopfile/desktopfilebatch.h"
+#include "linuxdeploy/desktopfile/desktopfilecollection.h"
+#include "linuxdeploy/desktopfile/desktopfileoverlay.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        class DesktopFileOverlay::PrivateData {
+        public:
+            std::vector<std::string> directories;
+
+            files_t files;
+            std::vector<std::string> hidden;
+            std::vector<std::string> shadowed;
+            errors_t errors;
+
+        public:
+            void copyData(const std::shared_ptr<PrivateData>& other) {
+                directories = other->directories;
+                files = other->files;
+                hidden = other->hidden;
+                shadowed = other->shadowed;
+                errors = other->errors;
+            }
+
+            void load() {
+                files_t newFiles;
+                std::vector<std::string> newHidden;
+                std::vector<std::string> newShadowed;
+                errors_t newErrors;
+
+                // index the IDs first, the first directory providing an ID wins
+                std::vector<std::string> winningPaths;
+                std::vector<std::string> winningIds;
+                std::unordered_set<std::string> seenIds;
+
+                for (const auto& directory : directories) {
+                    std::vector<std::string> paths;
+
+                    try {
+                        paths = DesktopFileCollection::findDesktopFiles(directory);
+                    } catch (const IOError&) {
+                        // directories which don't exist are common, e.g., /usr/local/share/applications
+                        continue;
+                    }
+
+                    for (auto& path : paths) {
+                        auto id = desktopFileId(directory, path);
+
+                        if (!seenIds.insert(id).second) {
+                            newShadowed.emplace_back(std::move(path));
+                            continue;
+                        }
+
+                        winningIds.emplace_back(std::move(id));
+                        winningPaths.emplace_back(std::move(path));
+                    }
+                }
+
+                // only the winners are read and parsed
+                auto results = loadDesktopFiles(winningPaths);
+
+                for (size_t i = 0; i < results.size(); ++i) {
+                    auto& result = results[i];
+
+                    if (result.file == nullptr) {
+                        newErrors.emplace(std::move(result.path), std::move(result.error));
+                        continue;
+                    }
+
+                    if (result.file->schema().hidden.value_or(false)) {
+                        newHidden.emplace_back(std::move(winningIds[i]));
+                        continue;
+                    }
+
+                    newFiles.emplace(std::move(winningIds[i]), std::move(result.file));
+                }
+
+                files = std::move(newFiles);
+                hidden = std::move(newHidden);
+                shadowed = std::move(newShadowed);
+                errors = std::move(newErrors);
+            }
+        };
+
+        DesktopFileOverlay::DesktopFileOverlay() : d(std::make_shared<PrivateData>()) {}
+
+        DesktopFileOverlay::DesktopFileOverlay(std::vector<std::string> directories) : DesktopFileOverlay() {
+            // trailing slashes would break calculating the IDs
+            for (auto& directory : directories) {
+                while (directory.size() > 1 && directory.back() == '/')
+                    directory.pop_back();
+            }
+
+            d->directories = std::move(directories);
+            load();
+        }
+
+        DesktopFileOverlay::DesktopFileOverlay(const DesktopFileOverlay& other) : DesktopFileOverlay() {
+            d->copyData(other.d);
+        }
+
+        DesktopFileOverlay& DesktopFileOverlay::operator=(const DesktopFileOverlay& other) {
+            if (this != &other) {
+                d = std::make_shared<PrivateData>();
+                d->copyData(other.d);
+            }
+
+            return *this;
+        }
+
+        DesktopFileOverlay& DesktopFileOverlay::operator=(DesktopFileOverlay&& other) noexcept {
+            if (this != &other) {
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        std::vector<std::string> DesktopFileOverlay::directories() const {
+            return d->directories;
+        }
+
+        const DesktopFileOverlay::files_t& DesktopFileOverlay::files() const {
+            return d->files;
+        }
+
+        std::shared_ptr<const DesktopFile> DesktopFileOverlay::find(std::string_view id) const {
+            const auto it = d->files.find(id);
+            return it == d->files.end() ? nullptr : it->second;
+        }
+
+        std::vector<std::string> DesktopFileOverlay::hidden() const {
+            return d->hidden;
+        }
+
+        std::vector<std::string> DesktopFileOverlay::shadowed() const {
+            return d->shadowed;
+        }
+
+        DesktopFileOverlay::errors_t DesktopFileOverlay::errors() const {
+            return d->errors;
+        }
+
+        void DesktopFileOverlay::load() {
+            d->load();
+        }
+
+        std::string DesktopFileOverlay::desktopFileId(const std::string& directory, const std::string& path) {
+            if (path.size() <= directory.size() + 1 || path.compare(0, directory.size(), directory) != 0 ||
+                path[directory.size()] != '/')
+                return "";
+
+            auto id = path.substr(directory.size() + 1);
+
+            for (auto& c : id) {
+                if (c == '/')
+                    c = '-';
+            }
+
+            return id;
+        }
+
+        std::vector<std::string> DesktopFileOverlay::defaultDirectories() {
+            std::vector<std::string> directories;
+
+            const auto* home = getenv("HOME");
+            const auto* dataHome = getenv("XDG_DATA_HOME");
+
+            if (dataHome != nullptr && dataHome[0] != '\0')
+                directories.emplace_back(std::string(dataHome) + "/applications");
+            else if (home != nullptr && home[0] != '\0')
+                directories.emplace_back(std::string(home) + "/.local/share/applications");
+
+            const auto* dataDirs = getenv("XDG_DATA_DIRS");
+            std::string dataDirsList = (dataDirs != nullptr && dataDirs[0] != '\0') ? dataDirs
+                                                                                  : "/usr/local/share:/usr/share";
+
+            std::stringstream ss(dataDirsList);
+            std::string directory;
+
+            while (std::getline(ss, directory, ':')) {
+                if (!directory.empty())
+                    directories.emplace_back(directory + "/applications");
+            }
+
+            return directories;
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+// system headers
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopentryschema.h"
+#include "linuxdeploy/desktopfile/desktopfile.h"
+#include "util.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        // shared with the other parts of the library which need to work on DesktopFile's internal storage directly
+        class DesktopFile::PrivateData {
+            public:
+                std::string path;
+                sections_t data;
+
+                // order-independent hash of data, kept up to date by all operations modifying data
+                // it is the (wrapping) sum of the hashes of all sections and entries, therefore single entries can be
+                // added or removed without having to look at the rest of the data
+                uint64_t contentHash = 0;
+
+                // typed values of the Desktop Entry section, converted on first use and discarded whenever the section
+                // might have changed
+                // const methods may be called concurrently, therefore threads race to install their copy, and the
+                // losers delete theirs
+                mutable std::atomic<const DesktopEntrySchema*> schema{nullptr};
+
+                static constexpr std::string_view schemaSection = "Desktop Entry";
+
+            public:
+                explicit PrivateData(std::pmr::memory_resource* resource) : data(resource) {}
+
+                ~PrivateData() {
+                    delete schema.load(std::memory_order_acquire);
+                }
+
+                // allocates the data and the shared pointer's control block from the resource in a single allocation
+                static std::shared_ptr<PrivateData> create(std::pmr::memory_resource* resource) {
+                    return std::allocate_shared<PrivateData>(std::pmr::polymorphic_allocator<PrivateData>(resource),
+                                                             resource);
+                }
+
+                void copyData(const std::shared_ptr<PrivateData>& other) {
+                    path = other->path;
+                    data = other->data;
+                    contentHash = other->contentHash;
+                    invalidateSchema();
+                }
+
+        public:
+            bool isEmpty() const {
+                return data.empty();
+            }
+
+            static uint64_t hashString(std::string_view string, uint64_t seed) {
+                // the length is included to make sure that moving characters between strings changes the hash
+                return fnv1a64(string.data(), string.size(), mix64(seed ^ string.size()));
+            }
+
+            // sections are hashed on their own as well, as empty sections are part of the data, too
+            static uint64_t sectionHash(std::string_view section) {
+                return mix64(hashString(section, 0));
+            }
+
+            static uint64_t entryHash(std::string_view section, std::string_view key, std::string_view value) {
+                return mix64(hashString(value, hashString(key, hashString(section, 1))));
+            }
+
+            const DesktopEntrySchema& getSchema() const {
+                const auto* current = schema.load(std::memory_order_acquire);
+
+                if (current != nullptr)
+                    return *current;
+
+                static const DesktopFile::section_t emptySection;
+                const auto sectionIt = data.find(schemaSection);
+                const auto* created = new DesktopEntrySchema(
+                    DesktopEntrySchema::fromSection(sectionIt == data.end() ? emptySection : sectionIt->second)
+                );
+
+                if (schema.compare_exchange_strong(current, created, std::memory_order_acq_rel))
+                    return *created;
+
+                delete created;
+                return *current;
+            }
+
+            // must be called by all non-const operations which might modify the Desktop Entry section
+            void invalidateSchema() {
+                delete schema.exchange(nullptr, std::memory_order_acq_rel);
+            }
+
+            // recalculate hash from scratch, needed after data has been replaced as a whole
+            // the schema is discarded as well
+            void rehash() {
+                invalidateSchema();
+                contentHash = 0;
+
+                for (const auto& section : data) {
+                    contentHash += sectionHash(section.first);
+
+                    for (const auto& pair : section.second)
+                        contentHash += entryHash(section.first, pair.first, pair.second.value());
+                }
+            }
+
+            // insert or replace entry, updating the hash incrementally
+            // returns true if an existing entry was overwritten, false otherwise
+            template<typename Entry>
+            bool setEntry(std::string_view sectionName, Entry&& entry) {
+                if (sectionName == schemaSection)
+                    invalidateSchema();
+
+                auto sectionIt = data.find(sectionName);
+
+                if (sectionIt == data.end()) {
+                    sectionIt = data.try_emplace(std::pmr::string(sectionName, data.get_allocator().resource())).first;
+                    contentHash += sectionHash(sectionName);
+                }
+
+                auto& section = sectionIt->second;
+                auto entryIt = section.find(entry.key());
+
+                if (entryIt != section.end()) {
+                    contentHash -= entryHash(sectionName, entryIt->first, entryIt->second.value());
+                    contentHash += entryHash(sectionName, entryIt->first, entry.value());
+                    entryIt->second = std::forward<Entry>(entry);
+                    return true;
+                }
+
+                contentHash += entryHash(sectionName, entry.key(), entry.value());
+                section.emplace(entry.key(), std::forward<Entry>(entry));
+                return false;
+            }
+
+            // remove entry, updating the hash incrementally
+            // returns true if the entry existed, false otherwise
+            bool removeEntry(std::string_view sectionName, std::string_view key) {
+                auto sectionIt = data.find(sectionName);
+                if (sectionIt == data.end())
+                    return false;
+
+                auto& section = sectionIt->second;
+                auto entryIt = section.find(key);
+                if (entryIt == section.end())
+                    return false;
+
+                if (sectionName == schemaSection)
+                    invalidateSchema();
+
+                contentHash -= entryHash(sectionName, entryIt->first, entryIt->second.value());
+                section.erase(entryIt);
+                return true;
+            }
+        };
+    }
+}
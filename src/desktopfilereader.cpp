@@ -1,23 +1,137 @@
 // system includes
+#include <algorithm>
+#include <exception>
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 // local headers
 #include "linuxdeploy/desktopfile/desktopfileentry.h"
 #include "linuxdeploy/desktopfile/exceptions.h"
 #include "desktopfilereader.h"
+#include "desktopfiletokenizer.h"
+#include "parallel.h"
+#include "statisticsutil.h"
 #include "util.h"
 
 namespace linuxdeploy {
     namespace desktopfile {
+        namespace {
+            // tokenizer handler which stores the sections and entries in a sections map
+            // if the format tolerates duplicate keys, later values replace earlier ones, like GLib's key file parser does
+            template<KeyFilePolicy Policy>
+            class SectionsBuilder {
+            private:
+                DesktopFile::sections_t& sections;
+                ParseStatistics& statistics;
+
+                // section the tokenizer is currently in
+                DesktopFile::section_t* currentSection = nullptr;
+
+            public:
+                SectionsBuilder(DesktopFile::sections_t& sections, ParseStatistics& statistics) :
+                    sections(sections), statistics(statistics) {}
+
+                void onSection(std::string_view name) {
+                    auto it = sections.find(name);
+
+                    if (it == sections.end()) {
+                        it = sections.try_emplace(std::pmr::string(name, sections.get_allocator().resource())).first;
+                        LD_DESKTOPFILE_STATS(statistics.allocations += 1 + stringAllocations(it->first));
+                    }
+
+                    currentSection = &it->second;
+                }
+
+                bool onEntry(std::string_view key, std::string_view value) {
+                    // the key and the entry are constructed in place, using the section's allocator
+                    const auto inserted = currentSection->try_emplace(
+                        std::pmr::string(key, currentSection->get_allocator().resource()), key, value
+                    );
+
+                    if constexpr (!Policy::rejectDuplicateKeys) {
+                        if (!inserted.second) {
+                            auto& entry = inserted.first->second;
+                            entry = DesktopFileEntry(key, value, currentSection->get_allocator());
+
+                            // entry data and its strings
+                            LD_DESKTOPFILE_STATS(statistics.allocations += 1 + stringAllocations(entry.key()) +
+                                                                           stringAllocations(entry.value()));
+                        }
+                    }
+
+                    LD_DESKTOPFILE_STATS(
+                        // map node, entry data, and the strings in both of them
+                        if (inserted.second) {
+                            const auto& entry = inserted.first->second;
+                            statistics.allocations += 2 + stringAllocations(inserted.first->first) +
+                                                      stringAllocations(entry.key()) + stringAllocations(entry.value());
+                        }
+                    );
+
+                    return inserted.second;
+                }
+            };
+
+            // part of a buffer parsed on its own by parseParallel()
+            class Chunk {
+            public:
+                std::string_view data;
+                DesktopFile::sections_t sections;
+                ParseStatistics statistics;
+                std::exception_ptr error;
+
+                Chunk(std::string_view data, std::pmr::memory_resource* resource) : data(data), sections(resource) {}
+            };
+
+            // chunks smaller than this are not worth the overhead of a thread
+            const size_t minimumChunkSize = 64 * 1024;
+
+            // split the buffer into about count chunks, all of which except for the first one begin with a section
+            // header
+            std::vector<std::string_view> splitAtSectionHeaders(std::string_view buffer, size_t count) {
+                std::vector<std::string_view> chunks;
+
+                const auto targetSize = std::max(buffer.size() / count, minimumChunkSize);
+                size_t begin = 0;
+
+                while (begin < buffer.size()) {
+                    size_t end = buffer.size();
+
+                    if (buffer.size() - begin > targetSize) {
+                        // lines beginning with [ are always section headers
+                        const auto headerPos = buffer.find("\n[", begin + targetSize - 1);
+
+                        if (headerPos != std::string_view::npos)
+                            end = headerPos + 1;
+                    }
+
+                    chunks.emplace_back(buffer.substr(begin, end - begin));
+                    begin = end;
+                }
+
+                return chunks;
+            }
+        }
+
         class DesktopFileReader::PrivateData {
         public:
             std::string path;
             DesktopFile::sections_t sections;
+            ParseStatistics statistics;
 
         public:
+            explicit PrivateData(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+                sections(resource) {}
+
+            // allocates the data and the shared pointer's control block from the resource in a single allocation
+            static std::shared_ptr<PrivateData> create(std::pmr::memory_resource* resource) {
+                return std::allocate_shared<PrivateData>(std::pmr::polymorphic_allocator<PrivateData>(resource),
+                                                         resource);
+            }
+
             bool isEmpty() {
                 return sections.empty();
             }
@@ -30,126 +144,101 @@ namespace linuxdeploy {
             void copyData(const std::shared_ptr<PrivateData>& other) {
                 path = other->path;
                 sections = other->sections;
+                statistics = other->statistics;
+            }
+
+            template<KeyFilePolicy Policy>
+            void parse(std::istream& is) {
+                SectionsBuilder<Policy> builder(sections, statistics);
+                BasicKeyFileTokenizer<Policy> tokenizer(statistics);
+                tokenizer.parse(is, builder);
+
+                LD_DESKTOPFILE_STATS(addToGlobalStatistics(statistics));
             }
 
-            void parse(std::istream& file) {
-                std::string line;
-                bool first = true;
+            template<KeyFilePolicy Policy>
+            void parse(const char* data, size_t size) {
+                SectionsBuilder<Policy> builder(sections, statistics);
+                BasicKeyFileTokenizer<Policy> tokenizer(statistics);
+                tokenizer.parse(data, size, builder);
 
-                std::string currentSectionName;
+                LD_DESKTOPFILE_STATS(addToGlobalStatistics(statistics));
+            }
 
-                while (std::getline(file, line)) {
-                    if (first) {
-                        first = false;
-                        // said to allow handling of UTF-16/32 documents, not entirely sure why
-                        if (line[0] == static_cast<std::string::value_type>(0xEF)) {
-                            line.erase(0, 3);
-                            return;
-                        }
+            // splits the buffer at section headers, parses the chunks concurrently, and merges the results in order
+            // the chunks' nodes are moved into the final maps without copying, which requires all threads to
+            // allocate from the same thread-safe resource, therefore other resources are parsed sequentially
+            template<KeyFilePolicy Policy>
+            void parseParallel(const char* data, size_t size, size_t threads) {
+                const std::string_view buffer(data, size);
+                auto* resource = sections.get_allocator().resource();
+
+                // a byte order mark stops the tokenizer, see DesktopFileTokenizer::parseLine()
+                const bool byteOrderMark = !buffer.empty() && buffer[0] == static_cast<char>(0xEF);
+
+                if (threads <= 1 || byteOrderMark || !resource->is_equal(*std::pmr::new_delete_resource())) {
+                    parse<Policy>(data, size);
+                    return;
+                }
+
+                std::vector<Chunk> chunks;
+
+                // a few chunks per thread make up for sections of different sizes
+                for (const auto& chunkData : splitAtSectionHeaders(buffer, threads * 4))
+                    chunks.emplace_back(chunkData, resource);
+
+                parallelFor(chunks.size(), threads, [&chunks](size_t i) {
+                    auto& chunk = chunks[i];
+
+                    // errors are rethrown while merging, so the first one in the file is reported
+                    try {
+                        SectionsBuilder<Policy> builder(chunk.sections, chunk.statistics);
+                        BasicKeyFileTokenizer<Policy> tokenizer(chunk.statistics);
+                        tokenizer.parse(chunk.data.data(), chunk.data.size(), builder);
+                    } catch (...) {
+                        chunk.error = std::current_exception();
                     }
+                });
+
+                for (auto& chunk : chunks) {
+                    if (chunk.error)
+                        std::rethrow_exception(chunk.error);
+
+                    statistics += chunk.statistics;
+                    merge<Policy>(chunk.sections);
+                }
+
+                LD_DESKTOPFILE_STATS(addToGlobalStatistics(statistics));
+            }
+
+            // move the nodes of other into sections
+            // sections may appear in several chunks, their keys must be unique across all of them unless the format
+            // tolerates duplicates, in which case the chunks are merged in order so the last value wins
+            template<KeyFilePolicy Policy>
+            void merge(DesktopFile::sections_t& other) {
+                while (!other.empty()) {
+                    auto sectionNode = other.extract(other.begin());
+                    const auto sectionIt = sections.find(sectionNode.key());
+
+                    if (sectionIt == sections.end()) {
+                        sections.insert(std::move(sectionNode));
+                        continue;
+                    }
+
+                    auto& section = sectionIt->second;
+                    auto& otherSection = sectionNode.mapped();
+
+                    while (!otherSection.empty()) {
+                        auto entryNode = otherSection.extract(otherSection.begin());
+                        const auto inserted = section.insert(std::move(entryNode));
+
+                        if (inserted.inserted)
+                            continue;
 
-                    if (!line.empty()) {
-                        auto len = line.length();
-                        if (len > 0 &&
-                            !((len >= 2 && (line[0] == '/' && line[1] == '/')) || (len >= 1 && line[0] == '#'))) {
-                            if (line[0] == '[') {
-                                if (line.find_last_of('[') != 0)
-                                    throw ParseError("Multiple opening [ brackets");
-
-                                // this line apparently introduces a new section
-                                auto closingBracketPos = line.find(']');
-                                auto lastClosingBracketPos = line.find_last_of(']');
-
-                                if (closingBracketPos == std::string::npos)
-                                    throw ParseError("No closing ] bracket in section header");
-                                else if (closingBracketPos != lastClosingBracketPos)
-                                    throw ParseError("Two or more closing ] brackets in section header");
-
-                                size_t length = len - 2;
-                                auto title = line.substr(1, closingBracketPos - 1);
-
-                                // set up the new section
-                                sections.insert(std::make_pair(title, DesktopFile::section_t()));
-                                currentSectionName = std::move(title);
-                            } else {
-                                // we require at least one section to be present in the desktop file
-                                if (currentSectionName.empty())
-                                    throw ParseError("No section in desktop file");
-
-                                auto delimiterPos = line.find('=');
-                                if (delimiterPos == std::string::npos)
-                                    throw ParseError("No = key/value delimiter found");
-
-                                // this line should be a normal key-value pair
-                                std::string key = line.substr(0, delimiterPos);
-                                std::string value = line.substr(delimiterPos + 1, line.size());
-
-                                // we can strip away any sort of leading or trailing whitespace safely
-                                trim(key);
-                                trim(value);
-
-                                // empty keys are not allowed for obvious reasons
-                                if (key.empty())
-                                    throw ParseError("Empty keys are not allowed");
-
-                                // check if the string is a potentially localized string
-                                // if yes, parse name and locale out, and check them for validity
-                                std::string entryName, entryLocale;
-
-                                auto openingBracketPos = key.find('[');
-                                if (openingBracketPos != std::string::npos) {
-                                    entryName = key.substr(0, key.find('['));
-                                    entryLocale = key.substr(openingBracketPos, key.size());
-                                } else {
-                                    entryName = key;
-                                }
-
-                                // name may only contain A-Za-z- characters according to specification
-                                for (const char c : entryName) {
-                                    if (!(
-                                            (c >= 'A' && c <= 'Z') ||
-                                            (c >= 'a' && c <= 'z') ||
-                                            (c >= '0' && c <= '9') ||
-                                            (c == '-')
-                                        )
-                                    ) {
-                                        throw ParseError("Key " + key + " contains invalid character " + std::string{c});
-                                    }
-                                }
-
-                                // validate locale part
-                                if (!entryLocale.empty()) {
-                                    static const auto errorPrefix = "Invalid localization syntax used in key " + key + ": ";
-
-                                    if (std::count(entryLocale.begin(), entryLocale.end(), '[') != 1 ||
-                                        std::count(entryLocale.begin(), entryLocale.end(), '[') != 1) {
-                                        throw ParseError(errorPrefix + "mismatching [] brackets");
-                                    }
-
-                                    // just for clarification: _this_ should never happen, given how the strings are
-                                    // split above
-                                    if (entryLocale.find('[') != 0) {
-                                        throw ParseError(errorPrefix + "invalid [ position");
-                                    }
-
-                                    if (entryLocale.find(']') != entryLocale.size()-1) {
-                                        throw ParseError(errorPrefix + "invalid ] position");
-                                    }
-
-                                    // the syntax within the brackets is not tested by intention, as some KDE apps
-                                    // use a locale called "x-test" for some reason
-                                    // strict validation of the locale part broke all AppImage builds on the KDE binary
-                                    // factory
-                                }
-
-                                auto& section = sections[currentSectionName];
-
-                                // keys must be unique in the same section
-                                if (section.find(key) != section.end())
-                                    throw ParseError("Key " + key + " found more than once");
-
-                                section[key] = DesktopFileEntry(key, value);
-                            }
+                        if constexpr (Policy::rejectDuplicateKeys) {
+                            throw ParseError("Key " + std::string(inserted.node.key()) + " found more than once");
+                        } else {
+                            inserted.position->second = std::move(inserted.node.mapped());
                         }
                     }
                 }
@@ -158,7 +247,15 @@ namespace linuxdeploy {
 
         DesktopFileReader::DesktopFileReader() : d(new PrivateData) {}
 
-        DesktopFileReader::DesktopFileReader(std::string path) : DesktopFileReader() {
+        DesktopFileReader::DesktopFileReader(std::string path) :
+            DesktopFileReader(std::move(path), std::pmr::get_default_resource()) {}
+
+        DesktopFileReader::DesktopFileReader(std::string path, std::pmr::memory_resource* resource) :
+            DesktopFileReader(std::move(path), DesktopEntryPolicy(), resource) {}
+
+        template<KeyFilePolicy Policy>
+        DesktopFileReader::DesktopFileReader(std::string path, Policy, std::pmr::memory_resource* resource) :
+            d(PrivateData::create(resource)) {
             d->path = std::move(path);
             d->assertPathIsNotEmpty();
 
@@ -166,13 +263,60 @@ namespace linuxdeploy {
             if (!ifs)
                 throw IOError("could not open file: " + d->path);
 
-            d->parse(ifs);
+            d->parse<Policy>(ifs);
         }
 
-        DesktopFileReader::DesktopFileReader(std::istream& is) : DesktopFileReader() {
-            d->parse(is);
+        DesktopFileReader::DesktopFileReader(std::istream& is) :
+            DesktopFileReader(is, std::pmr::get_default_resource()) {}
+
+        DesktopFileReader::DesktopFileReader(std::istream& is, std::pmr::memory_resource* resource) :
+            d(PrivateData::create(resource)) {
+            d->parse<DesktopEntryPolicy>(is);
         }
 
+        DesktopFileReader::DesktopFileReader(const char* data, size_t size) :
+            DesktopFileReader(data, size, std::pmr::get_default_resource()) {}
+
+        DesktopFileReader::DesktopFileReader(const char* data, size_t size, std::pmr::memory_resource* resource) :
+            DesktopFileReader(data, size, DesktopEntryPolicy(), resource) {}
+
+        template<KeyFilePolicy Policy>
+        DesktopFileReader::DesktopFileReader(const char* data, size_t size, Policy,
+                                             std::pmr::memory_resource* resource) :
+            d(PrivateData::create(resource)) {
+            d->parse<Policy>(data, size);
+        }
+
+        DesktopFileReader::DesktopFileReader(const char* data, size_t size, size_t threads,
+                                             std::pmr::memory_resource* resource) :
+            DesktopFileReader(data, size, DesktopEntryPolicy(), threads, resource) {}
+
+        template<KeyFilePolicy Policy>
+        DesktopFileReader::DesktopFileReader(const char* data, size_t size, Policy, size_t threads,
+                                             std::pmr::memory_resource* resource) :
+            d(PrivateData::create(resource)) {
+            d->parseParallel<Policy>(data, size, threads == 0 ? defaultThreadCount() : threads);
+        }
+
+        // the policy constructors are instantiated for the formats defined in keyfilepolicies.h
+        template DesktopFileReader::DesktopFileReader(std::string, DesktopEntryPolicy, std::pmr::memory_resource*);
+        template DesktopFileReader::DesktopFileReader(std::string, MimeAppsPolicy, std::pmr::memory_resource*);
+        template DesktopFileReader::DesktopFileReader(std::string, IconThemeIndexPolicy, std::pmr::memory_resource*);
+
+        template DesktopFileReader::DesktopFileReader(const char*, size_t, DesktopEntryPolicy,
+                                                      std::pmr::memory_resource*);
+        template DesktopFileReader::DesktopFileReader(const char*, size_t, MimeAppsPolicy,
+                                                      std::pmr::memory_resource*);
+        template DesktopFileReader::DesktopFileReader(const char*, size_t, IconThemeIndexPolicy,
+                                                      std::pmr::memory_resource*);
+
+        template DesktopFileReader::DesktopFileReader(const char*, size_t, DesktopEntryPolicy, size_t,
+                                                      std::pmr::memory_resource*);
+        template DesktopFileReader::DesktopFileReader(const char*, size_t, MimeAppsPolicy, size_t,
+                                                      std::pmr::memory_resource*);
+        template DesktopFileReader::DesktopFileReader(const char*, size_t, IconThemeIndexPolicy, size_t,
+                                                      std::pmr::memory_resource*);
+
         DesktopFileReader::DesktopFileReader(const DesktopFileReader& other) : DesktopFileReader() {
             d->copyData(other.d);
         }
@@ -213,19 +357,33 @@ namespace linuxdeploy {
             return d->path;
         }
 
+        const ParseStatistics& DesktopFileReader::statistics() const {
+            return d->statistics;
+        }
+
         DesktopFile::sections_t DesktopFileReader::data() const {
             return d->sections;
         }
 
-        DesktopFile::section_t DesktopFileReader::operator[](const std::string& name) const {
+        DesktopFile::sections_t DesktopFileReader::takeData() {
+            auto rv = std::move(d->sections);
+            d->sections.clear();
+            return rv;
+        }
+
+        const DesktopFile::section_t& DesktopFileReader::section(std::string_view name) const {
             auto it = d->sections.find(name);
 
             // the map would lazy-initialize a new entry in case the section doesn't exist
             // therefore explicitly checking whether the section exists, throwing an exception in case it does not
             if (it == d->sections.end())
-                throw UnknownSectionError(name);
+                throw UnknownSectionError(std::string(name));
 
             return it->second;
         }
+
+        DesktopFile::section_t DesktopFileReader::operator[](std::string_view name) const {
+            return section(name);
+        }
     }
 }
@@ -3,10 +3,14 @@
 // system includes
 #include <istream>
 #include <memory>
+#include <memory_resource>
+#include <string_view>
 
 // local includes
 #include "linuxdeploy/desktopfile/desktopfile.h"
 #include "linuxdeploy/desktopfile/desktopfileentry.h"
+#include "linuxdeploy/desktopfile/statistics.h"
+#include "linuxdeploy/desktopfile/keyfilepolicies.h"
 
 namespace linuxdeploy {
     namespace desktopfile {
@@ -24,9 +28,50 @@ namespace linuxdeploy {
             // construct from path
             explicit DesktopFileReader(std::string path);
 
+            // construct from path, allocating the parsed data from the given memory resource
+            DesktopFileReader(std::string path, std::pmr::memory_resource* resource);
+
+            // construct from path, parsing the file with the rules of another key file format, see keyfilepolicies.h
+            // the policy constructors are instantiated for the policies defined there
+            // if the format tolerates duplicate keys, the last value of every key is kept
+            template<KeyFilePolicy Policy>
+            DesktopFileReader(std::string path, Policy policy,
+                              std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
             // construct from existing istream
             explicit DesktopFileReader(std::istream& is);
 
+            // construct from existing istream, allocating the parsed data from the given memory resource
+            DesktopFileReader(std::istream& is, std::pmr::memory_resource* resource);
+
+            // construct from an in-memory buffer
+            // the buffer is tokenized in place, it does not need to be null-terminated
+            DesktopFileReader(const char* data, size_t size);
+
+            // construct from an in-memory buffer, allocating the parsed data from the given memory resource
+            DesktopFileReader(const char* data, size_t size, std::pmr::memory_resource* resource);
+
+            // construct from an in-memory buffer, parsing it with the rules of another key file format
+            template<KeyFilePolicy Policy>
+            DesktopFileReader(const char* data, size_t size, Policy policy,
+                              std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+            // construct from an in-memory buffer, parsing it on up to the given number of threads
+            // 0 threads selects the number of hardware threads
+            // the buffer is split at section headers, and the parts are parsed concurrently, which pays off for files
+            // with many sections and megabytes of text only; smaller buffers are parsed on the calling thread
+            // the data is parsed on the calling thread as well unless resource is std::pmr::new_delete_resource(), as
+            // other resources are usually not thread-safe
+            // the result is the same as with sequential parsing, but in case of multiple errors, another one than the
+            // first might be reported
+            DesktopFileReader(const char* data, size_t size, size_t threads, std::pmr::memory_resource* resource);
+
+            // construct from an in-memory buffer, parsing it with the rules of another key file format on up to the
+            // given number of threads, see above
+            template<KeyFilePolicy Policy>
+            DesktopFileReader(const char* data, size_t size, Policy policy, size_t threads,
+                              std::pmr::memory_resource* resource);
+
             // copy constructor
             DesktopFileReader(const DesktopFileReader& other);
 
@@ -49,13 +94,26 @@ namespace linuxdeploy {
             // returns desktop file path
             std::string path() const;
 
+            // returns the statistics collected while parsing
+            // all values are zero unless the library has been built with statistics support
+            const ParseStatistics& statistics() const;
+
             // get a specific section from the parsed data
             // throws std::range_error if section does not exist
-            DesktopFile::section_t operator[](const std::string& name) const;
+            DesktopFile::section_t operator[](std::string_view name) const;
+
+            // access a specific section from the parsed data without copying it
+            // the reference is valid as long as the reader exists
+            // throws UnknownSectionError if section does not exist
+            const DesktopFile::section_t& section(std::string_view name) const;
 
             // get copy of internal data storage
             // can be handed to a DesktopFileWriter instance, or to manually hack on the data
             DesktopFile::sections_t data() const;
+
+            // move the parsed data out of the reader, leaving the reader empty
+            // avoids copying the data when handing it over to a DesktopFile
+            DesktopFile::sections_t takeData();
         };
     }
 }
@@ -0,0 +1,352 @@
+// system headers
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilesearch.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            const std::string indexedSection = "Desktop Entry";
+
+            constexpr size_t fieldCount = 3;
+
+            const char* const fieldKeys[fieldCount] = {"Name", "GenericName", "Keywords"};
+
+            // three bytes packed into an integer
+            typedef uint32_t trigram_t;
+
+            bool isWordCharacter(char c) {
+                const auto uc = static_cast<unsigned char>(c);
+
+                // non-ASCII bytes are always considered part of a word, as we don't decode UTF-8 here
+                return uc >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            }
+
+            char toLower(char c) {
+                return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+            }
+
+            // calls callback for every trigram of every word in text
+            template<typename Callback>
+            void forEachTrigram(std::string_view text, Callback callback) {
+                // the padding makes sure word prefixes shorter than three characters form a trigram, too
+                std::string word = "  ";
+
+                auto flushWord = [&word, &callback]() {
+                    for (size_t i = 0; i + 2 < word.size(); ++i) {
+                        callback(
+                            static_cast<trigram_t>(static_cast<unsigned char>(word[i])) << 16 |
+                            static_cast<trigram_t>(static_cast<unsigned char>(word[i + 1])) << 8 |
+                            static_cast<trigram_t>(static_cast<unsigned char>(word[i + 2]))
+                        );
+                    }
+
+                    word.resize(2);
+                };
+
+                for (const char c : text) {
+                    if (isWordCharacter(c)) {
+                        word.push_back(toLower(c));
+                    } else {
+                        flushWord();
+                    }
+                }
+
+                flushWord();
+            }
+        }
+
+        class DesktopFileSearch::PrivateData {
+        public:
+            struct Posting {
+                uint32_t document;
+
+                // bit mask of the fields the trigram appears in
+                uint8_t fields;
+            };
+
+            struct Document {
+                std::string path;
+                std::string name;
+
+                // trigrams this document has postings for, needed to remove them again
+                std::vector<trigram_t> trigrams;
+            };
+
+        public:
+            std::vector<std::string> locales;
+            float weights[fieldCount] = {3.0f, 2.0f, 1.0f};
+            float minimumSimilarity = 0.5f;
+
+            // posting lists are sorted by document ID
+            std::unordered_map<trigram_t, std::vector<Posting>> postings;
+
+            // indexed by document ID, documents with an empty path are unused
+            std::vector<Document> documents;
+            std::unordered_map<std::string, uint32_t> idsByPath;
+            std::vector<uint32_t> freeIds;
+
+        public:
+            void copyData(const std::shared_ptr<PrivateData>& other) {
+                locales = other->locales;
+                std::copy(other->weights, other->weights + fieldCount, weights);
+                minimumSimilarity = other->minimumSimilarity;
+                postings = other->postings;
+                documents = other->documents;
+                idsByPath = other->idsByPath;
+                freeIds = other->freeIds;
+            }
+
+            static bool postingLess(const Posting& posting, uint32_t document) {
+                return posting.document < document;
+            }
+
+            void removePostings(uint32_t id) {
+                auto& document = documents[id];
+
+                for (const auto trigram : document.trigrams) {
+                    auto it = postings.find(trigram);
+                    if (it == postings.end())
+                        continue;
+
+                    auto& list = it->second;
+                    auto pos = std::lower_bound(list.begin(), list.end(), id, postingLess);
+
+                    if (pos != list.end() && pos->document == id)
+                        list.erase(pos);
+
+                    if (list.empty())
+                        postings.erase(it);
+                }
+
+                document.trigrams.clear();
+                document.name.clear();
+            }
+
+            void addPostings(uint32_t id, const DesktopFile& file) {
+                auto& document = documents[id];
+
+                // collect trigrams of all the indexed keys first, so that every trigram results in a single posting
+                std::unordered_map<trigram_t, uint8_t> fieldsByTrigram;
+
+                for (size_t field = 0; field < fieldCount; ++field) {
+                    auto addKey = [&](const std::string& key) {
+                        const auto* entry = file.findEntry(indexedSection, key);
+                        if (entry == nullptr)
+                            return false;
+
+                        forEachTrigram(entry->value(), [&fieldsByTrigram, field](trigram_t trigram) {
+                            fieldsByTrigram[trigram] |= static_cast<uint8_t>(1u << field);
+                        });
+
+                        // the first localized name found is the one to display
+                        if (field == 0 && document.name.empty())
+                            document.name = entry->value();
+
+                        return true;
+                    };
+
+                    for (const auto& locale : locales)
+                        addKey(std::string(fieldKeys[field]) + "[" + locale + "]");
+
+                    addKey(fieldKeys[field]);
+                }
+
+                document.trigrams.reserve(fieldsByTrigram.size());
+
+                for (const auto& pair : fieldsByTrigram) {
+                    auto& list = postings[pair.first];
+                    auto pos = std::lower_bound(list.begin(), list.end(), id, postingLess);
+                    list.insert(pos, Posting{id, pair.second});
+
+                    document.trigrams.emplace_back(pair.first);
+                }
+            }
+        };
+
+        DesktopFileSearch::DesktopFileSearch(std::vector<std::string> locales) : d(std::make_shared<PrivateData>()) {
+            d->locales = std::move(locales);
+        }
+
+        DesktopFileSearch::DesktopFileSearch(const DesktopFileCollection::files_t& files,
+                                             std::vector<std::string> locales) : DesktopFileSearch(std::move(locales)) {
+            for (const auto& pair : files)
+                update(pair.first, *pair.second);
+        }
+
+        DesktopFileSearch::DesktopFileSearch(const DesktopFileSearch& other) : DesktopFileSearch() {
+            d->copyData(other.d);
+        }
+
+        DesktopFileSearch& DesktopFileSearch::operator=(const DesktopFileSearch& other) {
+            if (this != &other) {
+                // set up a new instance of PrivateData, and copy data over from other object
+                d = std::make_shared<PrivateData>();
+                d->copyData(other.d);
+            }
+
+            return *this;
+        }
+
+        DesktopFileSearch& DesktopFileSearch::operator=(DesktopFileSearch&& other) noexcept {
+            if (this != &other) {
+                // move other object's data into this one, and remove reference there
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        size_t DesktopFileSearch::size() const {
+            return d->idsByPath.size();
+        }
+
+        void DesktopFileSearch::setFieldWeight(Field field, float weight) {
+            d->weights[static_cast<size_t>(field)] = weight;
+        }
+
+        float DesktopFileSearch::fieldWeight(Field field) const {
+            return d->weights[static_cast<size_t>(field)];
+        }
+
+        void DesktopFileSearch::setMinimumSimilarity(float similarity) {
+            d->minimumSimilarity = similarity;
+        }
+
+        void DesktopFileSearch::update(const std::string& path, const DesktopFile& file) {
+            uint32_t id;
+
+            auto it = d->idsByPath.find(path);
+
+            if (it != d->idsByPath.end()) {
+                id = it->second;
+                d->removePostings(id);
+            } else if (!d->freeIds.empty()) {
+                id = d->freeIds.back();
+                d->freeIds.pop_back();
+            } else {
+                id = static_cast<uint32_t>(d->documents.size());
+                d->documents.emplace_back();
+            }
+
+            d->documents[id].path = path;
+            d->idsByPath[path] = id;
+
+            d->addPostings(id, file);
+        }
+
+        void DesktopFileSearch::update(const DesktopFileCollection::files_t& snapshot,
+                                       const DesktopFileCollectionChanges& changes) {
+            for (const auto& path : changes.removed)
+                remove(path);
+
+            for (const auto* paths : {&changes.added, &changes.modified}) {
+                for (const auto& path : *paths) {
+                    auto it = snapshot.find(path);
+
+                    if (it != snapshot.end())
+                        update(path, *it->second);
+                }
+            }
+        }
+
+        bool DesktopFileSearch::remove(const std::string& path) {
+            auto it = d->idsByPath.find(path);
+
+            if (it == d->idsByPath.end())
+                return false;
+
+            const auto id = it->second;
+
+            d->removePostings(id);
+            d->documents[id].path.clear();
+            d->freeIds.emplace_back(id);
+            d->idsByPath.erase(it);
+
+            return true;
+        }
+
+        DesktopFileSearch::results_t DesktopFileSearch::search(const std::string& query, size_t limit) const {
+            std::vector<trigram_t> queryTrigrams;
+            forEachTrigram(query, [&queryTrigrams](trigram_t trigram) {
+                queryTrigrams.emplace_back(trigram);
+            });
+
+            std::sort(queryTrigrams.begin(), queryTrigrams.end());
+            queryTrigrams.erase(std::unique(queryTrigrams.begin(), queryTrigrams.end()), queryTrigrams.end());
+
+            if (queryTrigrams.empty() || limit == 0)
+                return {};
+
+            // a trigram found in multiple fields counts with the highest of their weights
+            float weightsByMask[1u << fieldCount] = {};
+            float maxWeight = 0.0f;
+
+            for (unsigned mask = 1; mask < (1u << fieldCount); ++mask) {
+                for (size_t field = 0; field < fieldCount; ++field) {
+                    if (mask & (1u << field))
+                        weightsByMask[mask] = std::max(weightsByMask[mask], d->weights[field]);
+                }
+
+                maxWeight = std::max(maxWeight, weightsByMask[mask]);
+            }
+
+            // dense accumulators avoid hashing in the inner loop
+            std::vector<float> scores(d->documents.size(), 0.0f);
+            std::vector<uint32_t> hits(d->documents.size(), 0);
+            std::vector<uint32_t> candidates;
+
+            for (const auto trigram : queryTrigrams) {
+                auto it = d->postings.find(trigram);
+                if (it == d->postings.end())
+                    continue;
+
+                for (const auto& posting : it->second) {
+                    if (hits[posting.document]++ == 0)
+                        candidates.emplace_back(posting.document);
+
+                    scores[posting.document] += weightsByMask[posting.fields];
+                }
+            }
+
+            const auto trigramCount = static_cast<float>(queryTrigrams.size());
+
+            std::vector<std::pair<float, uint32_t>> matches;
+
+            for (const auto id : candidates) {
+                if (static_cast<float>(hits[id]) / trigramCount < d->minimumSimilarity)
+                    continue;
+
+                const auto score = maxWeight > 0.0f ? scores[id] / (trigramCount * maxWeight) : 0.0f;
+                matches.emplace_back(score, id);
+            }
+
+            // sort by descending score, and by name to get stable results for equal scores
+            auto compare = [this](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+                if (a.first != b.first)
+                    return a.first > b.first;
+
+                return d->documents[a.second].name < d->documents[b.second].name;
+            };
+
+            const auto resultCount = std::min(limit, matches.size());
+            std::partial_sort(matches.begin(), matches.begin() + resultCount, matches.end(), compare);
+
+            results_t results;
+            results.reserve(resultCount);
+
+            for (size_t i = 0; i < resultCount; ++i) {
+                const auto& document = d->documents[matches[i].second];
+                results.emplace_back(DesktopFileSearchResult{document.path, document.name, matches[i].first});
+            }
+
+            return results;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+// system headers
+#include <string>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfiletemplate.h"
+#include "desktopfileprivatedata.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        DesktopFile DesktopFileTemplateBase::instantiate(const DesktopFileTemplateSection* sections,
+                                                         size_t sectionCount, const DesktopFileTemplateEntry* entries,
+                                                         std::pmr::memory_resource* resource) {
+            DesktopFile file(resource);
+
+            auto& data = file.d->data;
+            data.reserve(sectionCount);
+
+            for (size_t i = 0; i < sectionCount; ++i) {
+                const auto& sectionData = sections[i];
+                auto& section = data.try_emplace(std::pmr::string(sectionData.name, resource)).first->second;
+                section.reserve(sectionData.entryCount);
+
+                const auto* entry = entries + sectionData.firstEntry;
+                for (size_t j = 0; j < sectionData.entryCount; ++j, ++entry) {
+                    section.try_emplace(std::pmr::string(entry->key, resource), entry->key, entry->value);
+                }
+            }
+
+            file.d->rehash();
+
+            return file;
+        }
+    }
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+// system headers
+#include <istream>
+#include <string>
+#include <string_view>
+
+// local headers
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "linuxdeploy/desktopfile/statistics.h"
+#include "linuxdeploy/desktopfile/validation.h"
+#include "linuxdeploy/desktopfile/keyfilepolicies.h"
+#include "statisticsutil.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /**
+         * Splits key file contents into section headers and key-value pairs, and validates them.
+         *
+         * The rules which differ between the formats (desktop files, mimeapps.list, index.theme, ...) are defined by
+         * the Policy, see keyfilepolicies.h. They are evaluated at compile time, so every instantiation only contains
+         * the checks its format needs.
+         *
+         * The tokenizer does not store any data itself. It passes views of the sections and entries to a handler,
+         * which must provide the following methods:
+         *
+         *   // called for every section header, the same section may appear more than once
+         *   void onSection(std::string_view name);
+         *
+         *   // called for every key-value pair in the current section
+         *   // must return false if the key exists in the current section already, unless the policy tolerates
+         *   // duplicate keys
+         *   bool onEntry(std::string_view key, std::string_view value);
+         *
+         * When parsing streams, the views are only valid during the call. When parsing buffers, they point into the
+         * buffer, therefore handlers may keep them as long as the buffer exists.
+         *
+         * Throws ParseError in case of syntax errors.
+         */
+        template<KeyFilePolicy Policy>
+        class BasicKeyFileTokenizer {
+        private:
+            ParseStatistics& statistics;
+
+            // the time between two laps is attributed to the phase mentioned in the second lap
+            PhaseClock clock;
+
+            bool firstLine = true;
+            bool inSection = false;
+
+        public:
+            explicit BasicKeyFileTokenizer(ParseStatistics& statistics) : statistics(statistics) {}
+
+            template<typename Handler>
+            void parse(std::istream& is, Handler& handler) {
+                std::string line;
+
+                while (std::getline(is, line)) {
+                    clock.lap(statistics.ioNanoseconds);
+                    LD_DESKTOPFILE_STATS(statistics.bytesRead += line.size() + (is.eof() ? 0 : 1));
+
+                    if (!parseLine(line, handler))
+                        return;
+                }
+            }
+
+            // splits the buffer into lines the same way std::getline does
+            template<typename Handler>
+            void parse(const char* data, size_t size, Handler& handler) {
+                const std::string_view buffer(data, size);
+                size_t position = 0;
+
+                while (position < buffer.size()) {
+                    auto lineEnd = buffer.find('\n', position);
+                    const bool terminated = lineEnd != std::string_view::npos;
+
+                    if (!terminated)
+                        lineEnd = buffer.size();
+
+                    const auto line = buffer.substr(position, lineEnd - position);
+                    position = terminated ? lineEnd + 1 : lineEnd;
+
+                    clock.lap(statistics.ioNanoseconds);
+                    LD_DESKTOPFILE_STATS(statistics.bytesRead += line.size() + (terminated ? 1 : 0));
+
+                    if (!parseLine(line, handler))
+                        return;
+                }
+            }
+
+        private:
+            // returns false if parsing shall stop
+            template<typename Handler>
+            bool parseLine(std::string_view line, Handler& handler) {
+                LD_DESKTOPFILE_STATS(++statistics.lines);
+
+                if (firstLine) {
+                    firstLine = false;
+                    // said to allow handling of UTF-16/32 documents, not entirely sure why
+                    if (!line.empty() && line[0] == static_cast<char>(0xEF))
+                        return false;
+                }
+
+                if (line.empty())
+                    return true;
+
+                // comments
+                if (Policy::isComment(line))
+                    return true;
+
+                if (line[0] == '[') {
+                    parseSectionHeader(line, handler);
+                } else {
+                    parseEntry(line, handler);
+                }
+
+                return true;
+            }
+
+            template<typename Handler>
+            void parseSectionHeader(std::string_view line, Handler& handler) {
+                // this line apparently introduces a new section
+                std::string_view title;
+
+                switch (keyfilesyntax::parseSectionHeader(line, title)) {
+                    case keyfilesyntax::SectionHeaderError::None:
+                        break;
+                    case keyfilesyntax::SectionHeaderError::MultipleOpeningBrackets:
+                        throw ParseError("Multiple opening [ brackets");
+                    case keyfilesyntax::SectionHeaderError::NoClosingBracket:
+                        throw ParseError("No closing ] bracket in section header");
+                    case keyfilesyntax::SectionHeaderError::TwoOrMoreClosingBrackets:
+                        throw ParseError("Two or more closing ] brackets in section header");
+                }
+
+                clock.lap(statistics.tokenizeNanoseconds);
+
+                // keys following a header without a title are rejected like keys without any header
+                inSection = !title.empty();
+                handler.onSection(title);
+
+                LD_DESKTOPFILE_STATS(++statistics.sections);
+                clock.lap(statistics.insertionNanoseconds);
+            }
+
+            template<typename Handler>
+            void parseEntry(std::string_view line, Handler& handler) {
+                // we require at least one section to be present in the desktop file
+                if (!inSection)
+                    throw ParseError("No section in desktop file");
+
+                auto delimiterPos = line.find('=');
+                if (delimiterPos == std::string_view::npos)
+                    throw ParseError("No = key/value delimiter found");
+
+                // this line should be a normal key-value pair
+                // we can strip away any sort of leading or trailing whitespace safely
+                const auto key = keyfilesyntax::trim(line.substr(0, delimiterPos));
+                const auto value = keyfilesyntax::trim(line.substr(delimiterPos + 1));
+
+                // empty keys are not allowed for obvious reasons
+                if (key.empty())
+                    throw ParseError("Empty keys are not allowed");
+
+                // check if the string is a potentially localized string
+                // if yes, parse name and locale out, and check them for validity
+                std::string_view entryName, entryLocale;
+                keyfilesyntax::splitKey<Policy>(key, entryName, entryLocale);
+
+                clock.lap(statistics.tokenizeNanoseconds);
+
+                // name may only contain A-Za-z0-9- characters according to specification, other formats use other sets
+                const auto invalidCharacterPos = Policy::findInvalidKeyCharacter(entryName);
+                if (invalidCharacterPos != std::string_view::npos) {
+                    throw ParseError(std::string(Policy::keyNoun) + " " + std::string(key) +
+                                     " contains invalid character " + std::string{entryName[invalidCharacterPos]});
+                }
+
+                // validate locale part
+                if (!entryLocale.empty()) {
+                    auto localeError = [&key](const std::string& message) {
+                        return ParseError("Invalid localization syntax used in key " + std::string(key) + ": " + message);
+                    };
+
+                    switch (keyfilesyntax::checkLocale(entryLocale)) {
+                        case keyfilesyntax::LocaleError::None:
+                            break;
+                        case keyfilesyntax::LocaleError::MismatchingBrackets:
+                            throw localeError("mismatching [] brackets");
+                        case keyfilesyntax::LocaleError::InvalidOpeningBracketPosition:
+                            throw localeError("invalid [ position");
+                        case keyfilesyntax::LocaleError::InvalidClosingBracketPosition:
+                            throw localeError("invalid ] position");
+                    }
+                }
+
+                // the specification requires values to be UTF-8 encoded
+                if (!validation::isValidUtf8(value))
+                    throw ParseError("Value of key " + std::string(key) + " is not valid UTF-8");
+
+                clock.lap(statistics.validationNanoseconds);
+
+                // keys must be unique in the same section, unless the format says otherwise
+                if constexpr (Policy::rejectDuplicateKeys) {
+                    if (!handler.onEntry(key, value))
+                        throw ParseError("Key " + std::string(key) + " found more than once");
+                } else {
+                    handler.onEntry(key, value);
+                }
+
+                LD_DESKTOPFILE_STATS(
+                    ++statistics.entries;
+                    if (!entryLocale.empty())
+                        ++statistics.localizedKeys
+                );
+                clock.lap(statistics.insertionNanoseconds);
+            }
+        };
+
+        // tokenizer for desktop files, which is used unless other formats are parsed explicitly
+        typedef BasicKeyFileTokenizer<DesktopEntryPolicy> DesktopFileTokenizer;
+    }
+}
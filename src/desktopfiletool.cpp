@@ -0,0 +1,523 @@
+// system headers
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/stat.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfile.h"
+#include "linuxdeploy/desktopfile/desktopfilecollection.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "linuxdeploy/desktopfile/validation.h"
+#include "batchio.h"
+#include "parallel.h"
+#include "util.h"
+
+using namespace linuxdeploy::desktopfile;
+
+/*
+ * Applies edits to many desktop files at once.
+ *
+ * The files are read and written with batched I/O, and parsed, edited and serialized in parallel. Replaces scripts
+ * which launch a process per file.
+ */
+
+namespace {
+    class Operation {
+    public:
+        enum Type { Set, Unset, Rename };
+
+        Type type;
+        std::string section;
+
+        // key to set, remove or rename
+        std::string key;
+
+        // value to set, or new name of the key
+        std::string argument;
+    };
+
+    class FileResult {
+    public:
+        bool modified = false;
+
+        // empty on success
+        std::string error;
+    };
+
+    void printUsage(const char* name, std::ostream& os) {
+        os << "Usage: " << name << " [options] <operation>... [--] <path>..." << std::endl
+           << std::endl
+           << "Applies the operations in the given order to all desktop files. Directories are searched recursively."
+           << std::endl
+           << std::endl
+           << "Operations:" << std::endl
+           << "  --set KEY=VALUE       set key, adding it if necessary" << std::endl
+           << "  --unset KEY           remove key" << std::endl
+           << "  --rename OLD=NEW      rename key, replacing NEW if it exists already" << std::endl
+           << "  --section SECTION     apply the following operations to SECTION (default: Desktop Entry)"
+           << std::endl
+           << std::endl
+           << "Options:" << std::endl
+           << "  --jobs N              number of threads to use for parsing and editing" << std::endl
+           << "  --dry-run             report what would be modified without writing any files" << std::endl
+           << "  --quiet               report errors only" << std::endl
+           << "  --help                show this help" << std::endl;
+    }
+
+    // keys may only contain A-Za-z0-9- characters, optionally followed by a locale in brackets
+    bool isValidKey(const std::string& key) {
+        const auto nameEnd = key.find('[');
+        const auto name = key.substr(0, nameEnd);
+
+        if (name.empty() || validation::findInvalidKeyNameCharacter(name) != std::string::npos)
+            return false;
+
+        if (nameEnd == std::string::npos)
+            return true;
+
+        return key.back() == ']' && key.find('[', nameEnd + 1) == std::string::npos &&
+               key.find(']') == key.size() - 1 && key.size() > nameEnd + 2;
+    }
+
+    // splits KEY=VALUE arguments
+    // the value is trimmed like the parser trims values, otherwise it would never compare equal to the parsed one
+    bool splitAssignment(const std::string& argument, std::string& key, std::string& value) {
+        const auto pos = argument.find('=');
+
+        if (pos == std::string::npos)
+            return false;
+
+        key = argument.substr(0, pos);
+        value = trimView(std::string_view(argument).substr(pos + 1));
+        return true;
+    }
+
+    // parses positive integers, rejecting signs, whitespace and values which don't fit
+    bool parsePositiveInteger(const std::string& value, size_t& result) {
+        if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+
+        try {
+            result = std::stoul(value);
+        } catch (const std::exception&) {
+            return false;
+        }
+
+        return result > 0;
+    }
+
+    // the parser keeps the carriage return of CRLF line endings in values, values are compared without it
+    std::string_view withoutCarriageReturn(std::string_view value) {
+        if (!value.empty() && value.back() == '\r')
+            value.remove_suffix(1);
+
+        return trimView(value);
+    }
+
+    /*
+     * Edits the original text of a file line by line, so that comments, blank lines and the order of the sections
+     * and keys are kept. Only valid files are edited, i.e., files which have been parsed successfully before.
+     *
+     * The lines keep the carriage returns of CRLF line endings, replaced lines keep their line ending, and added
+     * lines use the one of the file's first line.
+     */
+    class LineEditor {
+    private:
+        std::vector<std::string> lines;
+        bool trailingNewline = true;
+        bool carriageReturns = false;
+
+        static constexpr size_t npos = std::string::npos;
+
+        static bool hasCarriageReturn(const std::string& line) {
+            return !line.empty() && line.back() == '\r';
+        }
+
+        static std::string makeLine(std::string text, bool carriageReturn) {
+            if (carriageReturn)
+                text += '\r';
+
+            return text;
+        }
+
+        static bool isComment(const std::string& line) {
+            return !line.empty() && (line[0] == '#' || line.compare(0, 2, "//") == 0);
+        }
+
+        static bool isSectionHeader(const std::string& line) {
+            return !line.empty() && line[0] == '[';
+        }
+
+        static std::string_view sectionName(const std::string& line) {
+            return std::string_view(line).substr(1, line.find(']') - 1);
+        }
+
+        static std::string_view keyOf(const std::string& line) {
+            if (line.empty() || isComment(line) || isSectionHeader(line))
+                return {};
+
+            const auto delimiterPos = line.find('=');
+
+            if (delimiterPos == npos)
+                return {};
+
+            return trimView(std::string_view(line).substr(0, delimiterPos));
+        }
+
+        // calls function with the index of every line in the given section, sections may appear more than once
+        template<typename Function>
+        void forEachLineInSection(std::string_view section, Function function) const {
+            bool inSection = false;
+
+            for (size_t i = 0; i < lines.size(); ++i) {
+                if (isSectionHeader(lines[i])) {
+                    inSection = sectionName(lines[i]) == section;
+                    continue;
+                }
+
+                if (inSection)
+                    function(i);
+            }
+        }
+
+        size_t findKey(std::string_view section, std::string_view key) const {
+            size_t found = npos;
+
+            forEachLineInSection(section, [&](size_t i) {
+                if (found == npos && keyOf(lines[i]) == key)
+                    found = i;
+            });
+
+            return found;
+        }
+
+    public:
+        explicit LineEditor(const std::string& contents) {
+            size_t position = 0;
+
+            while (position < contents.size()) {
+                auto lineEnd = contents.find('\n', position);
+
+                if (lineEnd == npos) {
+                    trailingNewline = false;
+                    lineEnd = contents.size();
+                }
+
+                lines.emplace_back(contents.substr(position, lineEnd - position));
+                position = lineEnd + 1;
+            }
+
+            carriageReturns = !lines.empty() && hasCarriageReturn(lines.front());
+        }
+
+        void set(const std::string& section, const std::string& key, const std::string& value) {
+            const auto existing = findKey(section, key);
+
+            if (existing != npos) {
+                lines[existing] = makeLine(key + "=" + value, hasCarriageReturn(lines[existing]));
+                return;
+            }
+
+            // new keys are added after the last key of the section, or right after its header
+            size_t insertAt = npos;
+            bool sectionFound = false;
+
+            for (size_t i = 0; i < lines.size(); ++i) {
+                if (isSectionHeader(lines[i]) && sectionName(lines[i]) == section) {
+                    sectionFound = true;
+                    insertAt = i + 1;
+                }
+            }
+
+            if (!sectionFound) {
+                // the parser rejects blank lines which consist of a carriage return, so CRLF files don't get one
+                if (!lines.empty() && !carriageReturns && !lines.back().empty())
+                    lines.emplace_back();
+
+                lines.emplace_back(makeLine("[" + section + "]", carriageReturns));
+                lines.emplace_back(makeLine(key + "=" + value, carriageReturns));
+                trailingNewline = true;
+                return;
+            }
+
+            forEachLineInSection(section, [&](size_t i) {
+                if (!keyOf(lines[i]).empty())
+                    insertAt = std::max(insertAt, i + 1);
+            });
+
+            lines.insert(lines.begin() + static_cast<std::ptrdiff_t>(insertAt),
+                         makeLine(key + "=" + value, carriageReturns));
+        }
+
+        void unset(const std::string& section, const std::string& key) {
+            const auto existing = findKey(section, key);
+
+            if (existing != npos)
+                lines.erase(lines.begin() + static_cast<std::ptrdiff_t>(existing));
+        }
+
+        // replaces newKey if it exists already
+        void rename(const std::string& section, const std::string& key, const std::string& newKey) {
+            unset(section, newKey);
+
+            const auto existing = findKey(section, key);
+
+            // the rest of the line, including the line ending, is kept
+            if (existing != npos) {
+                auto& line = lines[existing];
+                line = newKey + line.substr(line.find('='));
+            }
+        }
+
+        std::string toString() const {
+            std::string contents;
+
+            for (size_t i = 0; i < lines.size(); ++i) {
+                contents += lines[i];
+
+                if (i + 1 < lines.size() || trailingNewline)
+                    contents += '\n';
+            }
+
+            return contents;
+        }
+    };
+
+    // applies the operations to the parsed file, and mirrors the actual changes in the editor
+    // returns true if the file has been modified
+    bool applyOperations(DesktopFile& file, LineEditor& editor, const std::vector<Operation>& operations) {
+        bool modified = false;
+
+        for (const auto& operation : operations) {
+            switch (operation.type) {
+                case Operation::Set: {
+                    const auto* existing = file.findEntry(operation.section, operation.key);
+
+                    if (existing == nullptr || withoutCarriageReturn(existing->value()) != operation.argument) {
+                        file.setEntry(operation.section, DesktopFileEntry(operation.key, operation.argument));
+                        editor.set(operation.section, operation.key, operation.argument);
+                        modified = true;
+                    }
+
+                    break;
+                }
+                case Operation::Unset: {
+                    if (file.removeEntry(operation.section, operation.key)) {
+                        editor.unset(operation.section, operation.key);
+                        modified = true;
+                    }
+
+                    break;
+                }
+                case Operation::Rename: {
+                    const auto* existing = file.findEntry(operation.section, operation.key);
+
+                    if (existing != nullptr && operation.key != operation.argument) {
+                        auto value = existing->value();
+                        file.removeEntry(operation.section, operation.key);
+                        file.setEntry(operation.section, DesktopFileEntry(operation.argument, std::move(value)));
+                        editor.rename(operation.section, operation.key, operation.argument);
+                        modified = true;
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        return modified;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<Operation> operations;
+    std::vector<std::string> arguments;
+    std::string section = "Desktop Entry";
+    size_t jobs = defaultThreadCount();
+    bool dryRun = false;
+    bool quiet = false;
+
+    auto usageError = [argv](const std::string& message) {
+        std::cerr << argv[0] << ": " << message << std::endl
+                  << "Try '" << argv[0] << " --help' for more information." << std::endl;
+        return 2;
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (arg == "--") {
+            for (++i; i < argc; ++i)
+                arguments.emplace_back(argv[i]);
+            break;
+        }
+
+        if (arg == "--help") {
+            printUsage(argv[0], std::cout);
+            return 0;
+        }
+
+        if (arg == "--dry-run") {
+            dryRun = true;
+            continue;
+        }
+
+        if (arg == "--quiet") {
+            quiet = true;
+            continue;
+        }
+
+        if (arg == "--set" || arg == "--unset" || arg == "--rename" || arg == "--section" || arg == "--jobs") {
+            if (i + 1 >= argc)
+                return usageError("option " + arg + " requires an argument");
+
+            const std::string value = argv[++i];
+
+            if (arg == "--section") {
+                if (value.empty() || value.find_first_of("[]\n") != std::string::npos)
+                    return usageError("invalid section name: " + value);
+
+                section = value;
+            } else if (arg == "--jobs") {
+                if (!parsePositiveInteger(value, jobs))
+                    return usageError("invalid number of jobs: " + value);
+            } else if (arg == "--unset") {
+                if (!isValidKey(value))
+                    return usageError("invalid key: " + value);
+
+                operations.emplace_back(Operation{Operation::Unset, section, value, ""});
+            } else {
+                Operation operation{arg == "--set" ? Operation::Set : Operation::Rename, section, "", ""};
+
+                if (!splitAssignment(value, operation.key, operation.argument))
+                    return usageError("option " + arg + " requires an argument of the form KEY=VALUE");
+
+                if (!isValidKey(operation.key))
+                    return usageError("invalid key: " + operation.key);
+
+                if (operation.type == Operation::Rename && !isValidKey(operation.argument))
+                    return usageError("invalid key: " + operation.argument);
+
+                if (operation.argument.find_first_of("\r\n") != std::string::npos)
+                    return usageError("values must not contain line breaks");
+
+                if (operation.type == Operation::Set && !validation::isValidUtf8(operation.argument))
+                    return usageError("values must be valid UTF-8");
+
+                operations.emplace_back(std::move(operation));
+            }
+
+            continue;
+        }
+
+        if (arg.size() > 1 && arg[0] == '-')
+            return usageError("unknown option: " + arg);
+
+        arguments.emplace_back(arg);
+    }
+
+    if (operations.empty())
+        return usageError("no operations given");
+
+    if (arguments.empty())
+        return usageError("no paths given");
+
+    std::vector<BatchReadRequest> reads;
+
+    // directories which cannot be searched are reported, and counted as errors, the other paths are processed anyway
+    size_t directoryErrors = 0;
+
+    for (const auto& argument : arguments) {
+        struct stat st{};
+
+        if (stat(argument.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            try {
+                for (auto& path : DesktopFileCollection::findDesktopFiles(argument))
+                    reads.emplace_back(std::move(path));
+            } catch (const IOError& e) {
+                std::cout << argument << ": error: " << e.what() << std::endl;
+                ++directoryErrors;
+            }
+        } else {
+            // errors are reported along with the other files' results
+            reads.emplace_back(argument);
+        }
+    }
+
+    readFiles(reads);
+
+    std::vector<FileResult> results(reads.size());
+    std::vector<BatchWriteRequest> writes(reads.size());
+
+    parallelFor(reads.size(), jobs, [&](size_t i) {
+        auto& read = reads[i];
+        auto& result = results[i];
+
+        if (read.error != 0) {
+            result.error = std::string("could not read file: ") + std::strerror(read.error);
+            return;
+        }
+
+        try {
+            DesktopFile file(read.contents.data(), read.contents.size());
+            LineEditor editor(read.contents);
+            result.modified = applyOperations(file, editor, operations);
+
+            // the file is not regenerated from the parsed data, which would drop comments and reorder the sections
+            if (result.modified && !dryRun)
+                writes[i] = BatchWriteRequest(read.path, editor.toString());
+        } catch (const DesktopFileError& e) {
+            result.error = e.what();
+        }
+
+        // not needed anymore, freeing it early keeps the memory usage down with many files
+        std::string().swap(read.contents);
+    });
+
+    // unmodified files are not written at all
+    std::vector<BatchWriteRequest> pendingWrites;
+    std::vector<size_t> writeIndices;
+
+    for (size_t i = 0; i < writes.size(); ++i) {
+        if (!writes[i].path.empty()) {
+            pendingWrites.emplace_back(std::move(writes[i]));
+            writeIndices.emplace_back(i);
+        }
+    }
+
+    writeFiles(pendingWrites);
+
+    for (size_t i = 0; i < pendingWrites.size(); ++i) {
+        if (pendingWrites[i].error != 0)
+            results[writeIndices[i]].error = std::string("could not write file: ") +
+                                             std::strerror(pendingWrites[i].error);
+    }
+
+    size_t modified = 0;
+    size_t errors = directoryErrors;
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+
+        if (!result.error.empty()) {
+            ++errors;
+            std::cout << reads[i].path << ": error: " << result.error << std::endl;
+            continue;
+        }
+
+        if (result.modified)
+            ++modified;
+
+        if (!quiet)
+            std::cout << reads[i].path << ": " << (result.modified ? "modified" : "unchanged") << std::endl;
+    }
+
+    std::cerr << results.size() << " files, " << modified << (dryRun ? " would be modified, " : " modified, ")
+              << errors << " errors" << std::endl;
+
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// local headers
+#include "linuxdeploy/desktopfile/desktopfileview.h"
+#include "desktopfiletokenizer.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        class DesktopFileView::PrivateData {
+        public:
+            std::string_view buffer;
+            sections_t sections;
+
+            // section the tokenizer is currently in
+            section_t* currentSection = nullptr;
+
+        public:
+            void copyData(const std::shared_ptr<PrivateData>& other) {
+                buffer = other->buffer;
+                sections = other->sections;
+            }
+
+            void parse() {
+                // views do not keep statistics, but still count towards the process-wide ones
+                ParseStatistics statistics;
+
+                DesktopFileTokenizer tokenizer(statistics);
+                tokenizer.parse(buffer.data(), buffer.size(), *this);
+
+                LD_DESKTOPFILE_STATS(addToGlobalStatistics(statistics));
+            }
+
+            // tokenizer callbacks
+            // the views passed by the tokenizer point into the buffer, therefore they can be stored as they are
+            void onSection(std::string_view name) {
+                currentSection = &sections[name];
+            }
+
+            bool onEntry(std::string_view key, std::string_view value) {
+                return currentSection->emplace(key, value).second;
+            }
+        };
+
+        DesktopFileView::DesktopFileView() : d(std::make_shared<PrivateData>()) {}
+
+        DesktopFileView::DesktopFileView(const char* data, size_t size) : DesktopFileView(std::string_view(data, size)) {}
+
+        DesktopFileView::DesktopFileView(std::string_view data) : DesktopFileView() {
+            d->buffer = data;
+            d->parse();
+        }
+
+        DesktopFileView::DesktopFileView(const DesktopFileView& other) : DesktopFileView() {
+            d->copyData(other.d);
+        }
+
+        DesktopFileView& DesktopFileView::operator=(const DesktopFileView& other) {
+            if (this != &other) {
+                d = std::make_shared<PrivateData>();
+                d->copyData(other.d);
+            }
+
+            return *this;
+        }
+
+        DesktopFileView& DesktopFileView::operator=(DesktopFileView&& other) noexcept {
+            if (this != &other) {
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        bool DesktopFileView::isEmpty() const {
+            return d->sections.empty();
+        }
+
+        std::string_view DesktopFileView::buffer() const {
+            return d->buffer;
+        }
+
+        const DesktopFileView::sections_t& DesktopFileView::sections() const {
+            return d->sections;
+        }
+
+        const DesktopFileView::section_t* DesktopFileView::findSection(std::string_view section) const {
+            auto it = d->sections.find(section);
+            if (it == d->sections.end())
+                return nullptr;
+
+            return &it->second;
+        }
+
+        const std::string_view* DesktopFileView::findValue(std::string_view section, std::string_view key) const {
+            const auto* sectionData = findSection(section);
+            if (sectionData == nullptr)
+                return nullptr;
+
+            auto it = sectionData->find(key);
+            if (it == sectionData->end())
+                return nullptr;
+
+            return &it->second;
+        }
+
+        bool DesktopFileView::entryExists(std::string_view section, std::string_view key) const {
+            return findValue(section, key) != nullptr;
+        }
+
+        DesktopFile DesktopFileView::toDesktopFile(std::pmr::memory_resource* resource) const {
+            // parsing the buffer again guarantees the same results as DesktopFile's own buffer constructor
+            return DesktopFile(d->buffer.data(), d->buffer.size(), resource);
+        }
+    }
+}
@@ -5,6 +5,7 @@
 // local headers
 #include "linuxdeploy/desktopfile/exceptions.h"
 #include "desktopfilewriter.h"
+#include "statisticsutil.h"
 #include "util.h"
 
 namespace linuxdeploy {
@@ -12,31 +13,47 @@ namespace linuxdeploy {
         class DesktopFileWriter::PrivateData {
         public:
             DesktopFile::sections_t data;
+            SerializeStatistics statistics;
+
+            // data owned by the caller, see DesktopFileWriter::borrow()
+            const DesktopFile::sections_t* borrowedData = nullptr;
 
         public:
+            const DesktopFile::sections_t& sections() const {
+                return borrowedData != nullptr ? *borrowedData : data;
+            }
+
+            // copies take a copy of borrowed data, too
             void copyData(const std::shared_ptr<PrivateData>& other) {
-                data = other->data;
+                data = other->sections();
+                borrowedData = nullptr;
+                statistics = other->statistics;
             }
 
-            std::string dumpString() {
+            // statistics is unused unless the library is built with statistics support
+            std::string dumpString([[maybe_unused]] SerializeStatistics& statistics) const {
                 std::stringstream ss;
 
-                for (const auto& section : data) {
+                for (const auto& section : sections()) {
                     ss << "[" << section.first << "]" << std::endl;
 
                     for (const auto& pair : section.second) {
-                        auto key = pair.first;
-                        trim(key);
-                        auto value = pair.second.value();
-                        trim(value);
-                        ss << key << "=" << value << std::endl;
+                        ss << trimView(pair.first) << "=" << trimView(pair.second.value()) << std::endl;
+
+                        LD_DESKTOPFILE_STATS(++statistics.entries);
                     }
 
                     // insert an empty line between sections
                     ss << std::endl;
+
+                    LD_DESKTOPFILE_STATS(++statistics.sections);
                 }
 
-                return ss.str();
+                auto rv = ss.str();
+
+                LD_DESKTOPFILE_STATS(statistics.allocations += stringAllocations(rv));
+
+                return rv;
             }
         };
 
@@ -46,6 +63,12 @@ namespace linuxdeploy {
             d->data = std::move(data);
         }
 
+        DesktopFileWriter DesktopFileWriter::borrow(const DesktopFile::sections_t& data) {
+            DesktopFileWriter writer;
+            writer.d->borrowedData = &data;
+            return writer;
+        }
+
         DesktopFileWriter::DesktopFileWriter(const DesktopFileWriter& other) : DesktopFileWriter() {
             d->copyData(other.d);
         }
@@ -71,7 +94,7 @@ namespace linuxdeploy {
         }
 
         bool DesktopFileWriter::operator==(const DesktopFileWriter& other) const {
-            return d->data == other.d->data;
+            return d->sections() == other.d->sections();
         }
 
         bool DesktopFileWriter::operator!=(const DesktopFileWriter& other) const {
@@ -79,7 +102,7 @@ namespace linuxdeploy {
         }
 
         DesktopFile::sections_t DesktopFileWriter::data() const {
-            return d->data;
+            return d->sections();
         }
 
         void DesktopFileWriter::save(const std::string& path) {
@@ -91,8 +114,42 @@ namespace linuxdeploy {
             save(ofs);
         }
 
+        const SerializeStatistics& DesktopFileWriter::statistics() const {
+            return d->statistics;
+        }
+
+        std::string DesktopFileWriter::toString() {
+            SerializeStatistics statistics;
+            PhaseClock clock;
+
+            auto contents = d->dumpString(statistics);
+            clock.lap(statistics.formatNanoseconds);
+
+            LD_DESKTOPFILE_STATS(
+                statistics.bytesWritten = contents.size();
+                d->statistics += statistics;
+                addToGlobalStatistics(statistics)
+            );
+
+            return contents;
+        }
+
         void DesktopFileWriter::save(std::ostream& os) {
-            os << d->dumpString();
+            // a writer may be used to save multiple times, the statistics sum up all of these operations
+            SerializeStatistics statistics;
+            PhaseClock clock;
+
+            const auto contents = d->dumpString(statistics);
+            clock.lap(statistics.formatNanoseconds);
+
+            os << contents;
+            clock.lap(statistics.ioNanoseconds);
+
+            LD_DESKTOPFILE_STATS(
+                statistics.bytesWritten = contents.size();
+                d->statistics += statistics;
+                addToGlobalStatistics(statistics)
+            );
         }
     }
 }
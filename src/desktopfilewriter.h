@@ -7,6 +7,7 @@
 // local includes
 #include "linuxdeploy/desktopfile/desktopfile.h"
 #include "linuxdeploy/desktopfile/desktopfileentry.h"
+#include "linuxdeploy/desktopfile/statistics.h"
 
 namespace linuxdeploy {
     namespace desktopfile {
@@ -23,6 +24,10 @@ namespace linuxdeploy {
             // construct from data
             explicit DesktopFileWriter(DesktopFile::sections_t data);
 
+            // construct a writer which serializes the caller's data without copying it
+            // the data must not be modified or destroyed while the writer is in use, copies of the writer copy it
+            static DesktopFileWriter borrow(const DesktopFile::sections_t& data);
+
             // copy constructor
             DesktopFileWriter(const DesktopFileWriter& other);
 
@@ -42,12 +47,20 @@ namespace linuxdeploy {
             // returns desktop file path
             DesktopFile::sections_t data() const;
 
+            // returns the statistics collected while saving
+            // all values are zero unless the library has been built with statistics support
+            const SerializeStatistics& statistics() const;
+
         public:
             // save to given path
             void save(const std::string& path);
 
             // save to given ostream
             void save(std::ostream& os);
+
+            // format the data without writing it anywhere, e.g., to write it with batched I/O
+            // counts as a save operation in the statistics
+            std::string toString();
         };
     }
 }
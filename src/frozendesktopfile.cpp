@@ -0,0 +1,236 @@
+// system headers
+#include <cstring>
+#include <string>
+#include <utility>
+
+// local headers
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "linuxdeploy/desktopfile/frozendesktopfile.h"
+#include "desktopfileprivatedata.h"
+#include "frozendesktopfileprivatedata.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            // header of the binary format, followed by the frozen data
+            class BinaryHeader {
+            public:
+                char magic[4];
+
+                // written in the native byte order, used to detect data created on machines with a different one
+                uint32_t byteOrderMark;
+
+                uint16_t version;
+                uint16_t reserved;
+
+                // size of the frozen data following the header
+                uint32_t size;
+            };
+
+            const char binaryMagic[4] = {'L', 'D', 'D', 'F'};
+            const uint32_t byteOrderMark = 0x01020304;
+            const uint32_t swappedByteOrderMark = 0x04030201;
+
+            // must be increased whenever the layout of the frozen data changes
+            const uint16_t binaryVersion = 1;
+        }
+
+        FrozenDesktopFile::FrozenDesktopFile() : FrozenDesktopFile(DesktopFile()) {}
+
+        FrozenDesktopFile::FrozenDesktopFile(const DesktopFile& file) :
+            d(PrivateData::create(file.sections(), file.path(), file.contentHash())) {}
+
+        FrozenDesktopFile::FrozenDesktopFile(std::shared_ptr<const PrivateData> data) : d(std::move(data)) {}
+
+        // frozen data never changes, therefore copies can share it
+        FrozenDesktopFile::FrozenDesktopFile(const FrozenDesktopFile& other) = default;
+
+        FrozenDesktopFile& FrozenDesktopFile::operator=(const FrozenDesktopFile& other) = default;
+
+        FrozenDesktopFile& FrozenDesktopFile::operator=(FrozenDesktopFile&& other) noexcept {
+            if (this != &other) {
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        bool FrozenDesktopFile::isEmpty() const {
+            return d->sectionCount == 0;
+        }
+
+        std::string_view FrozenDesktopFile::path() const {
+            return d->string(d->path);
+        }
+
+        size_t FrozenDesktopFile::size() const {
+            return d->size;
+        }
+
+        std::vector<std::string_view> FrozenDesktopFile::sectionNames() const {
+            std::vector<std::string_view> names;
+            names.reserve(d->sectionCount);
+
+            for (uint32_t i = 0; i < d->sectionCount; ++i)
+                names.emplace_back(d->string(d->sections()[i].name));
+
+            return names;
+        }
+
+        FrozenDesktopFile::entries_t FrozenDesktopFile::entries(std::string_view section) const {
+            const auto* sectionData = d->findSection(section);
+
+            if (sectionData == nullptr)
+                throw UnknownSectionError(std::string(section));
+
+            entries_t entries;
+            entries.reserve(sectionData->entryCount);
+
+            const auto* entry = d->entries() + sectionData->firstEntry;
+            for (uint32_t i = 0; i < sectionData->entryCount; ++i, ++entry)
+                entries.emplace_back(d->string(entry->key), d->string(entry->value));
+
+            return entries;
+        }
+
+        bool FrozenDesktopFile::sectionExists(std::string_view section) const {
+            return d->findSection(section) != nullptr;
+        }
+
+        bool FrozenDesktopFile::entryExists(std::string_view section, std::string_view key) const {
+            return findValue(section, key).has_value();
+        }
+
+        std::optional<std::string_view> FrozenDesktopFile::findValue(std::string_view section,
+                                                                     std::string_view key) const {
+            const auto* sectionData = d->findSection(section);
+            if (sectionData == nullptr)
+                return std::nullopt;
+
+            const auto* entry = d->findEntry(*sectionData, key);
+            if (entry == nullptr)
+                return std::nullopt;
+
+            return d->string(entry->value);
+        }
+
+        bool FrozenDesktopFile::getEntry(std::string_view section, std::string_view key,
+                                         DesktopFileEntry& entry) const {
+            const auto value = findValue(section, key);
+            if (!value)
+                return false;
+
+            entry = DesktopFileEntry(std::string(key), std::string(*value));
+            return true;
+        }
+
+        uint64_t FrozenDesktopFile::contentHash() const {
+            return d->contentHash;
+        }
+
+        DesktopFile FrozenDesktopFile::thaw(std::pmr::memory_resource* resource) const {
+            DesktopFile file(resource);
+            file.setPath(std::string(path()));
+
+            // the data is known to be valid, so it can be inserted directly, and the hash does not need to be
+            // calculated again, it has been calculated by DesktopFile or verified by PrivateData::load()
+            auto& data = file.d->data;
+            data.reserve(d->sectionCount);
+
+            for (uint32_t i = 0; i < d->sectionCount; ++i) {
+                const auto& sectionData = d->sections()[i];
+                auto& section = data.try_emplace(std::pmr::string(d->string(sectionData.name), resource)).first->second;
+                section.reserve(sectionData.entryCount);
+
+                const auto* entry = d->entries() + sectionData.firstEntry;
+                for (uint32_t j = 0; j < sectionData.entryCount; ++j, ++entry) {
+                    const auto key = d->string(entry->key);
+                    section.try_emplace(std::pmr::string(key, resource), key, d->string(entry->value));
+                }
+            }
+
+            file.d->contentHash = d->contentHash;
+
+            return file;
+        }
+
+        std::string FrozenDesktopFile::serialize() const {
+            BinaryHeader header{};
+            std::memcpy(header.magic, binaryMagic, sizeof(header.magic));
+            header.byteOrderMark = byteOrderMark;
+            header.version = binaryVersion;
+            header.size = d->size;
+
+            std::string data(sizeof(header) + d->size, '\0');
+            std::memcpy(&data[0], &header, sizeof(header));
+            std::memcpy(&data[sizeof(header)], d.get(), d->size);
+
+            return data;
+        }
+
+        FrozenDesktopFile FrozenDesktopFile::deserialize(const char* data, size_t size) {
+            BinaryHeader header{};
+
+            if (size < sizeof(header))
+                throw ParseError("binary desktop file data too short");
+
+            std::memcpy(&header, data, sizeof(header));
+
+            if (std::memcmp(header.magic, binaryMagic, sizeof(header.magic)) != 0)
+                throw ParseError("not a binary desktop file");
+
+            if (header.byteOrderMark == swappedByteOrderMark)
+                throw ParseError("binary desktop file has been created on a machine with a different byte order");
+
+            if (header.byteOrderMark != byteOrderMark)
+                throw ParseError("invalid byte order mark in binary desktop file");
+
+            if (header.version != binaryVersion)
+                throw ParseError("unsupported binary desktop file version " + std::to_string(header.version));
+
+            if (header.size != size - sizeof(header))
+                throw ParseError("binary desktop file size mismatch");
+
+            return FrozenDesktopFile(PrivateData::load(data + sizeof(header), size - sizeof(header)));
+        }
+
+        bool operator==(const FrozenDesktopFile& first, const FrozenDesktopFile& second) {
+            const auto& a = *first.d;
+            const auto& b = *second.d;
+
+            if (&a == &b)
+                return true;
+
+            // the hash rules out most unequal files cheaply
+            // the buffers are not compared as a whole, as equal contents may be laid out differently, e.g., by
+            // another version of the library
+            if (a.contentHash != b.contentHash || a.sectionCount != b.sectionCount || a.entryCount != b.entryCount ||
+                a.string(a.path) != b.string(b.path))
+                return false;
+
+            // both tables are sorted, therefore equal files have equal tables
+            for (uint32_t i = 0; i < a.sectionCount; ++i) {
+                const auto& sectionA = a.sections()[i];
+                const auto& sectionB = b.sections()[i];
+
+                if (a.string(sectionA.name) != b.string(sectionB.name) || sectionA.entryCount != sectionB.entryCount)
+                    return false;
+            }
+
+            for (uint32_t i = 0; i < a.entryCount; ++i) {
+                const auto& entryA = a.entries()[i];
+                const auto& entryB = b.entries()[i];
+
+                if (a.string(entryA.key) != b.string(entryB.key) || a.string(entryA.value) != b.string(entryB.value))
+                    return false;
+            }
+
+            return true;
+        }
+
+        bool operator!=(const FrozenDesktopFile& first, const FrozenDesktopFile& second) {
+            return !operator==(first, second);
+        }
+    }
+}
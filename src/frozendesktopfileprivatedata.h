@@ -0,0 +1,306 @@
+#pragma once
+
+// system headers
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// local headers
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "linuxdeploy/desktopfile/frozendesktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /*
+         * Header at the beginning of the buffer of a frozen file.
+         *
+         * The buffer is laid out as follows:
+         *
+         *   header (this class)
+         *   Section[sectionCount], sorted by name
+         *   Entry[entryCount], grouped by section, sorted by key within each section
+         *   string pool
+         *
+         * All references within the buffer are 32-bit offsets instead of pointers, therefore the buffer can be copied
+         * or stored as it is.
+         */
+        class FrozenDesktopFile::PrivateData {
+        public:
+            // string in the string pool, the offset is relative to the beginning of the pool
+            class String {
+            public:
+                uint32_t offset;
+                uint32_t length;
+            };
+
+            class Section {
+            public:
+                String name;
+
+                // range in the entry table
+                uint32_t firstEntry;
+                uint32_t entryCount;
+            };
+
+            class Entry {
+            public:
+                String key;
+                String value;
+            };
+
+        public:
+            uint64_t contentHash;
+
+            // size of the whole buffer, including this header
+            uint32_t size;
+
+            uint32_t sectionCount;
+            uint32_t entryCount;
+
+            String path;
+
+            // makes the size of the header a multiple of 8 without any padding bytes, reserved for future use
+            uint32_t reserved;
+
+        public:
+            const Section* sections() const {
+                return reinterpret_cast<const Section*>(this + 1);
+            }
+
+            const Entry* entries() const {
+                return reinterpret_cast<const Entry*>(sections() + sectionCount);
+            }
+
+            const char* strings() const {
+                return reinterpret_cast<const char*>(entries() + entryCount);
+            }
+
+            std::string_view string(const String& string) const {
+                return {strings() + string.offset, string.length};
+            }
+
+            // binary search in the section table
+            // returns nullptr if the section does not exist
+            const Section* findSection(std::string_view name) const {
+                const auto* begin = sections();
+                const auto* end = begin + sectionCount;
+
+                const auto* it = std::lower_bound(begin, end, name, [this](const Section& section, std::string_view name) {
+                    return string(section.name) < name;
+                });
+
+                if (it == end || string(it->name) != name)
+                    return nullptr;
+
+                return it;
+            }
+
+            // binary search in the section's part of the entry table
+            // returns nullptr if the entry does not exist
+            const Entry* findEntry(const Section& section, std::string_view key) const {
+                const auto* begin = entries() + section.firstEntry;
+                const auto* end = begin + section.entryCount;
+
+                const auto* it = std::lower_bound(begin, end, key, [this](const Entry& entry, std::string_view key) {
+                    return string(entry.key) < key;
+                });
+
+                if (it == end || string(it->key) != key)
+                    return nullptr;
+
+                return it;
+            }
+
+            // copy a buffer created by create() (e.g., after it has been sent to another process), and validate it
+            // every offset and length is bounds-checked, and the tables must be sorted, so that lookups work
+            // throws ParseError if the data is invalid
+            static std::shared_ptr<const PrivateData> load(const char* data, size_t size) {
+                if (size < sizeof(PrivateData))
+                    throw ParseError("frozen desktop file data too short");
+
+                if (size > UINT32_MAX)
+                    throw ParseError("frozen desktop file data too long");
+
+                auto buffer = std::make_shared_for_overwrite<uint64_t[]>((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+                std::memcpy(buffer.get(), data, size);
+
+                const auto* header = reinterpret_cast<const PrivateData*>(buffer.get());
+
+                if (header->size != size)
+                    throw ParseError("frozen desktop file size mismatch");
+
+                if (header->reserved != 0)
+                    throw ParseError("unsupported frozen desktop file flags");
+
+                // 64-bit arithmetic cannot overflow with 32-bit counts
+                const uint64_t tablesSize = uint64_t(header->sectionCount) * sizeof(Section) +
+                                            uint64_t(header->entryCount) * sizeof(Entry);
+
+                if (sizeof(PrivateData) + tablesSize > size)
+                    throw ParseError("frozen desktop file tables exceed data");
+
+                const uint64_t poolSize = size - sizeof(PrivateData) - tablesSize;
+
+                auto checkString = [poolSize](const String& string) {
+                    if (uint64_t(string.offset) + string.length > poolSize)
+                        throw ParseError("frozen desktop file string exceeds data");
+                };
+
+                checkString(header->path);
+
+                uint32_t nextEntry = 0;
+
+                // a stale or corrupted hash would break comparisons of the thawed file with other files
+                uint64_t contentHash = 0;
+
+                for (uint32_t i = 0; i < header->sectionCount; ++i) {
+                    const auto& section = header->sections()[i];
+                    checkString(section.name);
+                    contentHash += DesktopFile::PrivateData::sectionHash(header->string(section.name));
+
+                    if (i > 0 && !(header->string(header->sections()[i - 1].name) < header->string(section.name)))
+                        throw ParseError("frozen desktop file sections not sorted");
+
+                    if (section.firstEntry != nextEntry || section.entryCount > header->entryCount - nextEntry)
+                        throw ParseError("frozen desktop file entry range invalid");
+
+                    for (uint32_t j = 0; j < section.entryCount; ++j) {
+                        const auto& entry = header->entries()[section.firstEntry + j];
+                        checkString(entry.key);
+                        checkString(entry.value);
+                        contentHash += DesktopFile::PrivateData::entryHash(header->string(section.name),
+                                                                           header->string(entry.key),
+                                                                           header->string(entry.value));
+
+                        if (j > 0 && !(header->string(header->entries()[section.firstEntry + j - 1].key) <
+                                       header->string(entry.key)))
+                            throw ParseError("frozen desktop file entries not sorted");
+                    }
+
+                    nextEntry += section.entryCount;
+                }
+
+                if (nextEntry != header->entryCount)
+                    throw ParseError("frozen desktop file entry count mismatch");
+
+                if (contentHash != header->contentHash)
+                    throw ParseError("frozen desktop file content hash mismatch");
+
+                return std::shared_ptr<const PrivateData>(buffer, header);
+            }
+
+            // pack the given data into a new buffer
+            static std::shared_ptr<const PrivateData> create(const DesktopFile::sections_t& data, std::string_view path,
+                                                             uint64_t contentHash) {
+                static_assert(std::is_trivially_copyable<PrivateData>::value, "header must be trivially copyable");
+                static_assert(sizeof(PrivateData) % alignof(uint64_t) == 0, "header must not need any padding");
+
+                // sort sections and entries, the tables are searched with binary searches
+                typedef const DesktopFile::sections_t::value_type* section_ptr_t;
+                typedef const DesktopFile::section_t::value_type* entry_ptr_t;
+
+                std::vector<section_ptr_t> sortedSections;
+                sortedSections.reserve(data.size());
+
+                size_t entryCount = 0;
+
+                for (const auto& section : data) {
+                    sortedSections.emplace_back(&section);
+                    entryCount += section.second.size();
+                }
+
+                std::sort(sortedSections.begin(), sortedSections.end(), [](section_ptr_t a, section_ptr_t b) {
+                    return a->first < b->first;
+                });
+
+                std::vector<entry_ptr_t> sortedEntries;
+                sortedEntries.reserve(entryCount);
+
+                for (const auto* section : sortedSections) {
+                    const auto sectionBegin = sortedEntries.size();
+
+                    for (const auto& entry : section->second)
+                        sortedEntries.emplace_back(&entry);
+
+                    std::sort(sortedEntries.begin() + sectionBegin, sortedEntries.end(), [](entry_ptr_t a, entry_ptr_t b) {
+                        return a->first < b->first;
+                    });
+                }
+
+                // assign offsets in the string pool, every distinct string is stored once only
+                std::unordered_map<std::string_view, String> pool;
+                std::vector<std::string_view> poolOrder;
+                size_t poolSize = 0;
+
+                auto intern = [&](std::string_view string) {
+                    auto inserted = pool.try_emplace(string, String{static_cast<uint32_t>(poolSize),
+                                                                    static_cast<uint32_t>(string.size())});
+
+                    if (inserted.second) {
+                        poolOrder.emplace_back(string);
+                        poolSize += string.size();
+                    }
+
+                    return inserted.first->second;
+                };
+
+                const auto pathString = intern(path);
+
+                std::vector<Section> sectionTable;
+                sectionTable.reserve(sortedSections.size());
+
+                std::vector<Entry> entryTable;
+                entryTable.reserve(sortedEntries.size());
+
+                for (const auto* section : sortedSections) {
+                    sectionTable.emplace_back(Section{
+                        intern(section->first),
+                        static_cast<uint32_t>(entryTable.size()),
+                        static_cast<uint32_t>(section->second.size()),
+                    });
+
+                    for (size_t i = 0; i < section->second.size(); ++i) {
+                        const auto* entry = sortedEntries[entryTable.size()];
+                        entryTable.emplace_back(Entry{intern(entry->first), intern(entry->second.value())});
+                    }
+                }
+
+                const size_t size = sizeof(PrivateData) + sectionTable.size() * sizeof(Section) +
+                                    entryTable.size() * sizeof(Entry) + poolSize;
+
+                if (size > UINT32_MAX)
+                    throw DesktopFileError("desktop file too large to be frozen");
+
+                // the buffer is allocated as 64-bit words to make sure the header is aligned properly
+                auto buffer = std::make_shared_for_overwrite<uint64_t[]>((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+
+                auto* header = new (buffer.get()) PrivateData{
+                    contentHash,
+                    static_cast<uint32_t>(size),
+                    static_cast<uint32_t>(sectionTable.size()),
+                    static_cast<uint32_t>(entryTable.size()),
+                    pathString,
+                    0,
+                };
+
+                std::copy(sectionTable.begin(), sectionTable.end(), const_cast<Section*>(header->sections()));
+                std::copy(entryTable.begin(), entryTable.end(), const_cast<Entry*>(header->entries()));
+
+                auto* strings = const_cast<char*>(header->strings());
+                for (const auto& string : poolOrder) {
+                    if (!string.empty())
+                        std::memcpy(strings + pool[string].offset, string.data(), string.size());
+                }
+
+                // the header shares the ownership of the buffer
+                return std::shared_ptr<const PrivateData>(buffer, header);
+            }
+        };
+    }
+}
@@ -0,0 +1,584 @@
+// system headers
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "linuxdeploy/desktopfile/iconthemeresolver.h"
+#include "linuxdeploy/desktopfile/keyfilepolicies.h"
+#include "desktopfilereader.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            // in the order of preference defined by the specification
+            const char* const extensions[] = {"png", "svg", "xpm"};
+
+            // returns the index in extensions, or -1 if the name does not end with any of them
+            int extensionIndex(std::string_view name) {
+                for (int i = 0; i < 3; ++i) {
+                    const std::string_view extension = extensions[i];
+
+                    if (name.size() > extension.size() + 1 &&
+                        name.substr(name.size() - extension.size()) == extension &&
+                        name[name.size() - extension.size() - 1] == '.') {
+                        return i;
+                    }
+                }
+
+                return -1;
+            }
+
+            std::vector<std::string> splitList(std::string_view list) {
+                std::vector<std::string> items;
+
+                std::stringstream ss{std::string(list)};
+                std::string item;
+
+                while (std::getline(ss, item, ',')) {
+                    if (!item.empty())
+                        items.emplace_back(item);
+                }
+
+                return items;
+            }
+
+            // modification time of a path, or a zero timestamp if the path does not exist
+            // used to detect changes of the indexed directories
+            struct timespec modificationTime(const std::string& path) {
+                struct stat st{};
+
+                if (stat(path.c_str(), &st) != 0)
+                    return {};
+
+                return st.st_mtim;
+            }
+
+            bool operator==(const struct timespec& first, const struct timespec& second) {
+                return first.tv_sec == second.tv_sec && first.tv_nsec == second.tv_nsec;
+            }
+
+            // calls function with the icon name and the extension index for every icon file in the directory
+            template<typename Function>
+            void forEachIcon(const std::string& directory, const Function& function) {
+                auto* dir = opendir(directory.c_str());
+
+                if (dir == nullptr)
+                    return;
+
+                struct dirent* ent;
+                while ((ent = readdir(dir)) != nullptr) {
+                    const std::string_view name = ent->d_name;
+                    const auto extension = extensionIndex(name);
+
+                    if (extension >= 0)
+                        function(name.substr(0, name.size() - std::string_view(extensions[extension]).size() - 1),
+                                 extension);
+                }
+
+                closedir(dir);
+            }
+        }
+
+        class IconThemeResolver::PrivateData {
+        public:
+            // theme subdirectory, described by a section in index.theme
+            class Directory {
+            public:
+                enum Type { Fixed, Scalable, Threshold };
+
+                std::string name;
+                Type type = Threshold;
+                int size = 0;
+                int scale = 1;
+                int minSize = 0;
+                int maxSize = 0;
+                int threshold = 2;
+
+            public:
+                // see DirectoryMatchesSize in the specification
+                bool matchesSize(int iconSize, int iconScale) const {
+                    if (scale != iconScale)
+                        return false;
+
+                    switch (type) {
+                        case Fixed:
+                            return size == iconSize;
+                        case Scalable:
+                            return minSize <= iconSize && iconSize <= maxSize;
+                        case Threshold:
+                        default:
+                            return size - threshold <= iconSize && iconSize <= size + threshold;
+                    }
+                }
+
+                // see DirectorySizeDistance in the specification
+                int sizeDistance(int iconSize, int iconScale) const {
+                    const auto scaledSize = iconSize * iconScale;
+
+                    int min, max;
+
+                    switch (type) {
+                        case Fixed:
+                            return std::abs(size * scale - scaledSize);
+                        case Scalable:
+                            min = minSize;
+                            max = maxSize;
+                            break;
+                        case Threshold:
+                        default:
+                            min = size - threshold;
+                            max = size + threshold;
+                            break;
+                    }
+
+                    if (scaledSize < min * scale)
+                        return min * scale - scaledSize;
+
+                    if (scaledSize > max * scale)
+                        return scaledSize - max * scale;
+
+                    return 0;
+                }
+            };
+
+            // a file providing an icon
+            class Location {
+            public:
+                // index in Theme::directories
+                uint32_t directory;
+
+                // index in baseDirectories
+                uint32_t baseDirectory;
+
+                // index in extensions
+                uint32_t extension;
+            };
+
+            class Theme {
+            public:
+                // false if index.theme could not be found or read
+                bool valid = false;
+
+                std::vector<std::string> parents;
+                std::vector<Directory> directories;
+
+                // maps icon names to the files providing them
+                // the locations are in the order the specification's lookup algorithm would find them
+                std::unordered_map<std::string, std::vector<Location>> icons;
+
+                // every directory read to build the index, and its modification time at that point
+                std::vector<std::pair<std::string, struct timespec>> watched;
+            };
+
+        public:
+            std::string theme;
+            std::vector<std::string> baseDirectories;
+
+            // indexed on demand
+            std::map<std::string, Theme> themes;
+
+            // icons directly within the base directories, used if no theme provides an icon
+            bool fallbackIndexed = false;
+            std::unordered_map<std::string, std::vector<Location>> fallbackIcons;
+            std::vector<std::pair<std::string, struct timespec>> fallbackWatched;
+
+        public:
+            PrivateData(std::string theme, std::vector<std::string> baseDirectories) :
+                theme(std::move(theme)), baseDirectories(std::move(baseDirectories)) {}
+
+            void copyData(const std::shared_ptr<PrivateData>& other) {
+                theme = other->theme;
+                baseDirectories = other->baseDirectories;
+                themes = other->themes;
+                fallbackIndexed = other->fallbackIndexed;
+                fallbackIcons = other->fallbackIcons;
+                fallbackWatched = other->fallbackWatched;
+            }
+
+            std::string path(const Theme& theme, const std::string& themeName, const Location& location) const {
+                return baseDirectories[location.baseDirectory] + "/" + themeName + "/" +
+                       theme.directories[location.directory].name + "/";
+            }
+
+            // returns nullptr if the section or the key doesn't exist
+            static const DesktopFileEntry* findEntry(const DesktopFile::sections_t& index, std::string_view section,
+                                                     std::string_view key) {
+                const auto sectionIt = index.find(section);
+
+                if (sectionIt == index.end())
+                    return nullptr;
+
+                const auto entryIt = sectionIt->second.find(key);
+                return entryIt == sectionIt->second.end() ? nullptr : &entryIt->second;
+            }
+
+            static Directory readDirectory(const DesktopFile::sections_t& index, const std::string& name) {
+                Directory directory;
+                directory.name = name;
+
+                auto readInt = [&index, &name](const char* key, int defaultValue) {
+                    const auto* entry = findEntry(index, name, key);
+
+                    if (entry == nullptr || entry->value().empty())
+                        return defaultValue;
+
+                    try {
+                        return entry->asInt();
+                    } catch (const BadLexicalCastError&) {
+                        return defaultValue;
+                    }
+                };
+
+                directory.size = readInt("Size", 0);
+                directory.scale = readInt("Scale", 1);
+                directory.minSize = readInt("MinSize", directory.size);
+                directory.maxSize = readInt("MaxSize", directory.size);
+                directory.threshold = readInt("Threshold", 2);
+
+                const auto* type = findEntry(index, name, "Type");
+
+                if (type != nullptr) {
+                    if (type->value() == "Fixed")
+                        directory.type = Directory::Fixed;
+                    else if (type->value() == "Scalable")
+                        directory.type = Directory::Scalable;
+                }
+
+                return directory;
+            }
+
+            Theme& indexTheme(const std::string& name) {
+                auto it = themes.find(name);
+
+                if (it != themes.end())
+                    return it->second;
+
+                auto& theme = themes[name];
+
+                // the first index.theme found is used, the directories are looked up in all base directories
+                for (const auto& baseDirectory : baseDirectories) {
+                    const auto themeDirectory = baseDirectory + "/" + name;
+                    const auto indexPath = themeDirectory + "/index.theme";
+                    theme.watched.emplace_back(themeDirectory, modificationTime(themeDirectory));
+                    theme.watched.emplace_back(indexPath, modificationTime(indexPath));
+
+                    if (theme.valid)
+                        continue;
+
+                    DesktopFile::sections_t index;
+
+                    try {
+                        // index.theme files are not desktop files, and some of them contain duplicate keys
+                        index = DesktopFileReader(indexPath, IconThemeIndexPolicy()).takeData();
+                    } catch (const DesktopFileError&) {
+                        // themes which cannot be read are treated like themes which don't exist
+                        continue;
+                    }
+
+                    const auto* inherits = findEntry(index, "Icon Theme", "Inherits");
+                    if (inherits != nullptr)
+                        theme.parents = splitList(inherits->value());
+
+                    for (const auto* key : {"Directories", "ScaledDirectories"}) {
+                        const auto* directories = findEntry(index, "Icon Theme", key);
+
+                        if (directories == nullptr)
+                            continue;
+
+                        for (const auto& directory : splitList(directories->value())) {
+                            if (index.find(directory) != index.end())
+                                theme.directories.emplace_back(readDirectory(index, directory));
+                        }
+                    }
+
+                    theme.valid = true;
+                }
+
+                // the locations are added in the specification's lookup order: directory, base directory, extension
+                // therefore, every icon's locations are sorted the same way
+                for (uint32_t i = 0; i < theme.directories.size(); ++i) {
+                    for (uint32_t j = 0; j < baseDirectories.size(); ++j) {
+                        const auto directory = baseDirectories[j] + "/" + name + "/" + theme.directories[i].name;
+                        theme.watched.emplace_back(directory, modificationTime(directory));
+
+                        std::vector<std::pair<std::string, uint32_t>> found;
+
+                        forEachIcon(directory, [&](std::string_view icon, int extension) {
+                            found.emplace_back(icon, static_cast<uint32_t>(extension));
+                        });
+
+                        // readdir does not sort the entries, but the extensions' order of preference matters
+                        std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+                            return a.second < b.second;
+                        });
+
+                        for (const auto& icon : found)
+                            theme.icons[icon.first].emplace_back(Location{i, j, icon.second});
+                    }
+                }
+
+                return theme;
+            }
+
+            void indexFallback() {
+                if (fallbackIndexed)
+                    return;
+
+                for (uint32_t i = 0; i < baseDirectories.size(); ++i) {
+                    fallbackWatched.emplace_back(baseDirectories[i], modificationTime(baseDirectories[i]));
+
+                    forEachIcon(baseDirectories[i], [&](std::string_view icon, int extension) {
+                        fallbackIcons[std::string(icon)].emplace_back(Location{0, i, static_cast<uint32_t>(extension)});
+                    });
+                }
+
+                for (auto& icon : fallbackIcons) {
+                    std::sort(icon.second.begin(), icon.second.end(), [](const Location& a, const Location& b) {
+                        return a.baseDirectory != b.baseDirectory ? a.baseDirectory < b.baseDirectory
+                                                                  : a.extension < b.extension;
+                    });
+                }
+
+                fallbackIndexed = true;
+            }
+
+            // see LookupIcon in the specification
+            std::string lookupIcon(const std::string& icon, int size, int scale, const std::string& themeName) {
+                const auto& theme = indexTheme(themeName);
+
+                auto it = theme.icons.find(icon);
+                if (it == theme.icons.end())
+                    return "";
+
+                const auto& locations = it->second;
+
+                auto fileName = [&](const Location& location) {
+                    return path(theme, themeName, location) + icon + "." + extensions[location.extension];
+                };
+
+                for (const auto& location : locations) {
+                    if (theme.directories[location.directory].matchesSize(size, scale))
+                        return fileName(location);
+                }
+
+                const Location* closest = nullptr;
+                int minimalDistance = INT_MAX;
+
+                for (const auto& location : locations) {
+                    const auto distance = theme.directories[location.directory].sizeDistance(size, scale);
+
+                    if (distance < minimalDistance) {
+                        closest = &location;
+                        minimalDistance = distance;
+                    }
+                }
+
+                return fileName(*closest);
+            }
+
+            // see FindIconHelper in the specification
+            // visited protects against inheritance cycles
+            std::string findIconHelper(const std::string& icon, int size, int scale, const std::string& themeName,
+                                       std::set<std::string>& visited) {
+                if (!visited.insert(themeName).second)
+                    return "";
+
+                auto fileName = lookupIcon(icon, size, scale, themeName);
+
+                if (!fileName.empty())
+                    return fileName;
+
+                // references to the themes stay valid while more themes are indexed
+                const auto& parents = indexTheme(themeName).parents;
+
+                for (const auto& parent : parents) {
+                    fileName = findIconHelper(icon, size, scale, parent, visited);
+
+                    if (!fileName.empty())
+                        return fileName;
+                }
+
+                return "";
+            }
+
+            // see FindIcon in the specification
+            std::string findIcon(const std::string& icon, int size, int scale) {
+                std::set<std::string> visited;
+
+                auto fileName = findIconHelper(icon, size, scale, theme, visited);
+
+                if (fileName.empty())
+                    fileName = findIconHelper(icon, size, scale, "hicolor", visited);
+
+                if (!fileName.empty())
+                    return fileName;
+
+                // see LookupFallbackIcon in the specification
+                indexFallback();
+
+                auto it = fallbackIcons.find(icon);
+                if (it == fallbackIcons.end())
+                    return "";
+
+                const auto& location = it->second.front();
+                return baseDirectories[location.baseDirectory] + "/" + icon + "." + extensions[location.extension];
+            }
+
+            static bool changed(const std::vector<std::pair<std::string, struct timespec>>& watched) {
+                for (const auto& directory : watched) {
+                    if (!(modificationTime(directory.first) == directory.second))
+                        return true;
+                }
+
+                return false;
+            }
+        };
+
+        IconThemeResolver::IconThemeResolver() : IconThemeResolver("hicolor") {}
+
+        IconThemeResolver::IconThemeResolver(std::string theme) :
+            IconThemeResolver(std::move(theme), defaultBaseDirectories()) {}
+
+        IconThemeResolver::IconThemeResolver(std::string theme, std::vector<std::string> baseDirectories) {
+            // trailing slashes would result in double slashes in the paths
+            for (auto& baseDirectory : baseDirectories) {
+                while (baseDirectory.size() > 1 && baseDirectory.back() == '/')
+                    baseDirectory.pop_back();
+            }
+
+            d = std::make_shared<PrivateData>(std::move(theme), std::move(baseDirectories));
+        }
+
+        IconThemeResolver::IconThemeResolver(const IconThemeResolver& other) : IconThemeResolver() {
+            d->copyData(other.d);
+        }
+
+        IconThemeResolver& IconThemeResolver::operator=(const IconThemeResolver& other) {
+            if (this != &other) {
+                d->copyData(other.d);
+            }
+
+            return *this;
+        }
+
+        IconThemeResolver& IconThemeResolver::operator=(IconThemeResolver&& other) noexcept {
+            if (this != &other) {
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        std::string IconThemeResolver::theme() const {
+            return d->theme;
+        }
+
+        std::vector<std::string> IconThemeResolver::baseDirectories() const {
+            return d->baseDirectories;
+        }
+
+        std::string IconThemeResolver::resolve(std::string_view icon, int size, int scale) {
+            if (icon.empty())
+                return "";
+
+            if (icon[0] == '/') {
+                struct stat st{};
+                return stat(std::string(icon).c_str(), &st) == 0 ? std::string(icon) : "";
+            }
+
+            auto fileName = d->findIcon(std::string(icon), size, scale);
+
+            if (fileName.empty()) {
+                const auto extension = extensionIndex(icon);
+
+                if (extension >= 0) {
+                    const auto name = icon.substr(0, icon.size() - std::string_view(extensions[extension]).size() - 1);
+                    fileName = d->findIcon(std::string(name), size, scale);
+                }
+            }
+
+            return fileName;
+        }
+
+        std::string IconThemeResolver::resolve(const DesktopFile& file, int size, int scale) {
+            const auto* icon = file.findEntry("Desktop Entry", "Icon");
+
+            if (icon == nullptr)
+                return "";
+
+            return resolve(icon->value(), size, scale);
+        }
+
+        void IconThemeResolver::invalidate() {
+            d->themes.clear();
+            d->fallbackIndexed = false;
+            d->fallbackIcons.clear();
+            d->fallbackWatched.clear();
+        }
+
+        bool IconThemeResolver::refreshIfChanged() {
+            bool discarded = false;
+
+            for (auto it = d->themes.begin(); it != d->themes.end();) {
+                if (PrivateData::changed(it->second.watched)) {
+                    it = d->themes.erase(it);
+                    discarded = true;
+                } else {
+                    ++it;
+                }
+            }
+
+            if (d->fallbackIndexed && PrivateData::changed(d->fallbackWatched)) {
+                d->fallbackIndexed = false;
+                d->fallbackIcons.clear();
+                d->fallbackWatched.clear();
+                discarded = true;
+            }
+
+            return discarded;
+        }
+
+        std::vector<std::string> IconThemeResolver::defaultBaseDirectories() {
+            std::vector<std::string> directories;
+
+            const auto* home = getenv("HOME");
+
+            if (home != nullptr && home[0] != '\0')
+                directories.emplace_back(std::string(home) + "/.icons");
+
+            const auto* dataHome = getenv("XDG_DATA_HOME");
+
+            if (dataHome != nullptr && dataHome[0] != '\0')
+                directories.emplace_back(std::string(dataHome) + "/icons");
+            else if (home != nullptr && home[0] != '\0')
+                directories.emplace_back(std::string(home) + "/.local/share/icons");
+
+            const auto* dataDirs = getenv("XDG_DATA_DIRS");
+            std::string dataDirsList = (dataDirs != nullptr && dataDirs[0] != '\0') ? dataDirs
+                                                                                  : "/usr/local/share:/usr/share";
+
+            std::stringstream ss(dataDirsList);
+            std::string directory;
+
+            while (std::getline(ss, directory, ':')) {
+                if (!directory.empty())
+                    directories.emplace_back(directory + "/icons");
+            }
+
+            directories.emplace_back("/usr/share/pixmaps");
+
+            return directories;
+        }
+    }
+}
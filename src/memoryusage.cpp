@@ -0,0 +1,17 @@
+// local headers
+#include "linuxdeploy/desktopfile/memoryusage.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        uint64_t MemoryUsage::total() const {
+            return stringBytes + containerBytes + privateDataBytes;
+        }
+
+        MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+            stringBytes += other.stringBytes;
+            containerBytes += other.containerBytes;
+            privateDataBytes += other.privateDataBytes;
+            return *this;
+        }
+    }
+}
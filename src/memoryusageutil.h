@@ -0,0 +1,39 @@
+#pragma once
+
+// system headers
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+// local headers
+#include "linuxdeploy/desktopfile/memoryusage.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        // characters stored outside of the string object, zero if the string fits into the small string buffer
+        template<typename Allocator>
+        size_t heapBytes(const std::basic_string<char, std::char_traits<char>, Allocator>& string) {
+            static const auto smallStringCapacity = std::string().capacity();
+            return string.capacity() > smallStringCapacity ? string.capacity() + 1 : 0;
+        }
+
+        // control block of a shared pointer created with std::make_shared or std::allocate_shared: a vtable pointer,
+        // the two reference counts, and the allocator, unless it is stateless
+        template<typename Allocator = std::allocator<void>>
+        constexpr size_t controlBlockBytes =
+            sizeof(void*) + 2 * sizeof(int) + (std::is_empty_v<Allocator> ? 0 : sizeof(Allocator));
+
+        // bucket array and nodes of a hash table, every node holds a value and a pointer to the next node
+        template<typename Map>
+        size_t hashTableBytes(const Map& map) {
+            return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(typename Map::value_type) + sizeof(void*));
+        }
+
+        // nodes of a red-black tree, every node holds a value, three pointers and the color
+        template<typename Map>
+        size_t treeBytes(const Map& map) {
+            return map.size() * (sizeof(typename Map::value_type) + 4 * sizeof(void*));
+        }
+    }
+}
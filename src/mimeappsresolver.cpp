@@ -0,0 +1,308 @@
+// system headers
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopentryschema.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "linuxdeploy/desktopfile/mimeappsresolver.h"
+#include "batchio.h"
+#include "desktopfiletokenizer.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            // the order of the keys does not matter, every MIME type is handled on its own
+            typedef std::unordered_map<std::string_view, std::string_view> list_entries_t;
+
+            // tokenizer handler which collects the entries of the groups the resolver is interested in
+            // the views point into the buffer which is parsed
+            class ListHandler {
+            public:
+                list_entries_t defaults;
+                list_entries_t added;
+                list_entries_t removed;
+
+            private:
+                // nullptr in other groups
+                list_entries_t* currentGroup = nullptr;
+
+            public:
+                void onSection(std::string_view name) {
+                    if (name == "Default Applications")
+                        currentGroup = &defaults;
+                    else if (name == "Added Associations")
+                        currentGroup = &added;
+                    else if (name == "Removed Associations")
+                        currentGroup = &removed;
+                    else
+                        currentGroup = nullptr;
+                }
+
+                // duplicate keys are passed as well, the last value wins, see MimeAppsPolicy
+                bool onEntry(std::string_view key, std::string_view value) {
+                    if (currentGroup != nullptr)
+                        currentGroup->insert_or_assign(key, value);
+
+                    return true;
+                }
+            };
+
+            // split a semicolon separated list of desktop file IDs, skipping empty items
+            std::vector<std::string_view> splitList(std::string_view value) {
+                std::vector<std::string_view> items;
+
+                while (!value.empty()) {
+                    const auto separatorPos = value.find(';');
+                    const auto item = value.substr(0, separatorPos);
+
+                    if (!item.empty())
+                        items.emplace_back(item);
+
+                    if (separatorPos == std::string_view::npos)
+                        break;
+
+                    value.remove_prefix(separatorPos + 1);
+                }
+
+                return items;
+            }
+
+            std::string getEnv(const char* name, const std::string& fallback) {
+                const auto* value = getenv(name);
+                return (value != nullptr && value[0] != '\0') ? std::string(value) : fallback;
+            }
+
+            std::vector<std::string> splitPathList(const std::string& list) {
+                std::vector<std::string> paths;
+
+                std::stringstream ss(list);
+                std::string path;
+
+                while (std::getline(ss, path, ':')) {
+                    if (!path.empty())
+                        paths.emplace_back(path);
+                }
+
+                return paths;
+            }
+        }
+
+        class MimeAppsResolver::PrivateData {
+        public:
+            typedef std::unordered_set<std::string, TransparentStringHash, std::equal_to<>> ids_t;
+
+            std::vector<std::string> listPaths;
+            DesktopFileOverlay applications;
+
+            std::unordered_map<std::string, std::string, TransparentStringHash, std::equal_to<>> defaults;
+            std::unordered_map<std::string, std::vector<std::string>, TransparentStringHash, std::equal_to<>>
+                associations;
+            errors_t errors;
+
+        public:
+            void copyData(const std::shared_ptr<PrivateData>& other) {
+                listPaths = other->listPaths;
+                applications = other->applications;
+                defaults = other->defaults;
+                associations = other->associations;
+                errors = other->errors;
+            }
+
+            bool isInstalled(std::string_view id) const {
+                return applications.find(id) != nullptr;
+            }
+
+            void load() {
+                decltype(defaults) newDefaults;
+                decltype(associations) newAssociations;
+                errors_t newErrors;
+
+                // associations removed by the lists processed so far, by MIME type
+                std::unordered_map<std::string, ids_t, TransparentStringHash, std::equal_to<>> removed;
+
+                auto isRemoved = [&removed](std::string_view mimeType, std::string_view id) {
+                    const auto it = removed.find(mimeType);
+                    return it != removed.end() && it->second.find(id) != it->second.end();
+                };
+
+                auto associate = [&](std::string_view mimeType, std::string_view id) {
+                    if (isRemoved(mimeType, id))
+                        return;
+
+                    auto& ids = newAssociations[std::string(mimeType)];
+
+                    if (std::find(ids.begin(), ids.end(), id) == ids.end())
+                        ids.emplace_back(id);
+                };
+
+                std::vector<BatchReadRequest> requests(listPaths.begin(), listPaths.end());
+                readFiles(requests);
+
+                for (const auto& request : requests) {
+                    if (request.error != 0) {
+                        // most of the lists usually don't exist
+                        if (request.error != ENOENT && request.error != ENOTDIR)
+                            newErrors[request.path] = "could not read file " + request.path + ": " +
+                                                      std::strerror(request.error);
+
+                        continue;
+                    }
+
+                    ListHandler handler;
+
+                    try {
+                        ParseStatistics statistics;
+                        BasicKeyFileTokenizer<MimeAppsPolicy> tokenizer(statistics);
+                        tokenizer.parse(request.contents.data(), request.contents.size(), handler);
+                    } catch (const ParseError& e) {
+                        newErrors[request.path] = e.what();
+                        continue;
+                    }
+
+                    // removals apply to the associations of the same list, too
+                    for (const auto& entry : handler.removed) {
+                        auto& ids = removed[std::string(entry.first)];
+
+                        for (const auto id : splitList(entry.second))
+                            ids.emplace(id);
+                    }
+
+                    for (const auto& entry : handler.added) {
+                        for (const auto id : splitList(entry.second)) {
+                            if (isInstalled(id))
+                                associate(entry.first, id);
+                        }
+                    }
+
+                    for (const auto& entry : handler.defaults) {
+                        if (newDefaults.find(entry.first) != newDefaults.end())
+                            continue;
+
+                        for (const auto id : splitList(entry.second)) {
+                            if (isInstalled(id)) {
+                                newDefaults.emplace(entry.first, id);
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                // the applications' own associations come last
+                for (const auto& application : applications.files()) {
+                    for (const auto mimeType : application.second->schema().mimeType)
+                        associate(mimeType, application.first);
+                }
+
+                for (const auto& association : newAssociations) {
+                    if (!association.second.empty())
+                        newDefaults.try_emplace(association.first, association.second.front());
+                }
+
+                defaults = std::move(newDefaults);
+                associations = std::move(newAssociations);
+                errors = std::move(newErrors);
+            }
+        };
+
+        MimeAppsResolver::MimeAppsResolver() : d(std::make_shared<PrivateData>()) {}
+
+        MimeAppsResolver::MimeAppsResolver(std::vector<std::string> listPaths, DesktopFileOverlay applications) :
+            MimeAppsResolver() {
+            d->listPaths = std::move(listPaths);
+            d->applications = std::move(applications);
+            load();
+        }
+
+        MimeAppsResolver::MimeAppsResolver(const MimeAppsResolver& other) : MimeAppsResolver() {
+            d->copyData(other.d);
+        }
+
+        MimeAppsResolver& MimeAppsResolver::operator=(const MimeAppsResolver& other) {
+            if (this != &other) {
+                d = std::make_shared<PrivateData>();
+                d->copyData(other.d);
+            }
+
+            return *this;
+        }
+
+        MimeAppsResolver& MimeAppsResolver::operator=(MimeAppsResolver&& other) noexcept {
+            if (this != &other) {
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        std::vector<std::string> MimeAppsResolver::listPaths() const {
+            return d->listPaths;
+        }
+
+        std::string MimeAppsResolver::defaultApplication(std::string_view mimeType) const {
+            const auto it = d->defaults.find(mimeType);
+            return it == d->defaults.end() ? std::string() : it->second;
+        }
+
+        std::vector<std::string> MimeAppsResolver::applications(std::string_view mimeType) const {
+            const auto it = d->associations.find(mimeType);
+            return it == d->associations.end() ? std::vector<std::string>() : it->second;
+        }
+
+        MimeAppsResolver::errors_t MimeAppsResolver::errors() const {
+            return d->errors;
+        }
+
+        void MimeAppsResolver::load() {
+            d->load();
+        }
+
+        std::vector<std::string> MimeAppsResolver::defaultListPaths() {
+            const auto home = getEnv("HOME", "");
+
+            // desktop names are used in lowercase in the file names, e.g., gnome-mimeapps.list
+            std::vector<std::string> desktops;
+            for (auto desktop : splitPathList(getEnv("XDG_CURRENT_DESKTOP", ""))) {
+                std::transform(desktop.begin(), desktop.end(), desktop.begin(),
+                               [](unsigned char c) { return std::tolower(c); });
+                desktops.emplace_back(std::move(desktop));
+            }
+
+            std::vector<std::string> paths;
+
+            auto addLists = [&](const std::string& directory, bool legacyDefaults) {
+                for (const auto& desktop : desktops)
+                    paths.emplace_back(directory + "/" + desktop + "-mimeapps.list");
+
+                paths.emplace_back(directory + "/mimeapps.list");
+
+                if (legacyDefaults)
+                    paths.emplace_back(directory + "/defaults.list");
+            };
+
+            std::vector<std::string> configDirectories = {getEnv("XDG_CONFIG_HOME", home + "/.config")};
+            for (const auto& directory : splitPathList(getEnv("XDG_CONFIG_DIRS", "/etc/xdg")))
+                configDirectories.emplace_back(directory);
+
+            for (const auto& directory : configDirectories)
+                addLists(directory, false);
+
+            std::vector<std::string> dataDirectories = {getEnv("XDG_DATA_HOME", home + "/.local/share")};
+            for (const auto& directory : splitPathList(getEnv("XDG_DATA_DIRS", "/usr/local/share:/usr/share")))
+                dataDirectories.emplace_back(directory);
+
+            for (const auto& directory : dataDirectories)
+                addLists(directory + "/applications", true);
+
+            return paths;
+        }
+    }
+}
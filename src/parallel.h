@@ -0,0 +1,80 @@
+#pragma once
+
+// system headers
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        /**
+         * Number of threads to use for CPU-bound work.
+         * @return number of hardware threads, at least 1
+         */
+        static inline size_t defaultThreadCount() {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /**
+         * Call function for every index in [0, count) on a pool of worker threads.
+         *
+         * The indices are handed out dynamically, so workers which finish early pick up more work. Runs on the calling
+         * thread if only one thread is requested or if there is just a single item. If the function throws, the
+         * remaining items are skipped, and the first exception is rethrown on the calling thread.
+         *
+         * @param count number of items
+         * @param threads maximum number of threads to use
+         * @param function callable taking the index of an item
+         */
+        template<typename Function>
+        void parallelFor(size_t count, size_t threads, const Function& function) {
+            threads = std::min(threads, count);
+
+            if (threads <= 1) {
+                for (size_t i = 0; i < count; ++i)
+                    function(i);
+
+                return;
+            }
+
+            std::atomic<size_t> nextIndex{0};
+            std::atomic<bool> failed{false};
+            std::exception_ptr firstError;
+            std::mutex errorMutex;
+
+            auto worker = [&]() {
+                size_t index;
+
+                while (!failed && (index = nextIndex++) < count) {
+                    try {
+                        function(index);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+
+                        if (!failed.exchange(true))
+                            firstError = std::current_exception();
+                    }
+                }
+            };
+
+            std::vector<std::thread> pool;
+            pool.reserve(threads - 1);
+
+            for (size_t i = 1; i < threads; ++i)
+                pool.emplace_back(worker);
+
+            // the calling thread does its share of the work as well
+            worker();
+
+            for (auto& thread : pool)
+                thread.join();
+
+            if (firstError)
+                std::rethrow_exception(firstError);
+        }
+    }
+}
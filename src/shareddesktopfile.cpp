@@ -0,0 +1,73 @@
+// system headers
+#include <atomic>
+
+// local headers
+#include "linuxdeploy/desktopfile/shareddesktopfile.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        class SharedDesktopFile::PrivateData {
+        public:
+            // the snapshot is swapped atomically, therefore readers never wait for writers
+            std::atomic<snapshot_t> snapshot;
+
+        public:
+            PrivateData() : snapshot(std::make_shared<const DesktopFile>()) {}
+
+            void copyData(const std::shared_ptr<PrivateData>& other) {
+                snapshot.store(other->snapshot.load());
+            }
+        };
+
+        SharedDesktopFile::SharedDesktopFile() : d(std::make_shared<PrivateData>()) {}
+
+        SharedDesktopFile::SharedDesktopFile(DesktopFile file) : SharedDesktopFile() {
+            publish(std::move(file));
+        }
+
+        SharedDesktopFile::SharedDesktopFile(const SharedDesktopFile& other) : SharedDesktopFile() {
+            d->copyData(other.d);
+        }
+
+        SharedDesktopFile& SharedDesktopFile::operator=(const SharedDesktopFile& other) {
+            if (this != &other) {
+                d->copyData(other.d);
+            }
+
+            return *this;
+        }
+
+        SharedDesktopFile& SharedDesktopFile::operator=(SharedDesktopFile&& other) noexcept {
+            if (this != &other) {
+                d = other.d;
+                other.d = nullptr;
+            }
+
+            return *this;
+        }
+
+        SharedDesktopFile::snapshot_t SharedDesktopFile::snapshot() const {
+            return d->snapshot.load();
+        }
+
+        void SharedDesktopFile::publish(DesktopFile file) {
+            d->snapshot.store(std::make_shared<const DesktopFile>(std::move(file)));
+        }
+
+        SharedDesktopFile::snapshot_t SharedDesktopFile::update(const std::function<void(DesktopFile&)>& modify) {
+            auto expected = d->snapshot.load();
+
+            while (true) {
+                // copies are deep, so the modifications are invisible to the readers of the old snapshot
+                auto modified = std::make_shared<DesktopFile>(*expected);
+                modify(*modified);
+
+                snapshot_t desired = std::move(modified);
+
+                // on failure, expected is set to the snapshot published by the other thread
+                if (d->snapshot.compare_exchange_strong(expected, desired))
+                    return desired;
+            }
+        }
+    }
+}
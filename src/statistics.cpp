@@ -0,0 +1,137 @@
+// system headers
+#include <atomic>
+
+// local headers
+#include "linuxdeploy/desktopfile/statistics.h"
+#include "statisticsutil.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace {
+            // relaxed ordering is sufficient, the counters are independent of each other
+            void add(std::atomic<uint64_t>& counter, uint64_t value) {
+                if (value != 0)
+                    counter.fetch_add(value, std::memory_order_relaxed);
+            }
+
+            uint64_t get(const std::atomic<uint64_t>& counter) {
+                return counter.load(std::memory_order_relaxed);
+            }
+
+            struct GlobalParseStatistics {
+                std::atomic<uint64_t> bytesRead{0};
+                std::atomic<uint64_t> lines{0};
+                std::atomic<uint64_t> sections{0};
+                std::atomic<uint64_t> entries{0};
+                std::atomic<uint64_t> localizedKeys{0};
+                std::atomic<uint64_t> allocations{0};
+                std::atomic<uint64_t> ioNanoseconds{0};
+                std::atomic<uint64_t> tokenizeNanoseconds{0};
+                std::atomic<uint64_t> validationNanoseconds{0};
+                std::atomic<uint64_t> insertionNanoseconds{0};
+            } globalParse;
+
+            struct GlobalSerializeStatistics {
+                std::atomic<uint64_t> bytesWritten{0};
+                std::atomic<uint64_t> sections{0};
+                std::atomic<uint64_t> entries{0};
+                std::atomic<uint64_t> allocations{0};
+                std::atomic<uint64_t> formatNanoseconds{0};
+                std::atomic<uint64_t> ioNanoseconds{0};
+            } globalSerialize;
+        }
+
+        ParseStatistics& ParseStatistics::operator+=(const ParseStatistics& other) {
+            bytesRead += other.bytesRead;
+            lines += other.lines;
+            sections += other.sections;
+            entries += other.entries;
+            localizedKeys += other.localizedKeys;
+            allocations += other.allocations;
+            ioNanoseconds += other.ioNanoseconds;
+            tokenizeNanoseconds += other.tokenizeNanoseconds;
+            validationNanoseconds += other.validationNanoseconds;
+            insertionNanoseconds += other.insertionNanoseconds;
+            return *this;
+        }
+
+        SerializeStatistics& SerializeStatistics::operator+=(const SerializeStatistics& other) {
+            bytesWritten += other.bytesWritten;
+            sections += other.sections;
+            entries += other.entries;
+            allocations += other.allocations;
+            formatNanoseconds += other.formatNanoseconds;
+            ioNanoseconds += other.ioNanoseconds;
+            return *this;
+        }
+
+        bool statisticsEnabled() {
+#ifdef LINUXDEPLOY_DESKTOPFILE_ENABLE_STATISTICS
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        ParseStatistics globalParseStatistics() {
+            ParseStatistics rv;
+            rv.bytesRead = get(globalParse.bytesRead);
+            rv.lines = get(globalParse.lines);
+            rv.sections = get(globalParse.sections);
+            rv.entries = get(globalParse.entries);
+            rv.localizedKeys = get(globalParse.localizedKeys);
+            rv.allocations = get(globalParse.allocations);
+            rv.ioNanoseconds = get(globalParse.ioNanoseconds);
+            rv.tokenizeNanoseconds = get(globalParse.tokenizeNanoseconds);
+            rv.validationNanoseconds = get(globalParse.validationNanoseconds);
+            rv.insertionNanoseconds = get(globalParse.insertionNanoseconds);
+            return rv;
+        }
+
+        SerializeStatistics globalSerializeStatistics() {
+            SerializeStatistics rv;
+            rv.bytesWritten = get(globalSerialize.bytesWritten);
+            rv.sections = get(globalSerialize.sections);
+            rv.entries = get(globalSerialize.entries);
+            rv.allocations = get(globalSerialize.allocations);
+            rv.formatNanoseconds = get(globalSerialize.formatNanoseconds);
+            rv.ioNanoseconds = get(globalSerialize.ioNanoseconds);
+            return rv;
+        }
+
+        void resetGlobalStatistics() {
+            for (auto* counter : {
+                &globalParse.bytesRead, &globalParse.lines, &globalParse.sections, &globalParse.entries,
+                &globalParse.localizedKeys, &globalParse.allocations, &globalParse.ioNanoseconds,
+                &globalParse.tokenizeNanoseconds, &globalParse.validationNanoseconds,
+                &globalParse.insertionNanoseconds,
+                &globalSerialize.bytesWritten, &globalSerialize.sections, &globalSerialize.entries,
+                &globalSerialize.allocations, &globalSerialize.formatNanoseconds, &globalSerialize.ioNanoseconds,
+            }) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void addToGlobalStatistics(const ParseStatistics& statistics) {
+            add(globalParse.bytesRead, statistics.bytesRead);
+            add(globalParse.lines, statistics.lines);
+            add(globalParse.sections, statistics.sections);
+            add(globalParse.entries, statistics.entries);
+            add(globalParse.localizedKeys, statistics.localizedKeys);
+            add(globalParse.allocations, statistics.allocations);
+            add(globalParse.ioNanoseconds, statistics.ioNanoseconds);
+            add(globalParse.tokenizeNanoseconds, statistics.tokenizeNanoseconds);
+            add(globalParse.validationNanoseconds, statistics.validationNanoseconds);
+            add(globalParse.insertionNanoseconds, statistics.insertionNanoseconds);
+        }
+
+        void addToGlobalStatistics(const SerializeStatistics& statistics) {
+            add(globalSerialize.bytesWritten, statistics.bytesWritten);
+            add(globalSerialize.sections, statistics.sections);
+            add(globalSerialize.entries, statistics.entries);
+            add(globalSerialize.allocations, statistics.allocations);
+            add(globalSerialize.formatNanoseconds, statistics.formatNanoseconds);
+            add(globalSerialize.ioNanoseconds, statistics.ioNanoseconds);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+// system headers
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// local headers
+#include "linuxdeploy/desktopfile/statistics.h"
+
+// evaluates the given statements only if the library is built with statistics support
+// the statements are not even compiled otherwise, so they don't cost anything
+#ifdef LINUXDEPLOY_DESKTOPFILE_ENABLE_STATISTICS
+#define LD_DESKTOPFILE_STATS(...) do { __VA_ARGS__; } while (false)
+#else
+#define LD_DESKTOPFILE_STATS(...) do {} while (false)
+#endif
+
+namespace linuxdeploy {
+    namespace desktopfile {
+#ifdef LINUXDEPLOY_DESKTOPFILE_ENABLE_STATISTICS
+        /**
+         * Measures the time spent in consecutive phases. Every call to lap() attributes the time passed since the
+         * previous call to the given counter, which requires only a single clock read per phase.
+         */
+        class PhaseClock {
+        private:
+            std::chrono::steady_clock::time_point last;
+
+        public:
+            PhaseClock() : last(std::chrono::steady_clock::now()) {}
+
+            void lap(uint64_t& nanoseconds) {
+                const auto now = std::chrono::steady_clock::now();
+                nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count();
+                last = now;
+            }
+        };
+#else
+        /**
+         * No-op replacement, calls are removed entirely by the compiler.
+         */
+        class PhaseClock {
+        public:
+            void lap(uint64_t&) {}
+        };
+#endif
+
+        /**
+         * Number of heap allocations a string needed to store its data.
+         * @param s string to check
+         * @return 1 if the string does not fit into the small string buffer, 0 otherwise
+         */
+        template<typename Allocator>
+        uint64_t stringAllocations(const std::basic_string<char, std::char_traits<char>, Allocator>& s) {
+            static const auto smallStringCapacity = std::string().capacity();
+            return s.capacity() > smallStringCapacity ? 1 : 0;
+        }
+
+        // add statistics of a single operation to the process-wide statistics
+        void addToGlobalStatistics(const ParseStatistics& statistics);
+        void addToGlobalStatistics(const SerializeStatistics& statistics);
+    }
+}
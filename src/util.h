@@ -2,7 +2,10 @@
 
 // system headers
 #include <algorithm>
+#include <cstdint>
+#include <sstream>
 #include <string>
+#include <string_view>
 
 // local headers
 #include "linuxdeploy/desktopfile/exceptions.h"
@@ -48,6 +51,21 @@ namespace linuxdeploy {
             return rtrim(s, to_trim) && ltrim_result;
         }
 
+        /**
+         * Remove leading and trailing characters from string view without copying the data.
+         * @param s view to trim
+         * @param to_trim character to remove
+         * @return trimmed view
+         */
+        static inline std::string_view trimView(std::string_view s, char to_trim = ' ') {
+            const auto begin = s.find_first_not_of(to_trim);
+
+            if (begin == std::string_view::npos)
+                return {};
+
+            return s.substr(begin, s.find_last_not_of(to_trim) - begin + 1);
+        }
+
         /**
          * Relatively inefficient implementation of a C++ lexical cast.
          * @tparam To type to convert to
@@ -73,5 +91,37 @@ namespace linuxdeploy {
 
             return to;
         }
+
+        /**
+         * Finalizer of the SplitMix64 generator, spreads the bits of an integer over the whole value.
+         * @param value value to mix
+         * @return mixed value
+         */
+        static inline uint64_t mix64(uint64_t value) {
+            value ^= value >> 30;
+            value *= 0xbf58476d1ce4e5b9ULL;
+            value ^= value >> 27;
+            value *= 0x94d049bb133111ebULL;
+            value ^= value >> 31;
+            return value;
+        }
+
+        /**
+         * 64-bit FNV-1a hash. Unlike std::hash, the result is the same across processes and platforms.
+         * @param data data to hash
+         * @param size length of data
+         * @param seed value to start with, allows chaining multiple strings
+         * @return hash value
+         */
+        static inline uint64_t fnv1a64(const char* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL) {
+            auto hash = seed;
+
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= static_cast<unsigned char>(data[i]);
+                hash *= 0x100000001b3ULL;
+            }
+
+            return hash;
+        }
     }
 }
@@ -0,0 +1,59 @@
+// system headers
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// local headers
+#include "linuxdeploy/desktopfile/validation.h"
+
+namespace linuxdeploy {
+    namespace desktopfile {
+        namespace validation {
+            bool isValidUtf8Blocks(const char* data, size_t size) {
+                const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+#if defined(__SSE2__)
+                constexpr size_t blockSize = 16;
+#else
+                constexpr size_t blockSize = 8;
+#endif
+
+                uint8_t state = utf8::Accept;
+                size_t i = 0;
+
+                while (i < size) {
+                    // sequences never start in the middle of an ASCII block, so blocks are only skipped between them
+                    if (state == utf8::Accept) {
+                        while (i + blockSize <= size) {
+#if defined(__SSE2__)
+                            const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+                            if (_mm_movemask_epi8(block) != 0)
+                                break;
+#else
+                            uint64_t block;
+                            std::memcpy(&block, bytes + i, sizeof(block));
+                            if ((block & 0x8080808080808080ull) != 0)
+                                break;
+#endif
+                            i += blockSize;
+                        }
+                    }
+
+                    // the rest of the block, or the remaining bytes at the end
+                    const auto blockEnd = i + blockSize < size ? i + blockSize : size;
+
+                    for (; i < blockEnd; ++i)
+                        state = utf8::transitions[state][utf8::classes[bytes[i]]];
+
+                    if (state == utf8::Reject)
+                        return false;
+                }
+
+                return state == utf8::Accept;
+            }
+        }
+    }
+}
@@ -0,0 +1,142 @@
+// system headers
+#include <cstdlib>
+#include <new>
+
+// local headers
+#include "allocationcounter.h"
+
+namespace {
+    // thread local, so allocations made by other threads are not counted
+    thread_local size_t activeCounters = 0;
+    thread_local size_t allocationCount = 0;
+    thread_local size_t allocatedBytes = 0;
+
+    void* countedAllocate(size_t size) {
+        if (activeCounters > 0) {
+            ++allocationCount;
+            allocatedBytes += size;
+        }
+
+        // malloc(0) may return a null pointer, operator new must not
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* countedAllocateAligned(size_t size, std::align_val_t alignment) {
+        if (activeCounters > 0) {
+            ++allocationCount;
+            allocatedBytes += size;
+        }
+
+        // aligned_alloc requires the size to be a multiple of the alignment
+        const auto align = static_cast<size_t>(alignment);
+        const auto alignedSize = ((size == 0 ? 1 : size) + align - 1) / align * align;
+        return std::aligned_alloc(align, alignedSize);
+    }
+}
+
+AllocationCounter::AllocationCounter() : _initialAllocations(allocationCount), _initialBytes(allocatedBytes) {
+    ++activeCounters;
+}
+
+AllocationCounter::~AllocationCounter() {
+    --activeCounters;
+}
+
+size_t AllocationCounter::allocations() const {
+    return allocationCount - _initialAllocations;
+}
+
+size_t AllocationCounter::bytes() const {
+    return allocatedBytes - _initialBytes;
+}
+
+void* operator new(size_t size) {
+    auto* ptr = countedAllocate(size);
+
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+// the aligned versions are used by, e.g., std::pmr::new_delete_resource()
+void* operator new(size_t size, std::align_val_t alignment) {
+    auto* ptr = countedAllocateAligned(size, alignment);
+
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// system headers
+#include <cstddef>
+
+/*
+ * Counts the heap allocations made through the global operator new on the current thread while the counter exists.
+ *
+ * The replacement allocation functions are defined in allocationcounter.cpp. They forward to malloc() and free(),
+ * and only count while at least one counter is active on the calling thread, so they do not affect other tests.
+ */
+class AllocationCounter {
+private:
+    size_t _initialAllocations;
+    size_t _initialBytes;
+
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+public:
+    // number of allocations made since the counter was created
+    size_t allocations() const;
+
+    // number of bytes requested since the counter was created
+    size_t bytes() const;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+// system headers
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Temporary directory which is removed recursively once the object goes out of scope.
+ */
+class TempDirectory {
+private:
+    std::string _path;
+
+public:
+    TempDirectory() {
+        char pattern[] = "/tmp/linuxdeploy-desktopfile-test-XXXXXX";
+
+        if (mkdtemp(pattern) == nullptr)
+            throw std::runtime_error("failed to create temporary directory");
+
+        _path = pattern;
+    }
+
+    ~TempDirectory() {
+        nftw(_path.c_str(), [](const char* path, const struct stat*, int, struct FTW*) {
+            return ::remove(path);
+        }, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+
+public:
+    const std::string& path() const {
+        return _path;
+    }
+
+    // create a file relative to the temporary directory, including missing parent directories
+    // returns the absolute path to the file
+    std::string writeFile(const std::string& relativePath, const std::string& contents) const {
+        for (auto pos = relativePath.find('/'); pos != std::string::npos; pos = relativePath.find('/', pos + 1))
+            mkdir((_path + "/" + relativePath.substr(0, pos)).c_str(), 0755);
+
+        const auto path = _path + "/" + relativePath;
+
+        std::ofstream ofs(path);
+        ofs << contents;
+
+        return path;
+    }
+};
@@ -0,0 +1,272 @@
+// system headers
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfile.h"
+#include "allocationcounter.h"
+
+using namespace linuxdeploy::desktopfile;
+
+/*
+ * Allocation budgets for common operations.
+ *
+ * The budgets are the numbers measured on x86_64 with libstdc++, plus a small tolerance. If a change reduces the
+ * number of allocations, please lower the budgets accordingly. If a change needs more allocations, the tests fail on
+ * purpose, and the budgets may only be raised if the increase is justified.
+ *
+ * Other standard libraries and architectures differ in node sizes and the size of the small string buffer, therefore
+ * the number of allocations is checked against a worst case derived from the size of the file there: parsing may
+ * allocate a constant number of times per section and entry, but not per line or per character. The number of bytes
+ * is checked on the measured platform only. Operations which need not allocate at all are required not to
+ * everywhere.
+ */
+#if defined(__GLIBCXX__) && defined(__x86_64__)
+static constexpr bool measuredPlatform = true;
+#else
+static constexpr bool measuredPlatform = false;
+#endif
+
+class AllocationTest : public ::testing::Test {
+public:
+    DesktopFile file;
+
+    // tolerance of the measured budgets
+    static constexpr size_t allocationTolerance = 2;
+    static constexpr size_t byteTolerancePercent = 5;
+
+    // worst case for every entry: map node, entry data, key (twice) and value, if neither fits the small string buffer
+    static constexpr size_t allocationsPerEntry = 5;
+
+    // map node, name, and growing the section's hash table
+    static constexpr size_t allocationsPerSection = 4;
+
+    // the file's and the reader's data, and the hash table of the sections
+    static constexpr size_t fixedAllocations = 8;
+
+    size_t entryCount() const {
+        size_t count = 0;
+
+        for (const auto& section : file.sections())
+            count += section.second.size();
+
+        return count;
+    }
+
+    size_t parseBudget() const {
+        return allocationsPerEntry * entryCount() + allocationsPerSection * file.sections().size() + fixedAllocations;
+    }
+
+    // the measured number of allocations on the measured platform, the given worst case elsewhere
+    static size_t allocationBudget(size_t measured, size_t worstCase) {
+        return measuredPlatform ? measured + allocationTolerance : worstCase;
+    }
+
+    // the measured number of bytes on the measured platform, unlimited elsewhere
+    static size_t byteBudget(size_t measured) {
+        return measuredPlatform ? measured + measured * byteTolerancePercent / 100 : SIZE_MAX;
+    }
+
+private:
+    void SetUp() override {
+        file = DesktopFile(DESKTOP_FILE_PATH);
+    }
+
+    void TearDown() override {}
+};
+
+/*
+ * Memory resource which counts the allocations made through it, and forwards them to the global heap.
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST_F(AllocationTest, testParseBudget) {
+    AllocationCounter counter;
+
+    DesktopFile parsedFile(DESKTOP_FILE_PATH);
+
+    // the stream and line buffers come on top
+    EXPECT_LE(counter.allocations(), allocationBudget(54, parseBudget() + 4));
+    EXPECT_LE(counter.bytes(), byteBudget(12313));
+}
+
+TEST_F(AllocationTest, testParseBufferBudget) {
+    std::stringstream contents;
+    file.save(contents);
+    const auto buffer = contents.str();
+
+    size_t streamAllocations, streamBytes;
+
+    {
+        std::stringstream ss(buffer);
+        AllocationCounter counter;
+        DesktopFile parsedFile(ss);
+        streamAllocations = counter.allocations();
+        streamBytes = counter.bytes();
+    }
+
+    AllocationCounter counter;
+
+    DesktopFile parsedFile(buffer.data(), buffer.size());
+
+    EXPECT_LE(counter.allocations(), allocationBudget(48, parseBudget()));
+    EXPECT_LE(counter.bytes(), byteBudget(3906));
+
+    // neither stream buffers nor line buffers are needed
+    EXPECT_LT(counter.allocations(), streamAllocations);
+    EXPECT_LT(counter.bytes(), streamBytes);
+}
+
+TEST_F(AllocationTest, testParseIntoMemoryResourceBudget) {
+    // the resource must not fall back to the global heap
+    static std::byte buffer[64 * 1024];
+    std::pmr::monotonic_buffer_resource pool(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+    // the parsed data must not be allocated from the default resource either
+    CountingResource defaultResource;
+    auto* previousDefaultResource = std::pmr::set_default_resource(&defaultResource);
+
+    AllocationCounter counter;
+
+    DesktopFile parsedFile(DESKTOP_FILE_PATH, &pool);
+    const auto allocations = counter.allocations();
+    const auto bytes = counter.bytes();
+
+    std::pmr::set_default_resource(previousDefaultResource);
+
+    EXPECT_EQ(parsedFile, file);
+    EXPECT_EQ(defaultResource.allocations, 0);
+
+    // only the path and the stream and line buffers are left on the global heap, the nodes, the entries' data and
+    // all keys and values come from the pool
+    EXPECT_LE(allocations, allocationBudget(6, fixedAllocations));
+    EXPECT_LE(bytes, byteBudget(8407));
+}
+
+TEST_F(AllocationTest, testParseBufferIntoMemoryResourceWithoutGlobalAllocations) {
+    // keys and values too long for the small string buffer
+    std::string buffer = "[Desktop Entry]\n";
+
+    for (int i = 0; i < 100; ++i)
+        buffer += "X-A-Rather-Long-Key-" + std::to_string(i) + "=" + std::string(100, 'x') + "\n";
+
+    static std::byte poolBuffer[256 * 1024];
+    std::pmr::monotonic_buffer_resource pool(poolBuffer, sizeof(poolBuffer), std::pmr::null_memory_resource());
+
+    CountingResource defaultResource;
+    auto* previousDefaultResource = std::pmr::set_default_resource(&defaultResource);
+
+    size_t allocations;
+
+    {
+        AllocationCounter counter;
+
+        DesktopFile parsedFile(buffer.data(), buffer.size(), &pool);
+        EXPECT_EQ(parsedFile.findEntry("Desktop Entry", "X-A-Rather-Long-Key-99")->value().size(), 100);
+
+        allocations = counter.allocations();
+    }
+
+    std::pmr::set_default_resource(previousDefaultResource);
+
+    EXPECT_EQ(allocations, 0);
+    EXPECT_EQ(defaultResource.allocations, 0);
+}
+
+TEST_F(AllocationTest, testEntryExistsBudget) {
+    AllocationCounter counter;
+
+    // section name and key fit into the small string buffer
+    EXPECT_TRUE(file.entryExists("Desktop Entry", "Name"));
+    EXPECT_FALSE(file.entryExists("Desktop Entry", "NoSuchKey"));
+
+    EXPECT_EQ(counter.allocations(), 0);
+}
+
+TEST_F(AllocationTest, testLookupWithoutTemporaryStrings) {
+    // a section name too long for the small string buffer
+    static const std::string_view buffer = "[Desktop Action AnotherSimpleAction]";
+    const auto section = buffer.substr(1, buffer.size() - 2);
+
+    AllocationCounter counter;
+
+    EXPECT_TRUE(file.entryExists("Desktop Action AnotherSimpleAction", "Icon"));
+    EXPECT_TRUE(file.entryExists(section, "Icon"));
+    EXPECT_FALSE(file.entryExists(section, "X-A-Rather-Long-Key-Which-Does-Not-Exist"));
+    EXPECT_FALSE(file.entryExists("X-A-Rather-Long-Section-Which-Does-Not-Exist", "Icon"));
+
+    ASSERT_NE(file.findEntry(section, "Icon"), nullptr);
+    EXPECT_EQ(file.findEntry(section, "Icon")->value(), "simple_icon");
+    EXPECT_NE(file.findSection(section), nullptr);
+
+    EXPECT_EQ(counter.allocations(), 0);
+}
+
+TEST_F(AllocationTest, testGetEntryBudget) {
+    DesktopFileEntry entry;
+
+    AllocationCounter counter;
+
+    for (int i = 0; i < 10; ++i)
+        EXPECT_TRUE(file.getEntry("Desktop Entry", "Name", entry));
+
+    // lookups of non-existing keys must not allocate at all
+    EXPECT_FALSE(file.getEntry("Desktop Entry", "NoSuchKey", entry));
+
+    // the entry's data and value, the key fits into the small string buffer
+    EXPECT_LE(counter.allocations(), allocationBudget(10 * 2, 10 * 3));
+    EXPECT_LE(counter.bytes(), byteBudget(1430));
+}
+
+TEST_F(AllocationTest, testParseStringListBudget) {
+    DesktopFileEntry entry;
+    ASSERT_TRUE(file.getEntry("Desktop Entry", "Actions", entry));
+
+    AllocationCounter counter;
+
+    const auto list = entry.parseStringList();
+    EXPECT_EQ(list.size(), 2);
+
+    // the items, and growing the vector
+    EXPECT_LE(counter.allocations(), allocationBudget(5, 2 * list.size() + 1));
+    EXPECT_LE(counter.bytes(), byteBudget(181));
+}
+
+TEST_F(AllocationTest, testSaveRoundTripBudget) {
+    AllocationCounter counter;
+
+    std::stringstream ss;
+    file.save(ss);
+
+    // the formatted contents and the stream's buffers, the keys and values are not copied
+    const auto saveAllocations = counter.allocations();
+    EXPECT_LE(saveAllocations, allocationBudget(4, fixedAllocations));
+    EXPECT_LE(counter.bytes(), byteBudget(1623));
+
+    DesktopFile roundTrip(ss);
+
+    EXPECT_LE(counter.allocations() - saveAllocations, allocationBudget(50, parseBudget() + 4));
+    EXPECT_LE(counter.bytes(), byteBudget(5621));
+}
@@ -0,0 +1,87 @@
+// system headers
+#include <thread>
+#include <vector>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopentryschema.h"
+#include "allocationcounter.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopEntrySchemaTest : public ::testing::Test {
+public:
+    DesktopFile file;
+
+private:
+    void SetUp() override {
+        file = DesktopFile(DESKTOP_FILE_PATH);
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(DesktopEntrySchemaTest, testConversions) {
+    const auto& schema = file.schema();
+
+    EXPECT_EQ(schema.type, DesktopEntrySchema::Type::Application);
+    EXPECT_FALSE(schema.terminal.has_value());
+    EXPECT_EQ(schema.mimeType, DesktopEntrySchema::list_t{"image/x-foo"});
+    EXPECT_EQ(schema.actions, (DesktopEntrySchema::list_t{"SimpleAction", "AnotherSimpleAction"}));
+    EXPECT_TRUE(schema.categories.empty());
+
+    file.setEntry("Desktop Entry", DesktopFileEntry("Terminal", "true"));
+    file.setEntry("Desktop Entry", DesktopFileEntry("NoDisplay", "false"));
+    file.setEntry("Desktop Entry", DesktopFileEntry("Hidden", "yes"));
+    file.setEntry("Desktop Entry", DesktopFileEntry("Type", "Service"));
+    file.setEntry("Desktop Entry", DesktopFileEntry("Categories", "Utility;;Development"));
+
+    const auto& modified = file.schema();
+    EXPECT_EQ(modified.terminal, true);
+    EXPECT_EQ(modified.noDisplay, false);
+    EXPECT_FALSE(modified.hidden.has_value());
+    EXPECT_EQ(modified.type, DesktopEntrySchema::Type::Unknown);
+    EXPECT_EQ(modified.categories, (DesktopEntrySchema::list_t{"Utility", "Development"}));
+
+    file.removeEntry("Desktop Entry", "Type");
+    EXPECT_EQ(file.schema().type, DesktopEntrySchema::Type::Missing);
+
+    file.clear();
+    EXPECT_TRUE(file.schema().actions.empty());
+}
+
+TEST_F(DesktopEntrySchemaTest, testValuesAreCached) {
+    const auto* schema = &file.schema();
+
+    AllocationCounter counter;
+    EXPECT_EQ(&file.schema(), schema);
+    EXPECT_EQ(file.schema().type, DesktopEntrySchema::Type::Application);
+    EXPECT_EQ(counter.allocations(), 0);
+
+    // other sections do not affect the schema
+    file.setEntry("Desktop Action SimpleAction", DesktopFileEntry("Name", "Changed"));
+    EXPECT_EQ(&file.schema(), schema);
+
+    // copies have their own values, which refer to their own strings
+    const auto copy = file;
+    EXPECT_NE(copy.schema().actions[0].data(), file.schema().actions[0].data());
+    EXPECT_EQ(copy.schema().actions, file.schema().actions);
+}
+
+TEST_F(DesktopEntrySchemaTest, testConcurrentFirstAccess) {
+    std::vector<const DesktopEntrySchema*> schemas(4);
+    std::vector<std::thread> threads;
+
+    for (auto& schema : schemas)
+        threads.emplace_back([this, &schema]() { schema = &file.schema(); });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto* schema : schemas) {
+        EXPECT_EQ(schema, schemas[0]);
+        EXPECT_EQ(schema->type, DesktopEntrySchema::Type::Application);
+    }
+}
@@ -1,3 +1,7 @@
+// system headers
+#include <memory_resource>
+#include <vector>
+
 // library headers
 #include <gtest/gtest.h>
 
@@ -10,10 +14,10 @@ using namespace linuxdeploy::desktopfile;
 
 class DesktopFileTest : public ::testing::Test {
 public:
-    std::string testType;
-    std::string testName;
-    std::string testExec;
-    std::string testIcon;
+    std::string_view testType;
+    std::string_view testName;
+    std::string_view testExec;
+    std::string_view testIcon;
     std::string testDesktopFile;
 
 private:
@@ -134,6 +138,110 @@ TEST_F(DesktopFileTest, testMoveAssignmentConstructor) {
     assertIsTestDesktopFile(copy);
 }
 
+TEST_F(DesktopFileTest, testMoveConstructor) {
+    std::pmr::monotonic_buffer_resource pool;
+
+    std::stringstream ss;
+    ss << testDesktopFile;
+    DesktopFile file(ss, &pool);
+    const auto* section = file.findSection("Desktop Entry");
+
+    // the data is taken over rather than copied to the default resource
+    DesktopFile moved(std::move(file));
+    EXPECT_EQ(moved.memoryResource(), &pool);
+    EXPECT_EQ(moved.findSection("Desktop Entry"), section);
+    assertIsTestDesktopFile(moved);
+
+    // moved-from files can be assigned to again
+    file = moved;
+    assertIsTestDesktopFile(file);
+}
+
+TEST_F(DesktopFileTest, testMemoryResource) {
+    std::pmr::monotonic_buffer_resource pool;
+
+    std::stringstream ss;
+    ss << testDesktopFile;
+    DesktopFile file(ss, &pool);
+
+    EXPECT_EQ(file.memoryResource(), &pool);
+    EXPECT_EQ(DesktopFile().memoryResource(), std::pmr::get_default_resource());
+    assertIsTestDesktopFile(file);
+
+    // copies use the default resource, unless they are assigned to a file which uses a resource already
+    DesktopFile copy(file);
+    EXPECT_EQ(copy.memoryResource(), std::pmr::get_default_resource());
+    EXPECT_EQ(copy, file);
+
+    DesktopFile pooledCopy(&pool);
+    pooledCopy = copy;
+    EXPECT_EQ(pooledCopy.memoryResource(), &pool);
+    EXPECT_EQ(pooledCopy, file);
+
+    // getEntry copies into the caller's entry, which keeps its own resource
+    file.setEntry("Desktop Entry", DesktopFileEntry("Comment", "A comment long enough to leave the small buffer"));
+    DesktopFileEntry entry;
+    ASSERT_TRUE(file.getEntry("Desktop Entry", "Comment", entry));
+    EXPECT_EQ(entry.get_allocator().resource(), std::pmr::get_default_resource());
+}
+
+TEST_F(DesktopFileTest, testMemoryResourceReleaseAtOnce) {
+    std::pmr::monotonic_buffer_resource pool;
+
+    {
+        // copies would use the default resource, therefore the vector must not reallocate
+        std::vector<DesktopFile> files;
+        files.reserve(1000);
+
+        for (int i = 0; i < 1000; ++i)
+            files.emplace_back(DESKTOP_FILE_PATH, &pool);
+
+        for (const auto& file : files)
+            EXPECT_EQ(file, files.front());
+    }
+
+    // all the sections and entries are released in one operation
+    pool.release();
+}
+
+TEST_F(DesktopFileTest, testFindEntryAndSection) {
+    DesktopFile file(DESKTOP_FILE_PATH);
+
+    const auto* entry = file.findEntry("Desktop Entry", "Name");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->value(), "Simple Application");
+
+    EXPECT_EQ(file.findEntry("Desktop Entry", "NoSuchKey"), nullptr);
+    EXPECT_EQ(file.findEntry("No Such Section", "Name"), nullptr);
+
+    const auto* section = file.findSection("Desktop Action SimpleAction");
+    ASSERT_NE(section, nullptr);
+    EXPECT_EQ(section->size(), 2);
+    EXPECT_EQ(section->at("Exec").value(), "simple_executable --do-it");
+
+    EXPECT_EQ(file.findSection("No Such Section"), nullptr);
+
+    // the accessors must not create sections or entries
+    EXPECT_EQ(file.sections().size(), 3);
+    EXPECT_EQ(file.findSection("Desktop Entry")->size(), 9);
+}
+
+TEST_F(DesktopFileTest, testIterateSections) {
+    DesktopFile file(DESKTOP_FILE_PATH);
+
+    size_t entries = 0;
+
+    for (const auto& section : file.sections()) {
+        for (const auto& pair : section.second) {
+            EXPECT_EQ(pair.first, pair.second.key());
+            EXPECT_EQ(&pair.second, file.findEntry(section.first, pair.first));
+            ++entries;
+        }
+    }
+
+    EXPECT_EQ(entries, 14);
+}
+
 void assertDefaultKeysExistInDesktopFile(const DesktopFile& file) {
     DesktopFileEntry entry;
 
@@ -273,3 +381,134 @@ TEST_F(DesktopFileTest, testInequality) {
 
     EXPECT_NE(file, emptyFile);
 }
+
+TEST_F(DesktopFileTest, testContentHash) {
+    DesktopFile emptyFile;
+    DesktopFile otherEmptyFile;
+    EXPECT_EQ(emptyFile.contentHash(), otherEmptyFile.contentHash());
+
+    std::stringstream ins(testDesktopFile);
+    DesktopFile file(ins);
+    EXPECT_NE(file.contentHash(), emptyFile.contentHash());
+
+    // the order in which entries are added must not matter
+    DesktopFile builtFile;
+    builtFile.setEntry("Desktop Entry", DesktopFileEntry("Icon", testIcon));
+    builtFile.setEntry("Desktop Entry", DesktopFileEntry("Exec", testExec));
+    builtFile.setEntry("Desktop Entry", DesktopFileEntry("Name", testName));
+    builtFile.setEntry("Desktop Entry", DesktopFileEntry("Type", testType));
+    EXPECT_EQ(builtFile.contentHash(), file.contentHash());
+
+    // the path is not part of the hash
+    builtFile.setPath("/some/other/path.desktop");
+    EXPECT_EQ(builtFile.contentHash(), file.contentHash());
+    EXPECT_NE(builtFile, file);
+
+    // changes must be reflected immediately, and reverting them must restore the original hash
+    const auto originalHash = file.contentHash();
+    file.setEntry("Desktop Entry", DesktopFileEntry("Name", "Changed Name"));
+    EXPECT_NE(file.contentHash(), originalHash);
+    file.setEntry("Desktop Entry", DesktopFileEntry("Name", testName));
+    EXPECT_EQ(file.contentHash(), originalHash);
+
+    // moving data between key and value must change the hash
+    DesktopFile first;
+    first.setEntry("Desktop Entry", DesktopFileEntry("ab", "c"));
+    DesktopFile second;
+    second.setEntry("Desktop Entry", DesktopFileEntry("a", "bc"));
+    EXPECT_NE(first.contentHash(), second.contentHash());
+
+    // the same entry in different sections must not result in the same hash
+    DesktopFile third;
+    third.setEntry("Another Section", DesktopFileEntry("ab", "c"));
+    EXPECT_NE(first.contentHash(), third.contentHash());
+
+    // copies share the hash
+    DesktopFile copy(file);
+    EXPECT_EQ(copy.contentHash(), file.contentHash());
+
+    file.clear();
+    EXPECT_EQ(file.contentHash(), emptyFile.contentHash());
+}
+
+TEST_F(DesktopFileTest, testRemoveEntry) {
+    std::stringstream ins(testDesktopFile);
+    DesktopFile file(ins);
+    const auto originalHash = file.contentHash();
+
+    EXPECT_TRUE(file.removeEntry("Desktop Entry", "Icon"));
+    EXPECT_FALSE(file.entryExists("Desktop Entry", "Icon"));
+    EXPECT_NE(file.contentHash(), originalHash);
+
+    EXPECT_FALSE(file.removeEntry("Desktop Entry", "Icon"));
+    EXPECT_FALSE(file.removeEntry("No Such Section", "Icon"));
+
+    // the hash must be the same as if the entry had never been there
+    file.setEntry("Desktop Entry", DesktopFileEntry("Icon", testIcon));
+    EXPECT_EQ(file.contentHash(), originalHash);
+
+    // sections are kept
+    for (const auto& key : {"Name", "Exec", "Icon", "Type"})
+        EXPECT_TRUE(file.removeEntry("Desktop Entry", key));
+
+    EXPECT_NE(file.findSection("Desktop Entry"), nullptr);
+
+    std::stringstream emptySection("[Desktop Entry]\n");
+    EXPECT_EQ(file.contentHash(), DesktopFile(emptySection).contentHash());
+}
+
+TEST_F(DesktopFileTest, testContentHashIncludesEmptySections) {
+    std::stringstream ins;
+    ins << "[Desktop Entry]" << std::endl
+        << "Name=foo" << std::endl
+        << "[Empty Section]" << std::endl;
+    DesktopFile fileWithEmptySection(ins);
+
+    DesktopFile file;
+    file.setEntry("Desktop Entry", DesktopFileEntry("Name", "foo"));
+
+    EXPECT_NE(file.contentHash(), fileWithEmptySection.contentHash());
+    EXPECT_NE(file, fileWithEmptySection);
+}
+
+TEST_F(DesktopFileTest, testMemoryUsage) {
+    const DesktopFile file(DESKTOP_FILE_PATH);
+    const auto usage = file.memoryUsage();
+
+    // every entry's value is longer than the small string buffer
+    const std::string longValue(100, 'x');
+    auto grown = file;
+    grown.setEntry("Desktop Entry", DesktopFileEntry("X-Long", longValue));
+    const auto grownUsage = grown.memoryUsage();
+
+    EXPECT_GT(usage.containerBytes, 0);
+    EXPECT_GT(usage.privateDataBytes, 0);
+    EXPECT_GE(grownUsage.stringBytes, usage.stringBytes + longValue.size());
+    EXPECT_GT(grownUsage.containerBytes, usage.containerBytes);
+    EXPECT_EQ(grownUsage.total(),
+              grownUsage.stringBytes + grownUsage.containerBytes + grownUsage.privateDataBytes);
+
+    EXPECT_LT(DesktopFile().memoryUsage().total(), usage.total());
+}
+
+TEST_F(DesktopFileTest, testCompact) {
+    DesktopFile file(DESKTOP_FILE_PATH);
+    const auto original = file;
+
+    for (int i = 0; i < 1000; ++i)
+        file.setEntry("Desktop Entry", DesktopFileEntry("X-Key-" + std::to_string(i), std::string(50, 'x')));
+
+    for (int i = 0; i < 1000; ++i)
+        file.removeEntry("Desktop Entry", "X-Key-" + std::to_string(i));
+
+    const auto bloated = file.memoryUsage();
+    file.compact();
+    const auto compacted = file.memoryUsage();
+
+    // the bucket array does not shrink when removing entries
+    EXPECT_LT(compacted.containerBytes * 4, bloated.containerBytes);
+    EXPECT_LE(compacted.total(), original.memoryUsage().total());
+
+    EXPECT_EQ(file, original);
+    EXPECT_EQ(file.contentHash(), original.contentHash());
+}
@@ -1,3 +1,8 @@
+// system headers
+#include <sstream>
+#include <string>
+#include <vector>
+
 // library headers
 #include <gtest/gtest.h>
 
@@ -84,3 +89,58 @@ TEST_F(DesktopFileConformanceTest, testBasicFormatCheckKeysUnique) {
         EXPECT_THROW(DesktopFile file(ss), ParseError);
     }
 }
+
+TEST_F(DesktopFileConformanceTest, testValuesValidUtf8) {
+    // ASCII, 2, 3 and 4 byte sequences, including the boundaries, at different positions relative to 16 byte blocks
+    const std::vector<std::string_view> values = {
+        "",
+        "plain ASCII value which is longer than a single block",
+        "Gr\xc3\xbc\xc3\x9f""e",
+        "\xc2\x80\xdf\xbf",
+        "\xe0\xa0\x80\xed\x9f\xbf\xee\x80\x80\xef\xbf\xbf",
+        "\xf0\x90\x80\x80\xf4\x8f\xbf\xbf",
+        "0123456789abcde\xe2\x82\xac""0123456789abcdef",
+        "0123456789abcdef0123456789abcd\xf0\x9f\x98\x80",
+    };
+
+    for (const auto& value : values) {
+        std::stringstream ss;
+        ss << "[Desktop Entry]" << std::endl
+           << "Name=" << value << std::endl;
+
+        DesktopFile file(ss);
+        EXPECT_EQ(file.findEntry("Desktop Entry", "Name")->value(), value);
+    }
+}
+
+TEST_F(DesktopFileConformanceTest, testValuesInvalidUtf8) {
+    const std::vector<std::string> values = {
+        // Latin-1
+        "Gr\xfc\xdf""e",
+        // lone continuation byte
+        "\x80",
+        // overlong encodings
+        "\xc0\xaf",
+        "\xe0\x80\xaf",
+        "\xf0\x80\x80\xaf",
+        // surrogates
+        "\xed\xa0\x80",
+        // beyond U+10FFFF
+        "\xf4\x90\x80\x80",
+        "\xf5\x80\x80\x80",
+        // truncated sequences, at the end and in the middle of a block
+        "0123456789abcdef0123456789abcd\xe2\x82",
+        "0123456789\xe2\x82""abcdef0123456789",
+    };
+
+    for (const auto& value : values) {
+        std::stringstream ss;
+        ss << "[Desktop Entry]" << std::endl
+           << "Name=" << value << std::endl;
+
+        EXPECT_THROW(DesktopFile file(ss), ParseError);
+
+        const auto buffer = ss.str();
+        EXPECT_THROW(DesktopFile(buffer.data(), buffer.size()), ParseError);
+    }
+}
@@ -0,0 +1,171 @@
+// system headers
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilebatch.h"
+#include "../src/batchio.h"
+#include "tempdirectory.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopFileBatchTest : public ::testing::TestWithParam<BatchIOBackend> {
+public:
+    TempDirectory tempDir;
+
+public:
+    static std::string readBack(const std::string& path) {
+        std::ifstream ifs(path);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ss.str();
+    }
+};
+
+TEST_P(DesktopFileBatchTest, testReadFiles) {
+    // larger than a single read, and more files than fit into a single io_uring batch
+    const std::string largeContents(100 * 1024 + 17, 'x');
+
+    std::vector<BatchReadRequest> requests;
+
+    for (int i = 0; i < 600; ++i)
+        requests.emplace_back(tempDir.writeFile("file" + std::to_string(i), "contents " + std::to_string(i)));
+
+    requests.emplace_back(tempDir.writeFile("large", largeContents));
+    requests.emplace_back(tempDir.writeFile("empty", ""));
+    requests.emplace_back(tempDir.path() + "/does-not-exist");
+    requests.emplace_back(tempDir.path());
+
+    readFiles(requests, GetParam());
+
+    for (int i = 0; i < 600; ++i) {
+        EXPECT_EQ(requests[i].error, 0);
+        EXPECT_EQ(requests[i].contents, "contents " + std::to_string(i));
+    }
+
+    EXPECT_EQ(requests[600].error, 0);
+    EXPECT_EQ(requests[600].contents, largeContents);
+
+    EXPECT_EQ(requests[601].error, 0);
+    EXPECT_TRUE(requests[601].contents.empty());
+
+    EXPECT_EQ(requests[602].error, ENOENT);
+    EXPECT_EQ(requests[603].error, EISDIR);
+}
+
+TEST_P(DesktopFileBatchTest, testWriteFiles) {
+    const std::string largeContents(100 * 1024 + 17, 'y');
+
+    std::vector<BatchWriteRequest> requests;
+
+    for (int i = 0; i < 300; ++i)
+        requests.emplace_back(tempDir.path() + "/file" + std::to_string(i), "contents " + std::to_string(i));
+
+    // existing files are truncated
+    requests.emplace_back(tempDir.writeFile("existing", largeContents + largeContents), largeContents);
+    requests.emplace_back(tempDir.path() + "/missing-directory/file", "contents");
+
+    writeFiles(requests, GetParam());
+
+    for (int i = 0; i < 300; ++i) {
+        EXPECT_EQ(requests[i].error, 0);
+        EXPECT_EQ(readBack(requests[i].path), "contents " + std::to_string(i));
+    }
+
+    EXPECT_EQ(requests[300].error, 0);
+    EXPECT_EQ(readBack(requests[300].path), largeContents);
+
+    EXPECT_EQ(requests[301].error, ENOENT);
+}
+
+TEST_P(DesktopFileBatchTest, testWriteFilesReplacesFiles) {
+    const auto executable = tempDir.writeFile("executable.desktop", "old");
+    chmod(executable.c_str(), 0750);
+
+    const auto target = tempDir.writeFile("target.desktop", "old");
+    const auto link = tempDir.path() + "/link.desktop";
+    ASSERT_EQ(symlink(target.c_str(), link.c_str()), 0);
+
+    std::vector<BatchWriteRequest> requests;
+    requests.emplace_back(executable, "new");
+    requests.emplace_back(link, "new");
+
+    writeFiles(requests, GetParam());
+
+    EXPECT_EQ(requests[0].error, 0);
+    EXPECT_EQ(readBack(executable), "new");
+
+    struct stat st{};
+    ASSERT_EQ(stat(executable.c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & 07777, 0750);
+
+    // the link is written through
+    EXPECT_EQ(requests[1].error, 0);
+    EXPECT_EQ(readBack(target), "new");
+    ASSERT_EQ(lstat(link.c_str(), &st), 0);
+    EXPECT_TRUE(S_ISLNK(st.st_mode));
+
+    // no temporary files are left behind
+    size_t files = 0;
+    auto* dir = opendir(tempDir.path().c_str());
+
+    while (auto* ent = readdir(dir)) {
+        if (ent->d_name[0] != '.')
+            ++files;
+    }
+
+    closedir(dir);
+    EXPECT_EQ(files, 3);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, DesktopFileBatchTest,
+                         ::testing::Values(BatchIOBackend::IoUring, BatchIOBackend::Threads));
+
+TEST(DesktopFileBatchFunctionsTest, testLoadAndSaveDesktopFiles) {
+    TempDirectory tempDir;
+
+    const auto validPath = tempDir.writeFile("valid.desktop", "[Desktop Entry]\nName=Valid\n");
+    const auto brokenPath = tempDir.writeFile("broken.desktop", "Name=No Section\n");
+    const auto missingPath = tempDir.path() + "/missing.desktop";
+
+    const auto results = loadDesktopFiles({validPath, brokenPath, missingPath});
+    ASSERT_EQ(results.size(), 3);
+
+    ASSERT_NE(results[0].file, nullptr);
+    EXPECT_TRUE(results[0].error.empty());
+    EXPECT_EQ(results[0].file->path(), validPath);
+    EXPECT_EQ(results[0].file->findEntry("Desktop Entry", "Name")->value(), "Valid");
+
+    EXPECT_EQ(results[1].file, nullptr);
+    EXPECT_FALSE(results[1].error.empty());
+
+    EXPECT_EQ(results[2].file, nullptr);
+    EXPECT_FALSE(results[2].error.empty());
+
+    // modify and save the files in bulk
+    std::vector<DesktopFile> files;
+
+    for (int i = 0; i < 10; ++i) {
+        DesktopFile file(*results[0].file);
+        file.setEntry("Desktop Entry", DesktopFileEntry("Name", "Saved " + std::to_string(i)));
+        file.setPath(tempDir.path() + "/saved" + std::to_string(i) + ".desktop");
+        files.emplace_back(file);
+    }
+
+    files.emplace_back(*results[0].file);
+    files.back().setPath(tempDir.path() + "/missing-directory/file.desktop");
+
+    const auto errors = saveDesktopFiles(files);
+    ASSERT_EQ(errors.size(), 1);
+    EXPECT_EQ(errors.count(tempDir.path() + "/missing-directory/file.desktop"), 1);
+
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(DesktopFile(files[i].path()), files[i]);
+}
@@ -0,0 +1,136 @@
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilecollection.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "tempdirectory.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopFileCollectionTest : public ::testing::Test {
+public:
+    TempDirectory tempDir;
+
+    const std::string appA = "[Desktop Entry]\nType=Application\nName=A\nExec=a\n";
+    const std::string appB = "[Desktop Entry]\nType=Application\nName=B\nExec=b\n";
+
+private:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(DesktopFileCollectionTest, testDefaultConstructor) {
+    DesktopFileCollection collection;
+    EXPECT_TRUE(collection.isEmpty());
+    EXPECT_TRUE(collection.directory().empty());
+    EXPECT_THROW(collection.load(), IOError);
+}
+
+TEST_F(DesktopFileCollectionTest, testDirectoryConstructor) {
+    const auto pathA = tempDir.writeFile("a.desktop", appA);
+    const auto pathB = tempDir.writeFile("kde/b.desktop", appB);
+    tempDir.writeFile("not-a-desktop-file.txt", appA);
+
+    DesktopFileCollection collection(tempDir.path() + "/");
+    EXPECT_EQ(collection.directory(), tempDir.path());
+
+    const auto snapshot = collection.snapshot();
+    ASSERT_EQ(snapshot->size(), 2);
+    EXPECT_EQ(snapshot->count(pathA), 1);
+    EXPECT_EQ(snapshot->count(pathB), 1);
+    EXPECT_TRUE(collection.errors().empty());
+
+    EXPECT_THROW(DesktopFileCollection("/no/such/directory"), IOError);
+}
+
+TEST_F(DesktopFileCollectionTest, testFindDesktopFiles) {
+    const auto pathB = tempDir.writeFile("b.desktop", appB);
+    const auto pathA = tempDir.writeFile("sub/dir/a.desktop", appA);
+
+    const std::vector<std::string> expected = {pathB, pathA};
+    EXPECT_EQ(DesktopFileCollection::findDesktopFiles(tempDir.path()), expected);
+}
+
+TEST_F(DesktopFileCollectionTest, testBrokenFilesAreReported) {
+    const auto brokenPath = tempDir.writeFile("broken.desktop", "Name=no section\n");
+    tempDir.writeFile("a.desktop", appA);
+
+    DesktopFileCollection collection(tempDir.path());
+    EXPECT_EQ(collection.snapshot()->size(), 1);
+    EXPECT_EQ(collection.errors().count(brokenPath), 1);
+}
+
+TEST_F(DesktopFileCollectionTest, testUpdateOnlyTouchesGivenPaths) {
+    const auto pathA = tempDir.writeFile("a.desktop", appA);
+    const auto pathB = tempDir.writeFile("b.desktop", appB);
+
+    DesktopFileCollection collection(tempDir.path());
+    const auto oldSnapshot = collection.snapshot();
+
+    // modify one file, add another one, and remove the third one
+    tempDir.writeFile("a.desktop", appB);
+    const auto pathC = tempDir.writeFile("c.desktop", appA);
+    unlink(pathB.c_str());
+
+    const auto changes = collection.update({pathA, pathA, pathB, pathC, "/outside/of/collection.desktop"});
+    EXPECT_EQ(changes.modified, std::vector<std::string>{pathA});
+    EXPECT_EQ(changes.removed, std::vector<std::string>{pathB});
+    EXPECT_EQ(changes.added, std::vector<std::string>{pathC});
+
+    // the old snapshot must not be affected by the update
+    EXPECT_EQ(oldSnapshot->size(), 2);
+    EXPECT_EQ(oldSnapshot->count(pathB), 1);
+
+    const auto newSnapshot = collection.snapshot();
+    EXPECT_EQ(newSnapshot->size(), 2);
+    EXPECT_EQ(newSnapshot->count(pathC), 1);
+
+    DesktopFileEntry entry;
+    ASSERT_TRUE(newSnapshot->at(pathA)->getEntry("Desktop Entry", "Name", entry));
+    EXPECT_EQ(entry.value(), "B");
+}
+
+TEST_F(DesktopFileCollectionTest, testMemoryUsage) {
+    tempDir.writeFile("a.desktop", appA);
+    DesktopFileCollection collection(tempDir.path());
+    const auto usage = collection.memoryUsage();
+
+    tempDir.writeFile("b.desktop", appB);
+    collection.load();
+    const auto grownUsage = collection.memoryUsage();
+
+    // the files are included
+    const auto& files = *collection.snapshot();
+    EXPECT_GT(grownUsage.total(), usage.total() + files.at(tempDir.path() + "/b.desktop")->memoryUsage().total());
+}
+
+TEST_F(DesktopFileCollectionTest, testUpdateWithoutChanges) {
+    const auto pathA = tempDir.writeFile("a.desktop", appA);
+
+    DesktopFileCollection collection(tempDir.path());
+    const auto oldSnapshot = collection.snapshot();
+
+    // rewriting a file with the same contents does not count as a modification
+    tempDir.writeFile("a.desktop", appA);
+
+    EXPECT_TRUE(collection.update({pathA}).isEmpty());
+    EXPECT_EQ(collection.snapshot(), oldSnapshot);
+}
+
+TEST_F(DesktopFileCollectionTest, testReload) {
+    const auto pathA = tempDir.writeFile("a.desktop", appA);
+
+    DesktopFileCollection collection(tempDir.path());
+    const auto fileA = collection.snapshot()->at(pathA);
+
+    const auto pathB = tempDir.writeFile("b.desktop", appB);
+
+    const auto changes = collection.load();
+    EXPECT_EQ(changes.added, std::vector<std::string>{pathB});
+    EXPECT_TRUE(changes.modified.empty());
+    EXPECT_TRUE(changes.removed.empty());
+
+    // unchanged files are taken over from the previous snapshot
+    EXPECT_EQ(collection.snapshot()->at(pathA), fileA);
+}
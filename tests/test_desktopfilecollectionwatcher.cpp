@@ -0,0 +1,135 @@
+// system headers
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilecollectionwatcher.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "tempdirectory.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopFileCollectionWatcherTest : public ::testing::Test {
+public:
+    TempDirectory tempDir;
+
+    const std::string app = "[Desktop Entry]\nType=Application\nName=App\nExec=app\n";
+
+    // generous upper bound for the arrival of inotify events
+    static constexpr int timeoutMs = 5000;
+
+    // keep tests fast
+    static constexpr int settleTimeMs = 20;
+
+private:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(DesktopFileCollectionWatcherTest, testWatchCollectionWithoutDirectory) {
+    DesktopFileCollection collection;
+    EXPECT_THROW(DesktopFileCollectionWatcher watcher(collection), IOError);
+}
+
+TEST_F(DesktopFileCollectionWatcherTest, testTimeout) {
+    DesktopFileCollection collection(tempDir.path());
+    DesktopFileCollectionWatcher watcher(collection, settleTimeMs);
+
+    EXPECT_GE(watcher.fileDescriptor(), 0);
+    EXPECT_TRUE(watcher.processEvents(0).isEmpty());
+}
+
+TEST_F(DesktopFileCollectionWatcherTest, testBurstIsCoalesced) {
+    DesktopFileCollection collection(tempDir.path());
+    DesktopFileCollectionWatcher watcher(collection, settleTimeMs);
+
+    const auto initialSnapshot = collection.snapshot();
+
+    // simulate a package installation which writes a couple of files, some of them more than once
+    const auto pathA = tempDir.writeFile("a.desktop", app);
+    const auto pathB = tempDir.writeFile("b.desktop", app);
+    tempDir.writeFile("a.desktop", app + "Comment=Updated\n");
+    tempDir.writeFile("README", "not a desktop file");
+
+    const auto changes = watcher.processEvents(timeoutMs);
+    EXPECT_EQ(changes.added, std::vector<std::string>({pathA, pathB}));
+    EXPECT_TRUE(changes.modified.empty());
+    EXPECT_TRUE(changes.removed.empty());
+
+    const auto snapshot = collection.snapshot();
+    EXPECT_NE(snapshot, initialSnapshot);
+    EXPECT_EQ(snapshot->size(), 2);
+
+    EXPECT_TRUE(snapshot->at(pathA)->entryExists("Desktop Entry", "Comment"));
+}
+
+TEST_F(DesktopFileCollectionWatcherTest, testSteadyStreamIsNotCoalescedForever) {
+    DesktopFileCollection collection(tempDir.path());
+    DesktopFileCollectionWatcher watcher(collection, settleTimeMs);
+
+    // writes files more often than the settle time, until the test is done
+    std::atomic<bool> stop{false};
+    std::thread writer([this, &stop]() {
+        for (int i = 0; !stop; ++i) {
+            tempDir.writeFile(std::to_string(i % 100) + ".desktop", app);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto changes = watcher.processEvents(timeoutMs);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    stop = true;
+    writer.join();
+
+    EXPECT_FALSE(changes.isEmpty());
+    EXPECT_LT(elapsed, std::chrono::milliseconds(timeoutMs));
+}
+
+TEST_F(DesktopFileCollectionWatcherTest, testModificationAndRemoval) {
+    const auto pathA = tempDir.writeFile("a.desktop", app);
+    const auto pathB = tempDir.writeFile("b.desktop", app);
+
+    DesktopFileCollection collection(tempDir.path());
+    DesktopFileCollectionWatcher watcher(collection, settleTimeMs);
+
+    const auto unchangedFile = collection.snapshot()->at(pathB);
+
+    tempDir.writeFile("a.desktop", app + "Comment=Updated\n");
+    const auto modifications = watcher.processEvents(timeoutMs);
+    EXPECT_EQ(modifications.modified, std::vector<std::string>{pathA});
+
+    // files which have not been touched are not re-read
+    EXPECT_EQ(collection.snapshot()->at(pathB), unchangedFile);
+
+    std::remove(pathA.c_str());
+    const auto removals = watcher.processEvents(timeoutMs);
+    EXPECT_EQ(removals.removed, std::vector<std::string>{pathA});
+    EXPECT_EQ(collection.snapshot()->size(), 1);
+}
+
+TEST_F(DesktopFileCollectionWatcherTest, testNewSubdirectory) {
+    DesktopFileCollection collection(tempDir.path());
+    DesktopFileCollectionWatcher watcher(collection, settleTimeMs);
+
+    const auto path = tempDir.writeFile("vendor/app.desktop", app);
+
+    // the file might have been written before the watch on the new directory was set up, so it must be picked up
+    // either way
+    watcher.processEvents(timeoutMs);
+    if (collection.snapshot()->count(path) == 0)
+        watcher.processEvents(timeoutMs);
+
+    EXPECT_EQ(collection.snapshot()->count(path), 1);
+
+    // changes in the new directory must be noticed, too
+    tempDir.writeFile("vendor/app.desktop", app + "Comment=Updated\n");
+    const auto changes = watcher.processEvents(timeoutMs);
+    EXPECT_EQ(changes.modified, std::vector<std::string>{path});
+}
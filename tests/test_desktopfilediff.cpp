@@ -0,0 +1,167 @@
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilediff.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopFileDiffTest : public ::testing::Test {
+public:
+    DesktopFile base;
+
+private:
+    void SetUp() override {
+        std::stringstream ss;
+        ss << "[Desktop Entry]" << std::endl
+           << "Type=Application" << std::endl
+           << "Name=Vendor Application" << std::endl
+           << "Exec=app %F" << std::endl
+           << "Icon=app" << std::endl
+           << "[Desktop Action New]" << std::endl
+           << "Name=New Window" << std::endl
+           << "Exec=app --new-window" << std::endl;
+
+        base = DesktopFile(ss);
+    }
+
+    void TearDown() override {}
+
+public:
+    static std::string valueOf(const DesktopFile& file, const std::string& section, const std::string& key) {
+        DesktopFileEntry entry;
+
+        if (!file.getEntry(section, key, entry))
+            return "<missing>";
+
+        return std::string(entry.value());
+    }
+};
+
+TEST_F(DesktopFileDiffTest, testDiffOfEqualFiles) {
+    DesktopFile copy(base);
+    EXPECT_TRUE(diff(base, copy).isEmpty());
+    EXPECT_TRUE(diff(DesktopFile(), DesktopFile()).isEmpty());
+}
+
+TEST_F(DesktopFileDiffTest, testDiffEntries) {
+    DesktopFile modified(base);
+    modified.setEntry("Desktop Entry", DesktopFileEntry("Name", "Local Application"));
+    modified.setEntry("Desktop Entry", DesktopFileEntry("X-AppImage-Version", "1.0"));
+
+    const auto result = diff(base, modified);
+    EXPECT_FALSE(result.isEmpty());
+    EXPECT_TRUE(result.addedSections.empty());
+    EXPECT_TRUE(result.removedSections.empty());
+
+    ASSERT_EQ(result.sections.size(), 1);
+    const auto& sectionDiff = result.sections.at("Desktop Entry");
+
+    ASSERT_EQ(sectionDiff.added.size(), 1);
+    EXPECT_EQ(sectionDiff.added[0], DesktopFileEntry("X-AppImage-Version", "1.0"));
+
+    ASSERT_EQ(sectionDiff.changed.size(), 1);
+    EXPECT_EQ(sectionDiff.changed[0].first.value(), "Vendor Application");
+    EXPECT_EQ(sectionDiff.changed[0].second.value(), "Local Application");
+
+    EXPECT_TRUE(sectionDiff.removed.empty());
+
+    // the reverse diff reports the key as removed
+    const auto reverse = diff(modified, base);
+    ASSERT_EQ(reverse.sections.at("Desktop Entry").removed.size(), 1);
+    EXPECT_EQ(reverse.sections.at("Desktop Entry").removed[0].key(), "X-AppImage-Version");
+}
+
+TEST_F(DesktopFileDiffTest, testDiffSections) {
+    const auto result = diff(base, DesktopFile());
+    EXPECT_EQ(result.removedSections, std::vector<std::string>({"Desktop Action New", "Desktop Entry"}));
+    EXPECT_TRUE(result.addedSections.empty());
+    EXPECT_EQ(result.sections.at("Desktop Entry").removed.size(), 4);
+    EXPECT_EQ(result.sections.at("Desktop Action New").removed.size(), 2);
+
+    const auto reverse = diff(DesktopFile(), base);
+    EXPECT_EQ(reverse.addedSections, std::vector<std::string>({"Desktop Action New", "Desktop Entry"}));
+    EXPECT_EQ(reverse.sections.at("Desktop Entry").added.size(), 4);
+}
+
+TEST_F(DesktopFileDiffTest, testMergeWithoutConflicts) {
+    // local overrides
+    DesktopFile ours(base);
+    ours.setEntry("Desktop Entry", DesktopFileEntry("Exec", "AppRun %F"));
+    ours.setEntry("Desktop Entry", DesktopFileEntry("X-AppImage-Version", "1.0"));
+
+    // new vendor version
+    DesktopFile theirs(base);
+    theirs.setEntry("Desktop Entry", DesktopFileEntry("Name", "Renamed Application"));
+    theirs.setEntry("Desktop Entry", DesktopFileEntry("Comment", "Now with a comment"));
+    theirs.setEntry("Desktop Action Quit", DesktopFileEntry("Name", "Quit"));
+
+    const auto result = merge(base, ours, theirs);
+    EXPECT_FALSE(result.hasConflicts());
+
+    const auto& merged = result.merged;
+    EXPECT_EQ(valueOf(merged, "Desktop Entry", "Exec"), "AppRun %F");
+    EXPECT_EQ(valueOf(merged, "Desktop Entry", "X-AppImage-Version"), "1.0");
+    EXPECT_EQ(valueOf(merged, "Desktop Entry", "Name"), "Renamed Application");
+    EXPECT_EQ(valueOf(merged, "Desktop Entry", "Comment"), "Now with a comment");
+    EXPECT_EQ(valueOf(merged, "Desktop Entry", "Icon"), "app");
+    EXPECT_EQ(valueOf(merged, "Desktop Action Quit", "Name"), "Quit");
+    EXPECT_EQ(valueOf(merged, "Desktop Action New", "Name"), "New Window");
+
+    // the hash must be consistent with the merged contents
+    DesktopFile expected(ours);
+    expected.setEntry("Desktop Entry", DesktopFileEntry("Name", "Renamed Application"));
+    expected.setEntry("Desktop Entry", DesktopFileEntry("Comment", "Now with a comment"));
+    expected.setEntry("Desktop Action Quit", DesktopFileEntry("Name", "Quit"));
+    EXPECT_EQ(merged.contentHash(), expected.contentHash());
+    EXPECT_EQ(merged, expected);
+}
+
+TEST_F(DesktopFileDiffTest, testMergeRemovals) {
+    // they removed an entire section, we didn't touch it
+    std::stringstream ss;
+    ss << "[Desktop Entry]" << std::endl
+       << "Type=Application" << std::endl
+       << "Name=Vendor Application" << std::endl
+       << "Exec=app %F" << std::endl;
+    DesktopFile theirs(ss);
+
+    const auto result = merge(base, base, theirs);
+    EXPECT_FALSE(result.hasConflicts());
+    EXPECT_EQ(valueOf(result.merged, "Desktop Entry", "Icon"), "<missing>");
+    EXPECT_TRUE(diff(theirs, result.merged).isEmpty());
+}
+
+TEST_F(DesktopFileDiffTest, testMergeConflicts) {
+    DesktopFile ours(base);
+    ours.setEntry("Desktop Entry", DesktopFileEntry("Name", "Our Name"));
+
+    DesktopFile theirs(base);
+    theirs.setEntry("Desktop Entry", DesktopFileEntry("Name", "Their Name"));
+    theirs.setEntry("Desktop Entry", DesktopFileEntry("Icon", "their-icon"));
+
+    const auto result = merge(base, ours, theirs);
+    ASSERT_TRUE(result.hasConflicts());
+    ASSERT_EQ(result.conflicts.size(), 1);
+
+    const auto& conflict = result.conflicts[0];
+    EXPECT_EQ(conflict.section, "Desktop Entry");
+    EXPECT_EQ(conflict.key, "Name");
+    EXPECT_EQ(conflict.base.value(), "Vendor Application");
+    EXPECT_EQ(conflict.ours.value(), "Our Name");
+    EXPECT_EQ(conflict.theirs.value(), "Their Name");
+
+    // conflicts are resolved in favor of our version, non-conflicting changes are still applied
+    EXPECT_EQ(valueOf(result.merged, "Desktop Entry", "Name"), "Our Name");
+    EXPECT_EQ(valueOf(result.merged, "Desktop Entry", "Icon"), "their-icon");
+
+    // adding the same key with different values in both versions is a conflict, too
+    DesktopFile oursWithNewKey(base);
+    oursWithNewKey.setEntry("Desktop Entry", DesktopFileEntry("Comment", "ours"));
+    DesktopFile theirsWithNewKey(base);
+    theirsWithNewKey.setEntry("Desktop Entry", DesktopFileEntry("Comment", "theirs"));
+
+    const auto addResult = merge(base, oursWithNewKey, theirsWithNewKey);
+    ASSERT_EQ(addResult.conflicts.size(), 1);
+    EXPECT_TRUE(addResult.conflicts[0].base.isEmpty());
+}
@@ -9,8 +9,8 @@ using namespace linuxdeploy::desktopfile;
 
 class DesktopFileEntryTest : public ::testing::Test {
 public:
-    const std::string key;
-    const std::string value;
+    const std::string_view key;
+    const std::string_view value;
 
 protected:
     DesktopFileEntryTest() : key("testKey"), value("testValue") {}
@@ -47,7 +47,7 @@ TEST_F(DesktopFileEntryTest, testEqualityAndInequalityOperators) {
     DesktopFileEntry nonEmptyEntry(key, value);
     EXPECT_NE(emptyEntry, nonEmptyEntry);
 
-    DesktopFileEntry nonEmptyEntryWithDifferentValue(key, value + "abc");
+    DesktopFileEntry nonEmptyEntryWithDifferentValue(key, std::string(value) + "abc");
     EXPECT_NE(nonEmptyEntry, nonEmptyEntryWithDifferentValue);
 }
 
@@ -129,7 +129,7 @@ TEST_F(DesktopFileEntryTest, testParsingStringList) {
     EXPECT_EQ(emptyEntry.parseStringList(), std::vector<std::string>({}));
 
     DesktopFileEntry nonListEntry(key, value);
-    EXPECT_EQ(nonListEntry.parseStringList(), std::vector<std::string>({value}));
+    EXPECT_EQ(nonListEntry.parseStringList(), std::vector<std::string>({std::string(value)}));
 
     DesktopFileEntry listEntry(key, "val1;val2;");
     EXPECT_EQ(listEntry.parseStringList(), std::vector<std::string>({"val1", "val2"}));
@@ -0,0 +1,129 @@
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfileindex.h"
+#include "tempdirectory.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopFileIndexTest : public ::testing::Test {
+public:
+    typedef DesktopFileIndex::Field Field;
+    typedef DesktopFileIndex::postings_t postings_t;
+
+    DesktopFile viewer;
+    DesktopFile editor;
+    DesktopFile terminal;
+
+private:
+    static DesktopFile makeFile(const std::string& categories, const std::string& mimeTypes,
+                                const std::string& keywords) {
+        DesktopFile file;
+        file.setEntry("Desktop Entry", DesktopFileEntry("Categories", categories));
+        file.setEntry("Desktop Entry", DesktopFileEntry("MimeType", mimeTypes));
+        file.setEntry("Desktop Entry", DesktopFileEntry("Keywords", keywords));
+        return file;
+    }
+
+    void SetUp() override {
+        viewer = makeFile("Graphics;Viewer;", "image/png;image/jpeg;", "Picture;Photo;");
+        editor = makeFile("Graphics;2DGraphics;RasterGraphics;", "image/png;Image/x-XCF;", "paint;");
+        terminal = makeFile("System;TerminalEmulator;", "", "shell;prompt;");
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(DesktopFileIndexTest, testDefaultConstructor) {
+    DesktopFileIndex index;
+    EXPECT_EQ(index.size(), 0);
+    EXPECT_TRUE(index.find(Field::Categories, "Graphics").empty());
+}
+
+TEST_F(DesktopFileIndexTest, testFind) {
+    DesktopFileIndex index;
+    const auto viewerId = index.update("viewer.desktop", viewer);
+    const auto editorId = index.update("editor.desktop", editor);
+    const auto terminalId = index.update("terminal.desktop", terminal);
+
+    EXPECT_EQ(index.size(), 3);
+    EXPECT_EQ(index.path(editorId), "editor.desktop");
+
+    EXPECT_EQ(index.find(Field::Categories, "Graphics"), postings_t({viewerId, editorId}));
+    EXPECT_EQ(index.find(Field::Categories, "System"), postings_t({terminalId}));
+    EXPECT_EQ(index.find(Field::MimeType, "image/png"), postings_t({viewerId, editorId}));
+
+    // categories are case sensitive, MIME types and keywords are not
+    EXPECT_TRUE(index.find(Field::Categories, "graphics").empty());
+    EXPECT_EQ(index.find(Field::MimeType, "image/x-xcf"), postings_t({editorId}));
+    EXPECT_EQ(index.find(Field::Keywords, "PHOTO"), postings_t({viewerId}));
+}
+
+TEST_F(DesktopFileIndexTest, testFindAllAndFindAny) {
+    DesktopFileIndex index;
+    const auto viewerId = index.update("viewer.desktop", viewer);
+    const auto editorId = index.update("editor.desktop", editor);
+    const auto terminalId = index.update("terminal.desktop", terminal);
+
+    EXPECT_EQ(index.findAll(Field::Categories, {"Graphics", "Viewer"}), postings_t({viewerId}));
+    EXPECT_TRUE(index.findAll(Field::Categories, {"Graphics", "System"}).empty());
+    EXPECT_TRUE(index.findAll(Field::Categories, {}).empty());
+
+    EXPECT_EQ(index.findAny(Field::Categories, {"Viewer", "System"}), postings_t({viewerId, terminalId}));
+    EXPECT_EQ(index.findAny(Field::Categories, {"Graphics", "Unknown"}), postings_t({viewerId, editorId}));
+
+    // combine queries on different fields
+    EXPECT_EQ(
+        DesktopFileIndex::intersect(index.find(Field::MimeType, "image/png"), index.find(Field::Keywords, "paint")),
+        postings_t({editorId})
+    );
+}
+
+TEST_F(DesktopFileIndexTest, testIncrementalUpdates) {
+    DesktopFileIndex index;
+    const auto viewerId = index.update("viewer.desktop", viewer);
+    const auto editorId = index.update("editor.desktop", editor);
+
+    // replacing a file keeps its ID, but updates its postings
+    EXPECT_EQ(index.update("viewer.desktop", terminal), viewerId);
+    EXPECT_EQ(index.find(Field::Categories, "Graphics"), postings_t({editorId}));
+    EXPECT_EQ(index.find(Field::Categories, "System"), postings_t({viewerId}));
+
+    EXPECT_TRUE(index.remove("editor.desktop"));
+    EXPECT_FALSE(index.remove("editor.desktop"));
+    EXPECT_TRUE(index.find(Field::Categories, "Graphics").empty());
+    EXPECT_THROW(index.path(editorId), std::out_of_range);
+
+    DesktopFileIndex::file_id_t id;
+    EXPECT_FALSE(index.findId("editor.desktop", id));
+    EXPECT_TRUE(index.findId("viewer.desktop", id));
+    EXPECT_EQ(id, viewerId);
+
+    // copies must not be affected by changes to the original
+    DesktopFileIndex copy(index);
+    index.remove("viewer.desktop");
+    EXPECT_EQ(copy.find(Field::Categories, "System"), postings_t({viewerId}));
+    EXPECT_TRUE(index.find(Field::Categories, "System").empty());
+}
+
+TEST_F(DesktopFileIndexTest, testCollectionChanges) {
+    TempDirectory tempDir;
+    const auto appPath = tempDir.writeFile("app.desktop", "[Desktop Entry]\nName=App\nCategories=Graphics;\n");
+    const auto otherPath = tempDir.writeFile("other.desktop", "[Desktop Entry]\nName=Other\nCategories=Graphics;\n");
+
+    DesktopFileCollection collection(tempDir.path());
+    DesktopFileIndex index(*collection.snapshot());
+    EXPECT_EQ(index.find(Field::Categories, "Graphics").size(), 2);
+
+    tempDir.writeFile("app.desktop", "[Desktop Entry]\nName=App\nCategories=Office;\n");
+    std::remove(otherPath.c_str());
+
+    const auto changes = collection.update({appPath, otherPath});
+    index.update(*collection.snapshot(), changes);
+
+    EXPECT_EQ(index.size(), 1);
+    EXPECT_TRUE(index.find(Field::Categories, "Graphics").empty());
+    ASSERT_EQ(index.find(Field::Categories, "Office").size(), 1);
+    EXPECT_EQ(index.path(index.find(Field::Categories, "Office").front()), appPath);
+}
@@ -0,0 +1,108 @@
+// system headers
+#include <cstdlib>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfileoverlay.h"
+#include "tempdirectory.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopFileOverlayTest : public ::testing::Test {
+public:
+    TempDirectory tempDir;
+
+    std::string home;
+    std::string system;
+
+    static std::string app(const std::string& name) {
+        return "[Desktop Entry]\nType=Application\nName=" + name + "\nExec=" + name + "\n";
+    }
+
+private:
+    void SetUp() override {
+        home = tempDir.path() + "/home/applications";
+        system = tempDir.path() + "/usr/share/applications";
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(DesktopFileOverlayTest, testDefaultConstructor) {
+    DesktopFileOverlay overlay;
+    EXPECT_TRUE(overlay.directories().empty());
+    EXPECT_TRUE(overlay.files().empty());
+}
+
+TEST_F(DesktopFileOverlayTest, testDesktopFileId) {
+    EXPECT_EQ(DesktopFileOverlay::desktopFileId("/usr/share/applications", "/usr/share/applications/foo.desktop"),
+              "foo.desktop");
+    EXPECT_EQ(DesktopFileOverlay::desktopFileId("/usr/share/applications", "/usr/share/applications/kde/foo.desktop"),
+              "kde-foo.desktop");
+    EXPECT_EQ(DesktopFileOverlay::desktopFileId("/usr/share/applications", "/usr/share/applications2/foo.desktop"), "");
+}
+
+TEST_F(DesktopFileOverlayTest, testEarlierDirectoriesWin) {
+    tempDir.writeFile("home/applications/a.desktop", app("home-a"));
+    tempDir.writeFile("usr/share/applications/a.desktop", app("system-a"));
+    tempDir.writeFile("usr/share/applications/kde/b.desktop", app("system-b"));
+
+    // shadowed files are not even parsed
+    tempDir.writeFile("usr/share/applications/kde-c.desktop", app("system-c"));
+    const auto brokenPath = tempDir.writeFile("usr/share/applications/kde/c.desktop", "broken");
+
+    DesktopFileOverlay overlay({home + "/", system, tempDir.path() + "/does-not-exist"});
+
+    ASSERT_EQ(overlay.files().size(), 3);
+    EXPECT_EQ(overlay.find("a.desktop")->findEntry("Desktop Entry", "Name")->value(), "home-a");
+    EXPECT_EQ(overlay.find("kde-b.desktop")->path(), system + "/kde/b.desktop");
+    EXPECT_EQ(overlay.find("kde-c.desktop")->findEntry("Desktop Entry", "Name")->value(), "system-c");
+    EXPECT_EQ(overlay.find("missing.desktop"), nullptr);
+
+    EXPECT_TRUE(overlay.errors().empty());
+    EXPECT_EQ(overlay.shadowed(), (std::vector<std::string>{system + "/a.desktop", brokenPath}));
+}
+
+TEST_F(DesktopFileOverlayTest, testHiddenRemovesId) {
+    tempDir.writeFile("home/applications/a.desktop", "[Desktop Entry]\nHidden=true\n");
+    tempDir.writeFile("usr/share/applications/a.desktop", app("system-a"));
+    tempDir.writeFile("usr/share/applications/b.desktop", app("system-b"));
+    const auto brokenPath = tempDir.writeFile("home/applications/c.desktop", "broken");
+
+    DesktopFileOverlay overlay({home, system});
+
+    EXPECT_EQ(overlay.find("a.desktop"), nullptr);
+    EXPECT_NE(overlay.find("b.desktop"), nullptr);
+    EXPECT_EQ(overlay.hidden(), std::vector<std::string>{"a.desktop"});
+
+    ASSERT_EQ(overlay.errors().size(), 1);
+    EXPECT_EQ(overlay.errors().begin()->first, brokenPath);
+
+    // a newer version restores the ID
+    tempDir.writeFile("home/applications/a.desktop", app("home-a"));
+    overlay.load();
+    EXPECT_EQ(overlay.find("a.desktop")->findEntry("Desktop Entry", "Name")->value(), "home-a");
+    EXPECT_TRUE(overlay.hidden().empty());
+}
+
+TEST_F(DesktopFileOverlayTest, testDefaultDirectories) {
+    auto saveVariable = [](const char* name) {
+        const auto* value = getenv(name);
+        return value == nullptr ? std::string() : std::string(value);
+    };
+
+    const auto oldDataHome = saveVariable("XDG_DATA_HOME");
+    const auto oldDataDirs = saveVariable("XDG_DATA_DIRS");
+
+    setenv("XDG_DATA_HOME", "/data/home", 1);
+    setenv("XDG_DATA_DIRS", "/a::/b", 1);
+
+    const std::vector<std::string> expected = {"/data/home/applications", "/a/applications", "/b/applications"};
+    EXPECT_EQ(DesktopFileOverlay::defaultDirectories(), expected);
+
+    // empty values are treated like unset ones
+    setenv("XDG_DATA_DIRS", oldDataDirs.c_str(), 1);
+    setenv("XDG_DATA_HOME", oldDataHome.c_str(), 1);
+}
@@ -3,7 +3,9 @@
 
 // local headers
 #include "../src/desktopfilereader.h"
+#include "../src/desktopfiletokenizer.h"
 #include "linuxdeploy/desktopfile/exceptions.h"
+#include "tempdirectory.h"
 
 using namespace linuxdeploy::desktopfile;
 
@@ -197,6 +199,37 @@ TEST_F(DesktopFileReaderTest, testParseFileGetNonExistingSection) {
     EXPECT_THROW(reader["Non-existing Section"], UnknownSectionError);
 }
 
+TEST_F(DesktopFileReaderTest, testGetSectionByStringView) {
+    std::stringstream ss;
+    ss << "[Desktop Entry]" << std::endl
+       << "Name=name" << std::endl;
+
+    DesktopFileReader reader(ss);
+
+    const std::string header = "[Desktop Entry]";
+    const auto name = std::string_view(header).substr(1, header.size() - 2);
+
+    EXPECT_EQ(reader[name]["Name"].value(), "name");
+    EXPECT_EQ(reader[std::string("Desktop Entry")].size(), 1);
+    EXPECT_THROW(reader[name.substr(0, 7)], UnknownSectionError);
+}
+
+TEST_F(DesktopFileReaderTest, testGetSectionReference) {
+    std::stringstream ss;
+    ss << "[Desktop Entry]" << std::endl
+       << "Name=name" << std::endl;
+
+    DesktopFileReader reader(ss);
+
+    const auto& section = reader.section("Desktop Entry");
+    EXPECT_EQ(section.at("Name").value(), "name");
+
+    // the same section is returned every time
+    EXPECT_EQ(&reader.section("Desktop Entry"), &section);
+
+    EXPECT_THROW(reader.section("Non-existing Section"), UnknownSectionError);
+}
+
 TEST_F(DesktopFileReaderTest, testParseFileMissingSectionHeader) {
     std::stringstream ss;
     ss << "Name=name" << std::endl
@@ -412,7 +445,7 @@ TEST_F(DesktopFileReaderTest, testReadLocalizedEntriesWithoutProperLocalizationS
         auto expected = DesktopFile::section_t({
             {"Name",     DesktopFileEntry("Name", "name")},
             // FIXME: revise after introduction of localization support
-            {"Name[" + locale + "]", DesktopFileEntry("Name[" + locale + "]", "name")},
+            {std::pmr::string("Name[" + locale + "]"), DesktopFileEntry("Name[" + locale + "]", "name")},
             {"Exec",     DesktopFileEntry("Exec", "exec")},
         });
 
@@ -437,3 +470,161 @@ TEST_F(DesktopFileReaderTest, testKeyWithDashesAndLocaleWithUnderscore) {
 
     EXPECT_NO_THROW(DesktopFileReader reader(ins));
 }
+
+TEST_F(DesktopFileReaderTest, testParseBuffer) {
+    // the buffer is not null-terminated, and the data following it must be ignored
+    const std::string contents = "[Desktop Entry]\nName=name\nExec=exec\n[Desktop Action Foo]\nName=foo\n[ignored";
+    const auto size = contents.size() - std::string("[ignored").size();
+
+    DesktopFileReader reader(contents.data(), size);
+
+    EXPECT_EQ(reader.section("Desktop Entry").size(), 2);
+    EXPECT_EQ(reader.section("Desktop Entry").at("Exec").value(), "exec");
+    EXPECT_EQ(reader.section("Desktop Action Foo").at("Name").value(), "foo");
+    EXPECT_EQ(reader.data().size(), 2);
+
+    EXPECT_TRUE(DesktopFileReader(contents.data(), 0).isEmpty());
+}
+
+TEST_F(DesktopFileReaderTest, testParseBufferLikeStream) {
+    const std::vector<std::string> documents = {
+        "[Desktop Entry]\nName=name\nExec=exec",
+        "[Desktop Entry]\nName=name\n\n# comment\n// comment\nName[de] = Name \n",
+        "[Desktop Entry]\n\n\n[Desktop Entry]\nType=Application\n",
+        "\n[Desktop Entry]\n",
+        "[Desktop Entry]\nName=name\nName=other name\n",
+        "Name=no section\n",
+        "[Desktop Entry\n",
+        "[Desktop Entry]\ntest[[de]=foo\n",
+        "[Desktop Entry]\nno delimiter\n",
+    };
+
+    for (const auto& document : documents) {
+        std::stringstream ss(document);
+
+        DesktopFile::sections_t streamData;
+        bool streamThrew = false;
+
+        try {
+            streamData = DesktopFileReader(ss).data();
+        } catch (const ParseError&) {
+            streamThrew = true;
+        }
+
+        if (streamThrew) {
+            EXPECT_THROW(DesktopFileReader(document.data(), document.size()), ParseError) << document;
+        } else {
+            EXPECT_EQ(DesktopFileReader(document.data(), document.size()).data(), streamData) << document;
+        }
+    }
+}
+
+TEST_F(DesktopFileReaderTest, testParseParallel) {
+    // large enough to be split into several chunks, with sections which appear more than once, i.e., in several chunks
+    auto generate = [](const std::string& lastLine) {
+        std::string document = "# generated\n[Desktop Entry]\nName=Menu\n";
+
+        for (int i = 0; i < 5000; ++i) {
+            document += "[Section " + std::to_string(i % 2500) + "]\n";
+            document += "Key" + std::to_string(i) + "=" + std::string(100, 'x') + "\n";
+        }
+
+        return document + lastLine;
+    };
+
+    const auto document = generate("Name[de]=Abschnitt");
+    const DesktopFileReader sequential(document.data(), document.size());
+    const DesktopFileReader parallel(document.data(), document.size(), 4, std::pmr::new_delete_resource());
+
+    EXPECT_EQ(parallel.data(), sequential.data());
+    EXPECT_EQ(parallel.section("Section 0").size(), 2);
+    EXPECT_EQ(parallel.section("Section 2499").size(), 3);
+
+    // keys must be unique across all chunks
+    const auto duplicateKey = generate("Key2499=duplicate\n");
+    EXPECT_THROW(DesktopFileReader(duplicateKey.data(), duplicateKey.size(), 4, std::pmr::new_delete_resource()),
+                 ParseError);
+
+    // errors in any chunk are reported
+    const auto invalidKey = generate("Invalid Key=value\n");
+    EXPECT_THROW(DesktopFileReader(invalidKey.data(), invalidKey.size(), 4, std::pmr::new_delete_resource()),
+                 ParseError);
+}
+
+TEST_F(DesktopFileReaderTest, testKeyFilePolicies) {
+    // counts the entries, reports every key as a duplicate
+    class Handler {
+    public:
+        size_t entries = 0;
+
+        void onSection(std::string_view) {}
+
+        bool onEntry(std::string_view, std::string_view) {
+            ++entries;
+            return false;
+        }
+    };
+
+    auto parse = [](auto policy, const std::string& document) {
+        ParseStatistics statistics;
+        Handler handler;
+        BasicKeyFileTokenizer<decltype(policy)> tokenizer(statistics);
+        tokenizer.parse(document.data(), document.size(), handler);
+        return handler.entries;
+    };
+
+    const std::string mimeApps =
+        "[Default Applications]\n# comment\nimage/svg+xml=a.desktop\nimage/svg+xml=b.desktop\n";
+    EXPECT_EQ(parse(MimeAppsPolicy(), mimeApps), 2);
+    EXPECT_THROW(parse(DesktopEntryPolicy(), mimeApps), ParseError);
+
+    // MIME types are not localized, and only # introduces comments
+    EXPECT_THROW(parse(MimeAppsPolicy(), "[Added Associations]\ntext/plain[de]=a.desktop\n"), ParseError);
+    EXPECT_THROW(parse(MimeAppsPolicy(), "[Added Associations]\n// comment\n"), ParseError);
+
+    EXPECT_EQ(parse(IconThemeIndexPolicy(), "[Icon Theme]\nName=Theme\nName[de]=Thema\nName=Theme\n"), 3);
+    EXPECT_THROW(parse(IconThemeIndexPolicy(), "[Icon Theme]\nName_=Theme\n"), ParseError);
+
+    TempDirectory tempDir;
+    const auto path = tempDir.writeFile("index.theme", "[Icon Theme]\nDirectories=16x16\nDirectories=32x32\n");
+
+    EXPECT_THROW(DesktopFileReader(path, DesktopEntryPolicy()), ParseError);
+
+    // the last value is kept
+    const DesktopFileReader reader(path, IconThemeIndexPolicy());
+    EXPECT_EQ(reader.section("Icon Theme").at("Directories").value(), "32x32");
+}
+
+TEST_F(DesktopFileReaderTest, testKeyFilePolicyBuffersAndResources) {
+    const std::string index = "[Icon Theme]\nDirectories=16x16\nDirectories=32x32\n";
+
+    EXPECT_THROW(DesktopFileReader(index.data(), index.size(), DesktopEntryPolicy()), ParseError);
+
+    std::pmr::monotonic_buffer_resource resource;
+    const DesktopFileReader buffer(index.data(), index.size(), IconThemeIndexPolicy(), &resource);
+    EXPECT_EQ(buffer.section("Icon Theme").at("Directories").value(), "32x32");
+    EXPECT_EQ(buffer.section("Icon Theme").get_allocator().resource(), &resource);
+
+    TempDirectory tempDir;
+    const auto path = tempDir.writeFile("index.theme", index);
+    const DesktopFileReader file(path, IconThemeIndexPolicy(), &resource);
+    EXPECT_EQ(file.section("Icon Theme").get_allocator().resource(), &resource);
+
+    // duplicates in different chunks are tolerated as well, the last value is kept
+    std::string document = "[Icon Theme]\nDirectories=16x16\n";
+
+    for (int i = 0; i < 5000; ++i)
+        document += "[" + std::to_string(i % 2500) + "x" + std::to_string(i % 2500) + "]\nSize" +
+                    std::to_string(i) + "=" + std::string(100, 'x') + "\n";
+
+    document += "[Icon Theme]\nDirectories=32x32\n";
+
+    const DesktopFileReader sequential(document.data(), document.size(), IconThemeIndexPolicy());
+    const DesktopFileReader parallel(document.data(), document.size(), IconThemeIndexPolicy(), 4,
+                                     std::pmr::new_delete_resource());
+    EXPECT_EQ(parallel.data(), sequential.data());
+    EXPECT_EQ(parallel.section("Icon Theme").at("Directories").value(), "32x32");
+
+    EXPECT_THROW(DesktopFileReader(document.data(), document.size(), DesktopEntryPolicy(), 4,
+                                   std::pmr::new_delete_resource()), ParseError);
+}
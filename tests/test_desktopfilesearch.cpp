@@ -0,0 +1,157 @@
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfilesearch.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopFileSearchTest : public ::testing::Test {
+public:
+    DesktopFile firefox;
+    DesktopFile files;
+    DesktopFile terminal;
+
+private:
+    static DesktopFile makeFile(const std::string& name, const std::string& genericName,
+                                const std::string& keywords) {
+        DesktopFile file;
+        file.setEntry("Desktop Entry", DesktopFileEntry("Name", name));
+        file.setEntry("Desktop Entry", DesktopFileEntry("GenericName", genericName));
+        file.setEntry("Desktop Entry", DesktopFileEntry("Keywords", keywords));
+        return file;
+    }
+
+    void SetUp() override {
+        firefox = makeFile("Firefox", "Web Browser", "Internet;WWW;Browser;");
+        files = makeFile("Files", "File Manager", "folder;manager;explore;");
+        terminal = makeFile("Terminal", "Terminal Emulator", "shell;prompt;command;");
+
+        files.setEntry("Desktop Entry", DesktopFileEntry("Name[de]", "Dateien"));
+    }
+
+    void TearDown() override {}
+
+public:
+    static std::vector<std::string> paths(const DesktopFileSearch::results_t& results) {
+        std::vector<std::string> rv;
+
+        for (const auto& result : results)
+            rv.emplace_back(result.path);
+
+        return rv;
+    }
+};
+
+TEST_F(DesktopFileSearchTest, testEmptyIndex) {
+    DesktopFileSearch search;
+    EXPECT_EQ(search.size(), 0);
+    EXPECT_TRUE(search.search("firefox").empty());
+}
+
+TEST_F(DesktopFileSearchTest, testPrefixSearch) {
+    DesktopFileSearch search;
+    search.update("firefox.desktop", firefox);
+    search.update("files.desktop", files);
+    search.update("terminal.desktop", terminal);
+
+    EXPECT_EQ(search.size(), 3);
+
+    // very short prefixes must work, too
+    EXPECT_EQ(paths(search.search("f")), std::vector<std::string>({"files.desktop", "firefox.desktop"}));
+    EXPECT_EQ(paths(search.search("fir", 1)), std::vector<std::string>({"firefox.desktop"}));
+    EXPECT_EQ(paths(search.search("TERM")), std::vector<std::string>({"terminal.desktop"}));
+
+    const auto results = search.search("Firefox");
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].name, "Firefox");
+    EXPECT_FLOAT_EQ(results[0].score, 1.0f);
+
+    EXPECT_TRUE(search.search("").empty());
+    EXPECT_TRUE(search.search("fir", 0).empty());
+}
+
+TEST_F(DesktopFileSearchTest, testFuzzySearch) {
+    DesktopFileSearch search;
+    search.update("firefox.desktop", firefox);
+    search.update("terminal.desktop", terminal);
+
+    // typos are tolerated, as long as enough trigrams match
+    EXPECT_EQ(paths(search.search("firefix")), std::vector<std::string>({"firefox.desktop"}));
+
+    search.setMinimumSimilarity(1.0f);
+    EXPECT_TRUE(search.search("firefix").empty());
+}
+
+TEST_F(DesktopFileSearchTest, testFieldWeights) {
+    DesktopFileSearch search;
+    search.update("firefox.desktop", firefox);
+    search.update("browser.desktop", [](){
+        DesktopFile file;
+        file.setEntry("Desktop Entry", DesktopFileEntry("Name", "Browser"));
+        return file;
+    }());
+
+    // matches in names rank higher than matches in keywords
+    EXPECT_EQ(paths(search.search("browser")), std::vector<std::string>({"browser.desktop", "firefox.desktop"}));
+
+    search.setFieldWeight(DesktopFileSearch::Field::Name, 0.5f);
+    EXPECT_FLOAT_EQ(search.fieldWeight(DesktopFileSearch::Field::Name), 0.5f);
+
+    // firefox' generic name contains the query, too, and now has a higher weight
+    EXPECT_EQ(paths(search.search("browser")), std::vector<std::string>({"firefox.desktop", "browser.desktop"}));
+}
+
+TEST_F(DesktopFileSearchTest, testLocalizedKeys) {
+    DesktopFileSearch unlocalized;
+    unlocalized.update("files.desktop", files);
+    EXPECT_TRUE(unlocalized.search("dateien").empty());
+
+    DesktopFileSearch search(std::vector<std::string>{"de_DE", "de"});
+    search.update("files.desktop", files);
+
+    const auto results = search.search("dateien");
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].name, "Dateien");
+
+    // unlocalized values are still indexed
+    EXPECT_EQ(search.search("files").size(), 1);
+}
+
+TEST_F(DesktopFileSearchTest, testIncrementalUpdates) {
+    DesktopFileSearch search;
+    search.update("app.desktop", firefox);
+    search.update("other.desktop", files);
+
+    search.update("app.desktop", terminal);
+    EXPECT_TRUE(search.search("firefox").empty());
+    EXPECT_EQ(paths(search.search("terminal")), std::vector<std::string>({"app.desktop"}));
+
+    EXPECT_TRUE(search.remove("app.desktop"));
+    EXPECT_FALSE(search.remove("app.desktop"));
+    EXPECT_TRUE(search.search("terminal").empty());
+    EXPECT_EQ(search.size(), 1);
+
+    // IDs of removed files are reused
+    search.update("new.desktop", firefox);
+    EXPECT_EQ(paths(search.search("firefox")), std::vector<std::string>({"new.desktop"}));
+    EXPECT_EQ(paths(search.search("files")), std::vector<std::string>({"other.desktop"}));
+}
+
+TEST_F(DesktopFileSearchTest, testManyFiles) {
+    DesktopFileSearch search;
+
+    for (int i = 0; i < 10000; ++i) {
+        DesktopFile file;
+        file.setEntry("Desktop Entry", DesktopFileEntry("Name", "Application " + std::to_string(i)));
+        file.setEntry("Desktop Entry", DesktopFileEntry("Keywords", "generated;number" + std::to_string(i) + ";"));
+        search.update("app" + std::to_string(i) + ".desktop", file);
+    }
+
+    search.update("firefox.desktop", firefox);
+
+    EXPECT_EQ(search.size(), 10001);
+    EXPECT_EQ(search.search("app", 25).size(), 25);
+    EXPECT_EQ(paths(search.search("firef", 25)), std::vector<std::string>({"firefox.desktop"}));
+    EXPECT_EQ(paths(search.search("number4242", 1)), std::vector<std::string>({"app4242.desktop"}));
+}
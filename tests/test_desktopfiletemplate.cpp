@@ -0,0 +1,75 @@
+// system headers
+#include <memory_resource>
+#include <sstream>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfiletemplate.h"
+
+using namespace linuxdeploy::desktopfile;
+using namespace linuxdeploy::desktopfile::literals;
+
+namespace {
+    constexpr char applicationTemplate[] =
+        "# comment\n"
+        "[Desktop Entry]\n"
+        "Type=Application\n"
+        "Name = Simple Application\n"
+        "Name[de]=Einfache Anwendung\n"
+        "Exec=simple_executable %F\n"
+        "Actions=SimpleAction;\n"
+        "\n"
+        "[Desktop Action SimpleAction]\n"
+        "Name=Do something simple\n"
+        "Exec=simple_executable --do-it\n"
+        "\n"
+        "[Desktop Entry]\n"
+        "Icon=simple_icon\n"
+        "[X-Empty]";
+
+    using ApplicationTemplate = DesktopFileTemplate<applicationTemplate>;
+
+    // everything is available at compile time
+    static_assert(ApplicationTemplate::sectionCount() == 3);
+    static_assert(ApplicationTemplate::entryCount() == 8);
+    static_assert(ApplicationTemplate::findValue("Desktop Entry", "Name") == "Simple Application");
+    static_assert(ApplicationTemplate::findValue("Desktop Entry", "Icon") == "simple_icon");
+    static_assert(ApplicationTemplate::findValue("Desktop Entry", "Name[de]") == "Einfache Anwendung");
+    static_assert(!ApplicationTemplate::findValue("Desktop Action SimpleAction", "Icon").has_value());
+    static_assert(ApplicationTemplate::sectionExists("X-Empty"));
+    static_assert(!ApplicationTemplate::entryExists("NoSuchSection", "Name"));
+
+    static_assert("[A]\nKey=Välue\n"_desktopfile.findValue("A", "Key") == "Välue");
+    static_assert(""_desktopfile.sectionCount() == 0);
+}
+
+TEST(DesktopFileTemplateTest, testToDesktopFileMatchesRuntimeParser) {
+    std::stringstream ss(applicationTemplate);
+    const DesktopFile parsed(ss);
+
+    const auto file = ApplicationTemplate::toDesktopFile();
+    EXPECT_EQ(file, parsed);
+    EXPECT_EQ(file.contentHash(), parsed.contentHash());
+    EXPECT_TRUE(file.path().empty());
+}
+
+TEST(DesktopFileTemplateTest, testToDesktopFileIsModifiable) {
+    std::pmr::monotonic_buffer_resource pool;
+    auto file = ApplicationTemplate::toDesktopFile(&pool);
+    EXPECT_EQ(file.memoryResource(), &pool);
+
+    file.setEntry("Desktop Entry", DesktopFileEntry("Name", "Changed"));
+    EXPECT_EQ(file.findEntry("Desktop Entry", "Name")->value(), "Changed");
+    EXPECT_EQ(ApplicationTemplate::findValue("Desktop Entry", "Name"), "Simple Application");
+    EXPECT_NE(file, ApplicationTemplate::toDesktopFile());
+}
+
+TEST(DesktopFileTemplateTest, testLiteral) {
+    constexpr auto literal = "[Desktop Entry]\nType=Link\nURL=https://example.com\n"_desktopfile;
+
+    const auto file = literal.toDesktopFile();
+    EXPECT_EQ(file.findEntry("Desktop Entry", "URL")->value(), "https://example.com");
+    EXPECT_EQ(literal.source().substr(0, 15), "[Desktop Entry]");
+}
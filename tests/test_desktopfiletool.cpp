@@ -0,0 +1,207 @@
+// system headers
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "tempdirectory.h"
+
+/*
+ * Tests desktopfile-tool by running it on files in a temporary directory.
+ */
+class DesktopFileToolTest : public ::testing::Test {
+public:
+    TempDirectory tempDir;
+
+public:
+    static std::string readBack(const std::string& path) {
+        std::ifstream ifs(path);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ss.str();
+    }
+
+    // runs the tool with the given arguments, and returns its exit code
+    // the standard output is stored in output, the summary on the standard error is discarded
+    static int run(const std::vector<std::string>& arguments, std::string& output) {
+        std::string command = DESKTOPFILE_TOOL_PATH;
+
+        for (const auto& argument : arguments) {
+            command += " '";
+
+            for (const char c : argument) {
+                if (c == '\'')
+                    command += "'\\''";
+                else
+                    command += c;
+            }
+
+            command += "'";
+        }
+
+        command += " 2>/dev/null";
+
+        auto* pipe = popen(command.c_str(), "r");
+        if (pipe == nullptr)
+            return -1;
+
+        output.clear();
+
+        char buffer[4096];
+        size_t count;
+
+        while ((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+            output.append(buffer, count);
+
+        const auto status = pclose(pipe);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+    static int run(const std::vector<std::string>& arguments) {
+        std::string output;
+        return run(arguments, output);
+    }
+};
+
+TEST_F(DesktopFileToolTest, testSetUnsetRename) {
+    const auto path = tempDir.writeFile("app.desktop",
+        "# generated by hand\n"
+        "[Desktop Entry]\n"
+        "Name=App\n"
+        "GenericName=Application\n"
+        "Comment = old comment\n"
+        "\n"
+        "# the icon\n"
+        "Icon=app\n"
+        "\n"
+        "[Desktop Action New]\n"
+        "Name=New\n"
+        "Exec=app --new\n"
+        "\n"
+        "[Desktop Entry]\n"
+        "Exec=app\n"
+    );
+
+    std::string output;
+    EXPECT_EQ(run({"--set", "Comment=new comment", "--set", "Terminal=false", "--unset", "Icon",
+                   "--rename", "Name=GenericName", "--section", "Desktop Action New", "--set", "Icon=new",
+                   "--section", "Extra", "--set", "X-Key=value", path}, output), 0);
+    EXPECT_EQ(output, path + ": modified\n");
+
+    // keys are replaced and removed in place, added after the last key of the section, and renaming a key onto an
+    // existing one replaces the latter
+    EXPECT_EQ(readBack(path),
+        "# generated by hand\n"
+        "[Desktop Entry]\n"
+        "GenericName=App\n"
+        "Comment=new comment\n"
+        "\n"
+        "# the icon\n"
+        "\n"
+        "[Desktop Action New]\n"
+        "Name=New\n"
+        "Exec=app --new\n"
+        "Icon=new\n"
+        "\n"
+        "[Desktop Entry]\n"
+        "Exec=app\n"
+        "Terminal=false\n"
+        "\n"
+        "[Extra]\n"
+        "X-Key=value\n"
+    );
+}
+
+TEST_F(DesktopFileToolTest, testUnchangedFilesAreNotWritten) {
+    const std::string contents = "[Desktop Entry]\nName=App\nComment=comment\n";
+    const auto path = tempDir.writeFile("app.desktop", contents);
+
+    std::string output;
+
+    // values are trimmed like the parser trims them
+    EXPECT_EQ(run({"--set", "Comment=  comment ", "--unset", "Icon", "--rename", "NoSuchKey=Key", path}, output), 0);
+    EXPECT_EQ(output, path + ": unchanged\n");
+
+    EXPECT_EQ(run({"--set", "Comment= new ", path}), 0);
+    EXPECT_EQ(run({"--set", "Comment=new", path}, output), 0);
+    EXPECT_EQ(output, path + ": unchanged\n");
+    EXPECT_EQ(readBack(path), "[Desktop Entry]\nName=App\nComment=new\n");
+}
+
+TEST_F(DesktopFileToolTest, testCrlfLineEndings) {
+    const auto path = tempDir.writeFile("app.desktop", "[Desktop Entry]\r\nName=App\r\n# comment\r\nIcon=app\r\n");
+
+    EXPECT_EQ(run({"--set", "Name=Renamed", "--set", "Comment=comment", "--rename", "Icon=X-Icon",
+                   "--section", "Extra", "--set", "X-Key=value", path}), 0);
+
+    EXPECT_EQ(readBack(path),
+        "[Desktop Entry]\r\nName=Renamed\r\n# comment\r\nX-Icon=app\r\nComment=comment\r\n[Extra]\r\nX-Key=value\r\n");
+
+    std::string output;
+    EXPECT_EQ(run({"--set", "Name=Renamed", path}, output), 0);
+    EXPECT_EQ(output, path + ": unchanged\n");
+}
+
+TEST_F(DesktopFileToolTest, testDirectoriesAndDryRun) {
+    const std::string contents = "[Desktop Entry]\nName=App\n";
+    const auto first = tempDir.writeFile("applications/first.desktop", contents);
+    const auto second = tempDir.writeFile("applications/sub/second.desktop", contents);
+    tempDir.writeFile("applications/readme.txt", "not a desktop file");
+
+    std::string output;
+    EXPECT_EQ(run({"--dry-run", "--set", "Name=Renamed", tempDir.path() + "/applications"}, output), 0);
+    EXPECT_NE(output.find(first + ": modified\n"), std::string::npos);
+    EXPECT_NE(output.find(second + ": modified\n"), std::string::npos);
+    EXPECT_EQ(output.find("readme.txt"), std::string::npos);
+
+    EXPECT_EQ(readBack(first), contents);
+    EXPECT_EQ(readBack(second), contents);
+
+    EXPECT_EQ(run({"--quiet", "--set", "Name=Renamed", tempDir.path() + "/applications"}, output), 0);
+    EXPECT_EQ(output, "");
+    EXPECT_EQ(readBack(first), "[Desktop Entry]\nName=Renamed\n");
+    EXPECT_EQ(readBack(second), "[Desktop Entry]\nName=Renamed\n");
+}
+
+TEST_F(DesktopFileToolTest, testErrors) {
+    const auto valid = tempDir.writeFile("valid.desktop", "[Desktop Entry]\nName=App\n");
+    const auto invalid = tempDir.writeFile("invalid.desktop", "[Desktop Entry]\nno delimiter\n");
+    const auto missing = tempDir.path() + "/missing.desktop";
+
+    // the temporary file the new contents are written to has a name which is too long
+    const auto unwritable = tempDir.writeFile(std::string(247, 'x') + ".desktop", "[Desktop Entry]\nName=App\n");
+
+    std::string output;
+
+    // the other files are processed anyway
+    EXPECT_EQ(run({"--set", "Name=Renamed", valid, invalid, missing}, output), 1);
+    EXPECT_NE(output.find(valid + ": modified\n"), std::string::npos);
+    EXPECT_NE(output.find(invalid + ": error: "), std::string::npos);
+    EXPECT_NE(output.find(missing + ": error: could not read file"), std::string::npos);
+    EXPECT_EQ(readBack(valid), "[Desktop Entry]\nName=Renamed\n");
+    EXPECT_EQ(readBack(invalid), "[Desktop Entry]\nno delimiter\n");
+
+    EXPECT_EQ(run({"--set", "Name=Renamed", unwritable}, output), 1);
+    EXPECT_NE(output.find(unwritable + ": error: could not write file"), std::string::npos);
+    EXPECT_EQ(readBack(unwritable), "[Desktop Entry]\nName=App\n");
+
+    // nothing is written in dry runs, so there are no write errors either
+    EXPECT_EQ(run({"--dry-run", "--set", "Name=Renamed", unwritable}), 0);
+
+    // usage errors
+    EXPECT_EQ(run({"--set", "Name=Renamed"}), 2);
+    EXPECT_EQ(run({valid}), 2);
+    EXPECT_EQ(run({"--set", "Name", valid}), 2);
+    EXPECT_EQ(run({"--set", "Invalid Key=value", valid}), 2);
+    EXPECT_EQ(run({"--set", "Name=line\nbreak", valid}), 2);
+    EXPECT_EQ(run({"--rename", "Name=Invalid Key", valid}), 2);
+    EXPECT_EQ(run({"--jobs", "0", "--set", "Name=value", valid}), 2);
+    EXPECT_EQ(run({"--unknown", valid}), 2);
+    EXPECT_EQ(readBack(valid), "[Desktop Entry]\nName=Renamed\n");
+}
@@ -0,0 +1,88 @@
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/desktopfileview.h"
+#include "linuxdeploy/desktopfile/exceptions.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class DesktopFileViewTest : public ::testing::Test {
+public:
+    std::string contents;
+
+private:
+    void SetUp() override {
+        contents = "[Desktop Entry]\n"
+                   "Type=Application\n"
+                   "Name=Viewed Application\n"
+                   "Name[de]=Betrachtete Anwendung\n"
+                   "Exec=app %F\n"
+                   "\n"
+                   "[Desktop Action New]\n"
+                   "Name=New Window\n";
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(DesktopFileViewTest, testDefaultConstructor) {
+    DesktopFileView view;
+    EXPECT_TRUE(view.isEmpty());
+    EXPECT_EQ(view.findValue("Desktop Entry", "Name"), nullptr);
+}
+
+TEST_F(DesktopFileViewTest, testLookups) {
+    DesktopFileView view(contents);
+    EXPECT_FALSE(view.isEmpty());
+    EXPECT_EQ(view.sections().size(), 2);
+
+    const auto* name = view.findValue("Desktop Entry", "Name[de]");
+    ASSERT_NE(name, nullptr);
+    EXPECT_EQ(*name, "Betrachtete Anwendung");
+
+    EXPECT_TRUE(view.entryExists("Desktop Action New", "Name"));
+    EXPECT_FALSE(view.entryExists("Desktop Action New", "Exec"));
+    EXPECT_EQ(view.findSection("Desktop Action Quit"), nullptr);
+    EXPECT_EQ(view.findSection("Desktop Entry")->size(), 4);
+}
+
+TEST_F(DesktopFileViewTest, testBorrowsBuffer) {
+    DesktopFileView view(contents.data(), contents.size());
+
+    // the values refer to the caller's buffer, nothing has been copied
+    const auto* exec = view.findValue("Desktop Entry", "Exec");
+    ASSERT_NE(exec, nullptr);
+    EXPECT_GE(exec->data(), contents.data());
+    EXPECT_LT(exec->data(), contents.data() + contents.size());
+
+    for (const auto& section : view.sections()) {
+        EXPECT_GE(section.first.data(), contents.data());
+        EXPECT_LT(section.first.data(), contents.data() + contents.size());
+    }
+
+    // copies refer to the same buffer
+    DesktopFileView copy;
+    copy = view;
+    EXPECT_EQ(copy.buffer().data(), contents.data());
+    EXPECT_EQ(copy.findValue("Desktop Entry", "Exec")->data(), exec->data());
+}
+
+TEST_F(DesktopFileViewTest, testToDesktopFile) {
+    DesktopFileView view(contents);
+
+    const auto file = view.toDesktopFile();
+    EXPECT_EQ(file, DesktopFile(contents.data(), contents.size()));
+
+    std::stringstream ss(contents);
+    EXPECT_EQ(file, DesktopFile(ss));
+
+    ASSERT_NE(file.findEntry("Desktop Entry", "Name"), nullptr);
+    EXPECT_EQ(file.findEntry("Desktop Entry", "Name")->value(), "Viewed Application");
+}
+
+TEST_F(DesktopFileViewTest, testParseErrors) {
+    EXPECT_THROW(DesktopFileView("Name=no section\n"), ParseError);
+    EXPECT_THROW(DesktopFileView("[Desktop Entry]\nName=a\nName=b\n"), ParseError);
+    EXPECT_THROW(DesktopFileView("[Desktop Entry]\nInvalid Key=a\n"), ParseError);
+}
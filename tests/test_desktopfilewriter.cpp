@@ -104,3 +104,24 @@ TEST_F(DesktopFileWriterTest, testSerialization) {
     DesktopFileReader reader(ss);
     EXPECT_EQ(reader["Desktop Entry"], section);
 }
+
+TEST_F(DesktopFileWriterTest, testBorrowedData) {
+    DesktopFile::sections_t data = {
+        {"Desktop Entry", {{"Name", DesktopFileEntry("Name", "name")}}},
+    };
+
+    auto writer = DesktopFileWriter::borrow(data);
+    EXPECT_EQ(writer, DesktopFileWriter(data));
+    EXPECT_EQ(writer.toString(), DesktopFileWriter(data).toString());
+
+    // the writer serializes the current state of the data
+    data["Desktop Entry"].emplace("Exec", DesktopFileEntry("Exec", "exec"));
+    const auto contents = writer.toString();
+    EXPECT_EQ(DesktopFileReader(contents.data(), contents.size()).data(), data);
+
+    // copies own their data
+    const auto copy = writer;
+    data.clear();
+    EXPECT_EQ(copy.data().size(), 1);
+    EXPECT_TRUE(writer.data().empty());
+}
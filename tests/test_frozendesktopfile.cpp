@@ -0,0 +1,197 @@
+// system headers
+#include <algorithm>
+#include <memory_resource>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/exceptions.h"
+#include "linuxdeploy/desktopfile/frozendesktopfile.h"
+#include "allocationcounter.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class FrozenDesktopFileTest : public ::testing::Test {
+public:
+    DesktopFile file;
+
+private:
+    void SetUp() override {
+        file = DesktopFile(DESKTOP_FILE_PATH);
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(FrozenDesktopFileTest, testDefaultConstructor) {
+    FrozenDesktopFile frozen;
+    EXPECT_TRUE(frozen.isEmpty());
+    EXPECT_TRUE(frozen.path().empty());
+    EXPECT_FALSE(frozen.entryExists("Desktop Entry", "Name"));
+    EXPECT_TRUE(frozen.thaw().isEmpty());
+}
+
+TEST_F(FrozenDesktopFileTest, testLookups) {
+    const auto frozen = file.freeze();
+
+    EXPECT_FALSE(frozen.isEmpty());
+    EXPECT_EQ(frozen.path(), DESKTOP_FILE_PATH);
+    EXPECT_EQ(frozen.contentHash(), file.contentHash());
+
+    const std::vector<std::string_view> expectedSections = {
+        "Desktop Action AnotherSimpleAction", "Desktop Action SimpleAction", "Desktop Entry"
+    };
+    EXPECT_EQ(frozen.sectionNames(), expectedSections);
+
+    EXPECT_TRUE(frozen.sectionExists("Desktop Action SimpleAction"));
+    EXPECT_FALSE(frozen.sectionExists("Desktop Action"));
+
+    EXPECT_EQ(frozen.findValue("Desktop Entry", "Name"), "Simple Application");
+    EXPECT_EQ(frozen.findValue("Desktop Action SimpleAction", "Exec"), "simple_executable --do-it");
+    EXPECT_FALSE(frozen.findValue("Desktop Entry", "NoSuchKey").has_value());
+    EXPECT_FALSE(frozen.findValue("NoSuchSection", "Name").has_value());
+
+    // every key of every section must be found
+    for (const auto& section : file.sections()) {
+        for (const auto& entry : section.second)
+            EXPECT_EQ(frozen.findValue(section.first, entry.first), entry.second.value());
+    }
+
+    DesktopFileEntry entry;
+    ASSERT_TRUE(frozen.getEntry("Desktop Entry", "Icon", entry));
+    EXPECT_EQ(entry.key(), "Icon");
+    EXPECT_EQ(entry.value(), "simple_icon");
+    EXPECT_FALSE(frozen.getEntry("Desktop Entry", "NoSuchKey", entry));
+}
+
+TEST_F(FrozenDesktopFileTest, testEntries) {
+    const auto frozen = file.freeze();
+
+    const auto entries = frozen.entries("Desktop Action AnotherSimpleAction");
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[0].first, "Exec");
+    EXPECT_EQ(entries[1].first, "Icon");
+    EXPECT_EQ(entries[2].first, "Name");
+    EXPECT_EQ(entries[2].second, "Do another simple thing!");
+
+    EXPECT_THROW(frozen.entries("NoSuchSection"), UnknownSectionError);
+}
+
+TEST_F(FrozenDesktopFileTest, testStringsAreStoredOnce) {
+    const auto frozen = file.freeze();
+
+    size_t tables = 0;
+    size_t strings = file.path().size();
+
+    for (const auto& section : file.sections()) {
+        tables += 16;
+        strings += section.first.size();
+
+        for (const auto& entry : section.second) {
+            tables += 16;
+            strings += entry.first.size() + entry.second.value().size();
+        }
+    }
+
+    // Exec, Name and simple_icon are used several times, but only stored once
+    EXPECT_LT(frozen.size(), 32 + tables + strings);
+
+    // copies share the data
+    const auto copy = frozen;
+    EXPECT_EQ(copy.findValue("Desktop Entry", "Name")->data(), frozen.findValue("Desktop Entry", "Name")->data());
+}
+
+TEST_F(FrozenDesktopFileTest, testLookupsDoNotAllocate) {
+    const auto frozen = file.freeze();
+
+    AllocationCounter counter;
+
+    EXPECT_TRUE(frozen.entryExists("Desktop Action AnotherSimpleAction", "Icon"));
+    EXPECT_FALSE(frozen.entryExists("Desktop Action AnotherSimpleAction", "X-A-Rather-Long-Key-Which-Does-Not-Exist"));
+    EXPECT_EQ(frozen.findValue("Desktop Entry", "Comment"), "The most simple application available!");
+
+    EXPECT_EQ(counter.allocations(), 0);
+}
+
+TEST_F(FrozenDesktopFileTest, testThaw) {
+    const auto frozen = file.freeze();
+
+    auto thawed = frozen.thaw();
+    EXPECT_EQ(thawed, file);
+    EXPECT_EQ(thawed.contentHash(), file.contentHash());
+
+    // the thawed file is an independent, modifiable copy
+    thawed.setEntry("Desktop Entry", DesktopFileEntry("Name", "Changed"));
+    EXPECT_EQ(frozen.findValue("Desktop Entry", "Name"), "Simple Application");
+    EXPECT_NE(thawed.freeze(), frozen);
+    EXPECT_EQ(file.freeze(), frozen);
+}
+
+TEST_F(FrozenDesktopFileTest, testThawIntoMemoryResource) {
+    const auto frozen = file.freeze();
+
+    std::pmr::monotonic_buffer_resource pool;
+    const auto thawed = frozen.thaw(&pool);
+
+    EXPECT_EQ(thawed.memoryResource(), &pool);
+    EXPECT_EQ(thawed, file);
+}
+
+TEST_F(FrozenDesktopFileTest, testSerializeRoundTrip) {
+    const auto frozen = file.freeze();
+    const auto data = frozen.serialize();
+
+    const auto loaded = FrozenDesktopFile::deserialize(data.data(), data.size());
+    EXPECT_EQ(loaded, frozen);
+    EXPECT_EQ(loaded.findValue("Desktop Entry", "Exec"), "simple_executable %F");
+
+    const auto thawed = loaded.thaw();
+    EXPECT_EQ(thawed, file);
+    EXPECT_EQ(thawed.contentHash(), file.contentHash());
+    EXPECT_EQ(file.freeze().serialize(), data);
+
+    auto modified = file;
+    modified.setEntry("Desktop Entry", DesktopFileEntry("Exec", "other_executable"));
+    EXPECT_NE(modified.freeze(), frozen);
+}
+
+TEST_F(FrozenDesktopFileTest, testDeserializeRejectsInvalidData) {
+    const auto data = file.freeze().serialize();
+
+    // every truncation must be detected
+    for (size_t size = 0; size < data.size(); ++size)
+        EXPECT_THROW(FrozenDesktopFile::deserialize(data.data(), size), ParseError) << "size " << size;
+
+    auto modified = data;
+    modified[0] = 'X';
+    EXPECT_THROW(FrozenDesktopFile::deserialize(modified.data(), modified.size()), ParseError);
+
+    // version
+    modified = data;
+    modified[8] = 2;
+    EXPECT_THROW(FrozenDesktopFile::deserialize(modified.data(), modified.size()), ParseError);
+
+    // byte order mark written on a machine with the other byte order
+    modified = data;
+    std::reverse(modified.begin() + 4, modified.begin() + 8);
+    EXPECT_THROW(FrozenDesktopFile::deserialize(modified.data(), modified.size()), ParseError);
+
+    // the strings are stored at the end, changing any of their characters must be detected by the content hash
+    modified = data;
+    modified.back() ^= 1;
+    EXPECT_THROW(FrozenDesktopFile::deserialize(modified.data(), modified.size()), ParseError);
+
+    // corrupting any byte after the binary header must never result in out of bounds accesses
+    for (size_t position = 16; position < data.size(); ++position) {
+        modified = data;
+        modified[position] = static_cast<char>(0xff);
+
+        try {
+            const auto loaded = FrozenDesktopFile::deserialize(modified.data(), modified.size());
+
+            for (const auto& section : loaded.sectionNames())
+                loaded.entries(section);
+        } catch (const ParseError&) {}
+    }
+}
@@ -0,0 +1,186 @@
+// system headers
+#include <cstdio>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/iconthemeresolver.h"
+#include "tempdirectory.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class IconThemeResolverTest : public ::testing::Test {
+public:
+    TempDirectory tempDir;
+
+    // user and system wide base directories
+    std::string userIcons;
+    std::string systemIcons;
+
+    std::vector<std::string> baseDirectories;
+
+private:
+    void SetUp() override {
+        userIcons = tempDir.path() + "/home/.icons";
+        systemIcons = tempDir.path() + "/usr/share/icons";
+        baseDirectories = {userIcons, systemIcons, tempDir.path() + "/usr/share/pixmaps"};
+
+        tempDir.writeFile("usr/share/icons/hicolor/index.theme",
+            "[Icon Theme]\n"
+            "Name=Hicolor\n"
+            "Directories=48x48/apps,scalable/apps\n"
+            "\n"
+            "[48x48/apps]\n"
+            "Size=48\n"
+            "Type=Threshold\n"
+            "\n"
+            "[scalable/apps]\n"
+            "Size=128\n"
+            "MinSize=8\n"
+            "MaxSize=512\n"
+            "Type=Scalable\n"
+        );
+
+        tempDir.writeFile("usr/share/icons/Custom/index.theme",
+            "[Icon Theme]\n"
+            "Name=Custom\n"
+            "Inherits=Parent\n"
+            "Directories=16x16/apps,32x32/apps\n"
+            "\n"
+            "[16x16/apps]\n"
+            "Size=16\n"
+            "Type=Fixed\n"
+            "\n"
+            "[32x32/apps]\n"
+            "Size=32\n"
+            "Type=Fixed\n"
+        );
+
+        // inheritance cycles must not result in endless recursion
+        tempDir.writeFile("usr/share/icons/Parent/index.theme",
+            "[Icon Theme]\n"
+            "Name=Parent\n"
+            "Inherits=Custom\n"
+            "Directories=64x64/apps\n"
+            "\n"
+            "[64x64/apps]\n"
+            "Size=64\n"
+            "Type=Fixed\n"
+        );
+
+        tempDir.writeFile("usr/share/icons/hicolor/48x48/apps/app.png", "");
+        tempDir.writeFile("usr/share/icons/hicolor/scalable/apps/app.svg", "");
+        tempDir.writeFile("usr/share/icons/hicolor/scalable/apps/vector.svg", "");
+        tempDir.writeFile("usr/share/icons/Custom/16x16/apps/app.png", "");
+        tempDir.writeFile("usr/share/icons/Custom/32x32/apps/app.png", "");
+        tempDir.writeFile("usr/share/icons/Parent/64x64/apps/parent.png", "");
+        tempDir.writeFile("usr/share/pixmaps/legacy.xpm", "");
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(IconThemeResolverTest, testDefaultBaseDirectories) {
+    const auto directories = IconThemeResolver::defaultBaseDirectories();
+    ASSERT_FALSE(directories.empty());
+    EXPECT_EQ(directories.back(), "/usr/share/pixmaps");
+}
+
+TEST_F(IconThemeResolverTest, testResolveInHicolor) {
+    IconThemeResolver resolver("hicolor", baseDirectories);
+
+    EXPECT_EQ(resolver.resolve("app", 48), systemIcons + "/hicolor/48x48/apps/app.png");
+
+    // within the threshold
+    EXPECT_EQ(resolver.resolve("app", 50), systemIcons + "/hicolor/48x48/apps/app.png");
+
+    // the scalable directory matches all the other sizes
+    EXPECT_EQ(resolver.resolve("app", 256), systemIcons + "/hicolor/scalable/apps/app.svg");
+    EXPECT_EQ(resolver.resolve("vector", 48), systemIcons + "/hicolor/scalable/apps/vector.svg");
+
+    EXPECT_EQ(resolver.resolve("no-such-icon"), "");
+    EXPECT_EQ(resolver.resolve(""), "");
+}
+
+TEST_F(IconThemeResolverTest, testResolveWithInheritance) {
+    IconThemeResolver resolver("Custom", baseDirectories);
+
+    EXPECT_EQ(resolver.resolve("app", 16), systemIcons + "/Custom/16x16/apps/app.png");
+    EXPECT_EQ(resolver.resolve("app", 32), systemIcons + "/Custom/32x32/apps/app.png");
+
+    // no exact match, but the closest size in the theme is preferred over hicolor
+    EXPECT_EQ(resolver.resolve("app", 24), systemIcons + "/Custom/16x16/apps/app.png");
+
+    EXPECT_EQ(resolver.resolve("parent", 16), systemIcons + "/Parent/64x64/apps/parent.png");
+    EXPECT_EQ(resolver.resolve("vector", 16), systemIcons + "/hicolor/scalable/apps/vector.svg");
+}
+
+TEST_F(IconThemeResolverTest, testFallbacks) {
+    IconThemeResolver resolver("hicolor", baseDirectories);
+
+    EXPECT_EQ(resolver.resolve("legacy"), tempDir.path() + "/usr/share/pixmaps/legacy.xpm");
+
+    // extensions are tolerated
+    EXPECT_EQ(resolver.resolve("app.png", 48), systemIcons + "/hicolor/48x48/apps/app.png");
+
+    const auto absolutePath = systemIcons + "/hicolor/48x48/apps/app.png";
+    EXPECT_EQ(resolver.resolve(absolutePath), absolutePath);
+    EXPECT_EQ(resolver.resolve(absolutePath + ".missing"), "");
+}
+
+TEST_F(IconThemeResolverTest, testDuplicateKeysInIndex) {
+    // index.theme files with duplicate keys are common enough to be tolerated, the last value is used
+    tempDir.writeFile("home/.icons/Duplicates/index.theme",
+        "[Icon Theme]\n"
+        "Name=Duplicates\n"
+        "Name=Duplicates\n"
+        "Directories=16x16/apps\n"
+        "\n"
+        "[16x16/apps]\n"
+        "Size=16\n"
+        "Type=Fixed\n"
+    );
+    tempDir.writeFile("home/.icons/Duplicates/16x16/apps/app.png", "");
+
+    IconThemeResolver resolver("Duplicates", baseDirectories);
+    EXPECT_EQ(resolver.resolve("app", 16), userIcons + "/Duplicates/16x16/apps/app.png");
+}
+
+TEST_F(IconThemeResolverTest, testEarlierBaseDirectoriesTakePrecedence) {
+    tempDir.writeFile("home/.icons/hicolor/48x48/apps/app.png", "");
+
+    IconThemeResolver resolver("hicolor", baseDirectories);
+    EXPECT_EQ(resolver.resolve("app", 48), userIcons + "/hicolor/48x48/apps/app.png");
+}
+
+TEST_F(IconThemeResolverTest, testResolveDesktopFile) {
+    IconThemeResolver resolver("hicolor", baseDirectories);
+
+    DesktopFile file;
+    EXPECT_EQ(resolver.resolve(file), "");
+
+    file.setEntry("Desktop Entry", DesktopFileEntry("Icon", "app"));
+    EXPECT_EQ(resolver.resolve(file, 48), systemIcons + "/hicolor/48x48/apps/app.png");
+}
+
+TEST_F(IconThemeResolverTest, testRefreshIfChanged) {
+    IconThemeResolver resolver("hicolor", baseDirectories);
+
+    EXPECT_EQ(resolver.resolve("new-icon", 48), "");
+    EXPECT_FALSE(resolver.refreshIfChanged());
+
+    // directories which did not exist before must be detected, too
+    tempDir.writeFile("home/.icons/hicolor/48x48/apps/new-icon.png", "");
+
+    // the index is only updated on request
+    EXPECT_EQ(resolver.resolve("new-icon", 48), "");
+
+    EXPECT_TRUE(resolver.refreshIfChanged());
+    EXPECT_EQ(resolver.resolve("new-icon", 48), userIcons + "/hicolor/48x48/apps/new-icon.png");
+
+    std::remove((userIcons + "/hicolor/48x48/apps/new-icon.png").c_str());
+
+    resolver.invalidate();
+    EXPECT_EQ(resolver.resolve("new-icon", 48), "");
+}
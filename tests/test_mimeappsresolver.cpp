@@ -0,0 +1,143 @@
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/mimeappsresolver.h"
+#include "tempdirectory.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class MimeAppsResolverTest : public ::testing::Test {
+public:
+    TempDirectory tempDir;
+
+    DesktopFileOverlay applications;
+    std::string userList;
+    std::string systemList;
+
+    static std::string app(const std::string& name, const std::string& mimeTypes) {
+        return "[Desktop Entry]\nType=Application\nName=" + name + "\nExec=" + name + "\nMimeType=" + mimeTypes + "\n";
+    }
+
+private:
+    void SetUp() override {
+        tempDir.writeFile("applications/viewer.desktop", app("viewer", "image/png;image/svg+xml;"));
+        tempDir.writeFile("applications/editor.desktop", app("editor", "image/png;text/plain;"));
+        tempDir.writeFile("applications/kde/browser.desktop", app("browser", "text/html;"));
+        tempDir.writeFile("applications/gone.desktop", "[Desktop Entry]\nName=gone\nHidden=true\nMimeType=text/html;\n");
+
+        applications = DesktopFileOverlay({tempDir.path() + "/applications"});
+
+        userList = tempDir.path() + "/config/mimeapps.list";
+        systemList = tempDir.path() + "/applications/mimeapps.list";
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(MimeAppsResolverTest, testDefaultConstructor) {
+    MimeAppsResolver resolver;
+    EXPECT_TRUE(resolver.defaultApplication("image/png").empty());
+    EXPECT_TRUE(resolver.applications("image/png").empty());
+}
+
+TEST_F(MimeAppsResolverTest, testApplicationAssociationsOnly) {
+    MimeAppsResolver resolver({userList, systemList}, applications);
+
+    EXPECT_EQ(resolver.applications("image/png"), (std::vector<std::string>{"editor.desktop", "viewer.desktop"}));
+    EXPECT_EQ(resolver.defaultApplication("image/svg+xml"), "viewer.desktop");
+    EXPECT_EQ(resolver.defaultApplication("text/html"), "kde-browser.desktop");
+    EXPECT_EQ(resolver.defaultApplication("application/x-unknown"), "");
+
+    // missing lists are not an error
+    EXPECT_TRUE(resolver.errors().empty());
+}
+
+TEST_F(MimeAppsResolverTest, testListsAreMergedByPrecedence) {
+    tempDir.writeFile("config/mimeapps.list",
+                      "[Default Applications]\n"
+                      "image/png=not-installed.desktop;viewer.desktop;\n"
+                      "[Removed Associations]\n"
+                      "text/plain=editor.desktop;\n"
+                      "[Added Associations]\n"
+                      "text/plain=viewer.desktop;\n"
+                      "image/svg+xml=editor.desktop;\n");
+    tempDir.writeFile("applications/mimeapps.list",
+                      "[Default Applications]\n"
+                      "image/png=editor.desktop\n"
+                      "text/html=gone.desktop;kde-browser.desktop;\n"
+                      "[Added Associations]\n"
+                      "text/plain=editor.desktop;\n");
+
+    MimeAppsResolver resolver({userList, systemList}, applications);
+
+    // the first installed default in the list with the highest precedence wins
+    EXPECT_EQ(resolver.defaultApplication("image/png"), "viewer.desktop");
+
+    // hidden applications are not installed
+    EXPECT_EQ(resolver.defaultApplication("text/html"), "kde-browser.desktop");
+
+    // removals apply to lower-precedence lists and the applications' own associations
+    EXPECT_EQ(resolver.applications("text/plain"), std::vector<std::string>{"viewer.desktop"});
+    EXPECT_EQ(resolver.defaultApplication("text/plain"), "viewer.desktop");
+
+    // added associations are preferred over the applications' own ones
+    EXPECT_EQ(resolver.applications("image/svg+xml"), (std::vector<std::string>{"editor.desktop", "viewer.desktop"}));
+    EXPECT_EQ(resolver.defaultApplication("image/svg+xml"), "editor.desktop");
+}
+
+TEST_F(MimeAppsResolverTest, testDuplicateKeysInLists) {
+    // tools appending to the lists do not always remove existing keys, the last value wins like in GLib
+    tempDir.writeFile("config/mimeapps.list",
+                      "[Default Applications]\n"
+                      "image/png=viewer.desktop;\n"
+                      "image/png=editor.desktop;\n"
+                      "[Added Associations]\n"
+                      "text/html=editor.desktop;\n"
+                      "text/html=viewer.desktop;\n");
+
+    MimeAppsResolver resolver({userList}, applications);
+    EXPECT_EQ(resolver.defaultApplication("image/png"), "editor.desktop");
+    EXPECT_EQ(resolver.applications("text/html"), (std::vector<std::string>{"viewer.desktop", "kde-browser.desktop"}));
+    EXPECT_TRUE(resolver.errors().empty());
+}
+
+TEST_F(MimeAppsResolverTest, testInvalidListsAreReported) {
+    tempDir.writeFile("config/mimeapps.list", "[Default Applications]\nimage/png=viewer.desktop\n");
+    tempDir.writeFile("applications/mimeapps.list", "[Default Applications]\nimage png=editor.desktop\n");
+
+    MimeAppsResolver resolver({userList, systemList}, applications);
+
+    EXPECT_EQ(resolver.defaultApplication("image/png"), "viewer.desktop");
+    ASSERT_EQ(resolver.errors().size(), 1);
+    EXPECT_EQ(resolver.errors().begin()->first, systemList);
+}
+
+TEST_F(MimeAppsResolverTest, testDefaultListPaths) {
+    const std::vector<std::string> variables = {
+        "XDG_CONFIG_HOME", "XDG_CONFIG_DIRS", "XDG_DATA_HOME", "XDG_DATA_DIRS", "XDG_CURRENT_DESKTOP"
+    };
+    const std::vector<std::string> values = {"/config", "/etc/xdg", "/data", "/usr/share", "KDE:Plasma"};
+
+    std::vector<std::string> oldValues;
+
+    for (size_t i = 0; i < variables.size(); ++i) {
+        const auto* value = getenv(variables[i].c_str());
+        oldValues.emplace_back(value == nullptr ? "" : value);
+        setenv(variables[i].c_str(), values[i].c_str(), 1);
+    }
+
+    const std::vector<std::string> expected = {
+        "/config/kde-mimeapps.list", "/config/plasma-mimeapps.list", "/config/mimeapps.list",
+        "/etc/xdg/kde-mimeapps.list", "/etc/xdg/plasma-mimeapps.list", "/etc/xdg/mimeapps.list",
+        "/data/applications/kde-mimeapps.list", "/data/applications/plasma-mimeapps.list",
+        "/data/applications/mimeapps.list", "/data/applications/defaults.list",
+        "/usr/share/applications/kde-mimeapps.list", "/usr/share/applications/plasma-mimeapps.list",
+        "/usr/share/applications/mimeapps.list", "/usr/share/applications/defaults.list",
+    };
+    EXPECT_EQ(MimeAppsResolver::defaultListPaths(), expected);
+
+    // empty values are treated like unset ones
+    for (size_t i = 0; i < variables.size(); ++i)
+        setenv(variables[i].c_str(), oldValues[i].c_str(), 1);
+}
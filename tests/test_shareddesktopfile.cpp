@@ -0,0 +1,122 @@
+// system headers
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/shareddesktopfile.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class SharedDesktopFileTest : public ::testing::Test {
+public:
+    DesktopFile file;
+
+private:
+    void SetUp() override {
+        file = DesktopFile(DESKTOP_FILE_PATH);
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(SharedDesktopFileTest, testDefaultConstructor) {
+    SharedDesktopFile shared;
+    ASSERT_NE(shared.snapshot(), nullptr);
+    EXPECT_TRUE(shared.snapshot()->isEmpty());
+}
+
+TEST_F(SharedDesktopFileTest, testSnapshotsAreImmutable) {
+    SharedDesktopFile shared(file);
+
+    const auto before = shared.snapshot();
+    EXPECT_EQ(*before, file);
+
+    const auto published = shared.update([](DesktopFile& modified) {
+        modified.setEntry("Desktop Entry", DesktopFileEntry("Name", "Renamed"));
+    });
+
+    EXPECT_EQ(shared.snapshot(), published);
+    EXPECT_EQ(published->findEntry("Desktop Entry", "Name")->value(), "Renamed");
+
+    // readers holding the old snapshot don't see the update
+    EXPECT_EQ(*before, file);
+    EXPECT_NE(before->contentHash(), published->contentHash());
+}
+
+TEST_F(SharedDesktopFileTest, testFailingUpdateIsNotPublished) {
+    SharedDesktopFile shared(file);
+    const auto before = shared.snapshot();
+
+    EXPECT_THROW(shared.update([](DesktopFile& modified) {
+        modified.clear();
+        throw std::runtime_error("failed");
+    }), std::runtime_error);
+
+    EXPECT_EQ(shared.snapshot(), before);
+}
+
+TEST_F(SharedDesktopFileTest, testConcurrentReadersAndWriters) {
+    SharedDesktopFile shared(file);
+
+    const int writers = 4;
+    const int updatesPerWriter = 50;
+
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistentReads{0};
+
+    // every update changes two entries, readers must never see only one of them changed
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!done) {
+                const auto snapshot = shared.snapshot();
+
+                const auto* counter = snapshot->findEntry("X-Test", "Counter");
+                const auto* copy = snapshot->findEntry("X-Test", "CounterCopy");
+
+                if ((counter == nullptr) != (copy == nullptr) ||
+                    (counter != nullptr && counter->value() != copy->value())) {
+                    ++inconsistentReads;
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> writerThreads;
+    for (int i = 0; i < writers; ++i) {
+        writerThreads.emplace_back([&]() {
+            for (int j = 0; j < updatesPerWriter; ++j) {
+                shared.update([](DesktopFile& modified) {
+                    int value = 0;
+
+                    const auto* counter = modified.findEntry("X-Test", "Counter");
+                    if (counter != nullptr)
+                        value = counter->asInt();
+
+                    const auto newValue = std::to_string(value + 1);
+                    modified.setEntry("X-Test", DesktopFileEntry("Counter", newValue));
+                    modified.setEntry("X-Test", DesktopFileEntry("CounterCopy", newValue));
+                });
+            }
+        });
+    }
+
+    for (auto& thread : writerThreads)
+        thread.join();
+
+    done = true;
+
+    for (auto& thread : readers)
+        thread.join();
+
+    EXPECT_EQ(inconsistentReads, 0);
+
+    // no update may get lost
+    EXPECT_EQ(shared.snapshot()->findEntry("X-Test", "Counter")->asInt(), writers * updatesPerWriter);
+}
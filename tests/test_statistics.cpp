@@ -0,0 +1,103 @@
+// library headers
+#include <gtest/gtest.h>
+
+// local headers
+#include "linuxdeploy/desktopfile/statistics.h"
+#include "../src/desktopfilereader.h"
+#include "../src/desktopfilewriter.h"
+
+using namespace linuxdeploy::desktopfile;
+
+class StatisticsTest : public ::testing::Test {
+private:
+    void SetUp() override {
+        resetGlobalStatistics();
+    }
+
+    void TearDown() override {}
+};
+
+TEST_F(StatisticsTest, testParseStatistics) {
+    DesktopFileReader reader(DESKTOP_FILE_PATH);
+    const auto& statistics = reader.statistics();
+
+    if (!statisticsEnabled()) {
+        EXPECT_EQ(statistics.lines, 0);
+        EXPECT_EQ(statistics.entries, 0);
+        EXPECT_EQ(globalParseStatistics().lines, 0);
+        return;
+    }
+
+    EXPECT_EQ(statistics.bytesRead, 459);
+    EXPECT_EQ(statistics.lines, 19);
+    EXPECT_EQ(statistics.sections, 3);
+    EXPECT_EQ(statistics.entries, 14);
+    EXPECT_EQ(statistics.localizedKeys, 0);
+    EXPECT_GE(statistics.allocations, 3 + 2 * 14);
+
+    EXPECT_GT(statistics.ioNanoseconds + statistics.tokenizeNanoseconds + statistics.validationNanoseconds +
+              statistics.insertionNanoseconds, 0);
+
+    // copies of readers share the statistics
+    DesktopFileReader copy(reader);
+    EXPECT_EQ(copy.statistics().entries, 14);
+}
+
+TEST_F(StatisticsTest, testLocalizedKeys) {
+    std::stringstream ss;
+    ss << "[Desktop Entry]" << std::endl
+       << "Name=name" << std::endl
+       << "Name[de]=Name" << std::endl
+       << "Name[fr_FR]=nom" << std::endl;
+
+    DesktopFileReader reader(ss);
+
+    if (statisticsEnabled())
+        EXPECT_EQ(reader.statistics().localizedKeys, 2);
+    else
+        EXPECT_EQ(reader.statistics().localizedKeys, 0);
+}
+
+TEST_F(StatisticsTest, testGlobalStatistics) {
+    DesktopFileReader first(DESKTOP_FILE_PATH);
+    DesktopFileReader second(DESKTOP_FILE_PATH);
+
+    auto global = globalParseStatistics();
+
+    ParseStatistics sum;
+    sum += first.statistics();
+    sum += second.statistics();
+
+    EXPECT_EQ(global.lines, sum.lines);
+    EXPECT_EQ(global.entries, sum.entries);
+    EXPECT_EQ(global.bytesRead, sum.bytesRead);
+
+    resetGlobalStatistics();
+    EXPECT_EQ(globalParseStatistics().entries, 0);
+}
+
+TEST_F(StatisticsTest, testSerializeStatistics) {
+    DesktopFileReader reader(DESKTOP_FILE_PATH);
+    DesktopFileWriter writer(reader.data());
+
+    std::stringstream first;
+    writer.save(first);
+
+    std::stringstream second;
+    writer.save(second);
+
+    const auto& statistics = writer.statistics();
+
+    if (!statisticsEnabled()) {
+        EXPECT_EQ(statistics.bytesWritten, 0);
+        EXPECT_EQ(globalSerializeStatistics().bytesWritten, 0);
+        return;
+    }
+
+    // both save operations are accounted for
+    EXPECT_EQ(statistics.bytesWritten, first.str().size() + second.str().size());
+    EXPECT_EQ(statistics.sections, 6);
+    EXPECT_EQ(statistics.entries, 28);
+
+    EXPECT_EQ(globalSerializeStatistics().bytesWritten, statistics.bytesWritten);
+}